@@ -129,7 +129,40 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // The parser has no INCLUDE clause, so the columns a covering index stores after its key come as an option:
+  // `CREATE INDEX ... (a) WITH (include = 'b, c')`.
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto def_elem = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (std::string(def_elem->defname) != "include") {
+        throw NotImplementedException(fmt::format("index option {} is not supported", def_elem->defname));
+      }
+      auto arg = reinterpret_cast<duckdb_libpgquery::PGValue *>(def_elem->arg);
+      if (arg == nullptr || arg->type != duckdb_libpgquery::T_PGString) {
+        throw bustub::Exception("include expects a string of comma-separated columns");
+      }
+      for (const auto &name : StringUtil::Split(arg->val.str, ',')) {
+        auto column_ref = ResolveColumn(*table, std::vector{StringUtil::Lower(StringUtil::Strip(name, ' '))});
+        include_cols.emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+      }
+    }
+  }
+
+  // Without USING, the parser asks for its own default access method.
+  std::string index_type = stmt->accessMethod == nullptr ? DEFAULT_INDEX_TYPE : StringUtil::Lower(stmt->accessMethod);
+  if (index_type == DEFAULT_INDEX_TYPE) {
+    index_type = "btree";
+  }
+  if (index_type != "btree" && index_type != "hash") {
+    throw NotImplementedException(fmt::format("index type {} is not supported", index_type));
+  }
+  if (index_type == "hash" && !include_cols.empty()) {
+    throw NotImplementedException("a hash index cannot include columns");
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), stmt->unique,
+                                          std::move(include_cols), std::move(index_type));
 }
 
 }  // namespace bustub
@@ -12,179 +12,791 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+BufferPoolManager::Shard::Shard(size_t index, size_t num_shards, Page *pages, size_t size, size_t replacer_k)
+    : index_(index),
+      num_shards_(num_shards),
+      size_(size),
+      pages_(pages),
+      replacer_(std::make_unique<LRUKReplacer>(size, replacer_k)),
+      io_in_progress_(size, false),
+      io_done_(size),
+      prefetched_(size, false) {
+  // Initially, every frame is in the free list.
+  for (size_t i = 0; i < size_; ++i) {
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, size_t num_shards, size_t flush_watermark)
+    : pool_size_(pool_size), arena_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+  BUSTUB_ENSURE(num_shards > 0 && num_shards <= pool_size, "Each shard should own at least one frame");
+  BUSTUB_ENSURE(flush_watermark <= pool_size, "Cannot keep more clean frames than the pool has");
   // we allocate a consecutive memory space for the buffer pool
   pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
-
-  // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+    pages_[i].data_ = arena_.GetFrame(i);
+  }
+
+  // Split the frames as evenly as possible, the first (pool_size % num_shards) shards get one extra frame.
+  size_t offset = 0;
+  for (size_t i = 0; i < num_shards; ++i) {
+    size_t size = pool_size_ / num_shards + (i < pool_size_ % num_shards ? 1 : 0);
+    shards_.emplace_back(std::make_unique<Shard>(i, num_shards, pages_ + offset, size, replacer_k));
+    // Each shard keeps its share of the reserve, rounded up.
+    shards_.back()->flush_watermark_ = (flush_watermark * size + pool_size_ - 1) / pool_size_;
+    offset += size;
+  }
+
+  if (flush_watermark > 0) {
+    flusher_ = std::thread(&BufferPoolManager::FlusherLoop, this);
+  }
+
+  if (enable_warm_restart) {
+    warm_name_ = disk_manager_->GetSidecarFileName(".warm");
+  }
+  if (!warm_name_.empty()) {
+    WarmUp();
+    dumper_ = std::thread(&BufferPoolManager::DumperLoop, this);
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::~BufferPoolManager() {
+  if (dumper_.joinable()) {
+    {
+      std::scoped_lock lock(dumper_latch_);
+      stop_dumper_ = true;
+    }
+    dumper_cv_.notify_one();
+    dumper_.join();
+  }
+  // Outstanding prefetches still write into the frames.
+  if (prefetcher_.joinable()) {
+    {
+      std::scoped_lock lock(prefetch_latch_);
+      stop_prefetcher_ = true;
+    }
+    prefetch_cv_.notify_one();
+    prefetcher_.join();
+  }
+  if (flusher_.joinable()) {
+    {
+      std::scoped_lock lock(flusher_latch_);
+      stop_flusher_ = true;
+    }
+    flusher_cv_.notify_one();
+    flusher_.join();
+  }
+  delete[] pages_;
+}
 
-auto BufferPoolManager::GetFreeFrame() -> frame_id_t {
+auto BufferPoolManager::UnswizzleFrame(Shard &shard) -> bool {
+  for (size_t i = 0; i < shard.size_; ++i) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page &page = shard.pages_[frame_id];
+    // Readers that followed a swip hold the latch but no pin.
+    if (!page.IsSwizzled() || page.pin_count_ != 1 || shard.io_in_progress_[frame_id] || !page.TryWLatch()) {
+      continue;
+    }
+    page.swizzled_.store(false);
+    page.pin_count_ = 0;
+    shard.num_swizzled_--;
+    shard.replacer_->SetEvictable(frame_id, true);
+    page.WUnlatch();
+    unswizzles_++;
+    return true;
+  }
+  return false;
+}
+
+auto BufferPoolManager::GetFreeFrame(Shard &shard) -> frame_id_t {
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
+  if (!shard.free_list_.empty()) {
+    frame_id = shard.free_list_.front();
+    shard.free_list_.pop_front();
   } else {
-    BUSTUB_ENSURE(replacer_->Evict(&frame_id), "Evict page should succeed");
-    if (pages_[frame_id].IsDirty()) {
-      BUSTUB_ENSURE(FlushPage(pages_[frame_id].GetPageId()), "Flush page should succeed");
-    }
-    page_table_.erase(pages_[frame_id].GetPageId());
+    BUSTUB_ENSURE(shard.replacer_->Evict(&frame_id), "Evict page should succeed");
   }
   return frame_id;
 }
 
+auto BufferPoolManager::FindFrame(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id) -> frame_id_t {
+  while (true) {
+    auto it = shard.page_table_.find(page_id);
+    if (it == shard.page_table_.end()) {
+      return -1;
+    }
+    frame_id_t frame_id = it->second;
+    if (!shard.io_in_progress_[frame_id]) {
+      return frame_id;
+    }
+    // The frame may hold another page once the I/O is done, so look the page up again after waking up.
+    shard.io_done_[frame_id].wait(lock);
+  }
+}
+
+auto BufferPoolManager::LoadFrame(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id, bool read_page,
+                                  AccessType access_type) -> Page * {
+  frame_id_t frame_id = GetFreeFrame(shard);
+  Page &page = shard.pages_[frame_id];
+  page_id_t old_page_id = page.page_id_;
+  bool write_back = page.is_dirty_;
+  // A dirty victim stays in the page table until it is on disk, so that concurrent fetchers of the old page wait for
+  // the write to finish instead of reading a stale copy from disk.
+  if (old_page_id != INVALID_PAGE_ID && !write_back) {
+    shard.page_table_.erase(old_page_id);
+  }
+  page.page_id_ = page_id;
+  page.pin_count_ = 1;
+  page.is_dirty_ = false;
+  shard.page_table_[page_id] = frame_id;
+  shard.prefetched_[frame_id] = false;
+  shard.replacer_->RecordAccess(frame_id, access_type);
+  shard.replacer_->SetGroup(frame_id, GroupOf(page_id));
+  shard.replacer_->SetEvictable(frame_id, false);
+  shard.io_in_progress_[frame_id] = true;
+  lock.unlock();
+
+  if (write_back) {
+    foreground_flushes_++;
+    // The flusher is falling behind, wake it up instead of waiting for its next round.
+    flusher_cv_.notify_one();
+    disk_manager_->WritePage(old_page_id, page.data_);
+  }
+  page.ResetMemory();
+  if (read_page) {
+    disk_manager_->ReadPage(page_id, page.data_);
+  }
+
+  lock.lock();
+  if (write_back) {
+    shard.page_table_.erase(old_page_id);
+  }
+  shard.io_in_progress_[frame_id] = false;
+  shard.io_done_[frame_id].notify_all();
+  return &page;
+}
+
 auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  latch_.lock();
+  // Start from a different shard every time so that new pages (and their ids) are spread over all shards, and fall
+  // back to the other shards if the preferred one is fully pinned.
+  size_t start = next_shard_.fetch_add(1) % shards_.size();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    Page *page = NewPageInShard(*shards_[(start + i) % shards_.size()], page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+auto BufferPoolManager::NewPageInShard(Shard &shard, page_id_t *page_id) -> Page * {
+  std::unique_lock lock(shard.latch_);
   // Check if free frame exists
-  if (free_list_.empty() && replacer_->Size() == 0) {
-    *page_id = INVALID_PAGE_ID;
-    latch_.unlock();
+  if (shard.free_list_.empty() && shard.replacer_->Size() == 0 && !UnswizzleFrame(shard)) {
     return nullptr;
   }
   // New page
-  frame_id_t frame_id = GetFreeFrame();
-  pages_[frame_id].ResetMemory();
-  page_id_t new_page_id = AllocatePage();
-  pages_[frame_id].page_id_ = new_page_id;
-  pages_[frame_id].pin_count_ = 1;
-  pages_[frame_id].is_dirty_ = false;
-  page_table_[new_page_id] = frame_id;
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  *page_id = new_page_id;
-  latch_.unlock();
-  return &pages_[frame_id];
-}
-
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  latch_.lock();
-  // Check if page needs to be fetched from disk
-  if (page_table_.find(page_id) == page_table_.end() && free_list_.empty() && replacer_->Size() == 0) {
-    latch_.unlock();
+  *page_id = AllocatePage(shard);
+  Page *page = CreatePage(shard, lock, *page_id);
+  if (page == nullptr) {
+    DeallocatePage(*page_id);
+  }
+  return page;
+}
+
+auto BufferPoolManager::NewPageWithId(page_id_t page_id) -> Page * {
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
+  return CreatePage(shard, lock, page_id);
+}
+
+auto BufferPoolManager::CreatePage(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id) -> Page * {
+  // The id may belong to a deleted page that was read back in since, such as by a prefetch. That copy is stale.
+  frame_id_t frame_id = FindFrame(shard, lock, page_id);
+  if (frame_id != -1) {
+    Page &page = shard.pages_[frame_id];
+    BUSTUB_ASSERT(page.pin_count_ == 0, "a deleted page should not be pinned");
+    shard.page_table_.erase(page_id);
+    shard.replacer_->Remove(frame_id);
+    page.page_id_ = INVALID_PAGE_ID;
+    page.is_dirty_ = false;
+    shard.prefetched_[frame_id] = false;
+    shard.free_list_.emplace_back(frame_id);
+  }
+  // The latch may have been released while waiting for the stale copy.
+  if (shard.free_list_.empty() && shard.replacer_->Size() == 0 && !UnswizzleFrame(shard)) {
     return nullptr;
   }
-  // Fetch page
-  frame_id_t frame_id;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id = page_table_[page_id];
+  return LoadFrame(shard, lock, page_id, false);
+}
+
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
+  frame_id_t frame_id = FindFrame(shard, lock, page_id);
+  if (frame_id == -1) {
+    // Check if page can be fetched from disk
+    if (shard.free_list_.empty() && shard.replacer_->Size() == 0 && !UnswizzleFrame(shard)) {
+      return nullptr;
+    }
+    return LoadFrame(shard, lock, page_id, true, access_type);
+  }
+  if (shard.prefetched_[frame_id]) {
+    shard.prefetched_[frame_id] = false;
+    prefetch_hits_++;
+  }
+  shard.pages_[frame_id].pin_count_++;
+  shard.replacer_->RecordAccess(frame_id, access_type);
+  shard.replacer_->SetEvictable(frame_id, false);
+  return &shard.pages_[frame_id];
+}
+
+void BufferPoolManager::SwizzlePage(Swip *swip, page_id_t page_id) {
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
+  frame_id_t frame_id = FindFrame(shard, lock, page_id);
+  if (frame_id == -1) {
+    return;
+  }
+  Page &page = shard.pages_[frame_id];
+  if (!page.IsSwizzled()) {
+    if (shard.num_swizzled_ >= shard.size_ / SWIZZLE_BUDGET_DIVISOR) {
+      return;
+    }
+    page.pin_count_++;
+    shard.num_swizzled_++;
+    shard.replacer_->SetEvictable(frame_id, false);
+    page.swizzled_.store(true, std::memory_order_release);
+  }
+  auto frame_index = static_cast<uint64_t>(&page - pages_);
+  swip->store(static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | (frame_index + 1),
+              std::memory_order_release);
+}
+
+auto BufferPoolManager::TryFetchSwizzledRead(Swip *swip, page_id_t page_id) -> ReadPageGuard {
+  uint64_t value = swip->load(std::memory_order_acquire);
+  uint64_t frame_index = value & UINT32_MAX;
+  if (frame_index == 0 || static_cast<page_id_t>(value >> 32) != page_id) {
+    return {};
+  }
+  Page *page = &pages_[frame_index - 1];
+  if (!page->TryRLatch()) {
+    return {};
+  }
+  // The frame may have been unswizzled and reused since the swip was set. It cannot be any more while latched.
+  if (!page->IsSwizzled() || page->page_id_ != page_id) {
+    page->RUnlatch();
+    return {};
+  }
+  return {nullptr, page};
+}
+
+auto BufferPoolManager::GetSwizzledCount() -> size_t {
+  size_t count = 0;
+  for (auto &shard : shards_) {
+    std::scoped_lock lock(shard->latch_);
+    count += shard->num_swizzled_;
+  }
+  return count;
+}
+
+void BufferPoolManager::PrefetchPage(page_id_t page_id, AccessType access_type) {
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
+  if (shard.page_table_.count(page_id) > 0 || shard.free_list_.size() + shard.replacer_->Size() <= shard.size_ / 2) {
+    return;
+  }
+  StartPrefetch(shard, lock, page_id, access_type, false);
+  prefetches_++;
+}
+
+void BufferPoolManager::StartPrefetch(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id,
+                                      AccessType access_type, bool warm_up) {
+  // The prefetcher makes the frame evictable once loaded.
+  frame_id_t frame_id = GetFreeFrame(shard);
+  Page &page = shard.pages_[frame_id];
+  Prefetch prefetch{&shard, frame_id, page_id, page.page_id_, page.is_dirty_, {}, warm_up};
+  if (prefetch.old_page_id_ != INVALID_PAGE_ID && !prefetch.write_back_) {
+    shard.page_table_.erase(prefetch.old_page_id_);
+  }
+  page.page_id_ = page_id;
+  page.pin_count_ = 0;
+  page.is_dirty_ = false;
+  shard.page_table_[page_id] = frame_id;
+  shard.prefetched_[frame_id] = false;
+  shard.replacer_->RecordAccess(frame_id, access_type);
+  shard.replacer_->SetGroup(frame_id, GroupOf(page_id));
+  shard.replacer_->SetEvictable(frame_id, false);
+  shard.io_in_progress_[frame_id] = true;
+  lock.unlock();
+
+  if (prefetch.write_back_) {
+    prefetch_flushes_++;
+    prefetch.io_ = disk_manager_->WritePagesAsync(prefetch.old_page_id_, {page.data_});
   } else {
-    frame_id = GetFreeFrame();
-    pages_[frame_id].ResetMemory();
-    pages_[frame_id].page_id_ = page_id;
-    pages_[frame_id].pin_count_ = 0;
-    pages_[frame_id].is_dirty_ = false;
-    page_table_[page_id] = frame_id;
-    disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
+    page.ResetMemory();
+    prefetch.io_ = disk_manager_->ReadPageAsync(page_id, page.data_);
+  }
+
+  {
+    std::scoped_lock prefetch_lock(prefetch_latch_);
+    if (!prefetcher_.joinable()) {
+      prefetcher_ = std::thread(&BufferPoolManager::PrefetchLoop, this);
+    }
+    prefetch_queue_.emplace_back(std::move(prefetch));
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchLoop() {
+  while (true) {
+    Prefetch prefetch;
+    {
+      std::unique_lock lock(prefetch_latch_);
+      prefetch_cv_.wait(lock, [&] { return stop_prefetcher_ || !prefetch_queue_.empty(); });
+      if (prefetch_queue_.empty()) {
+        return;
+      }
+      prefetch = std::move(prefetch_queue_.front());
+      prefetch_queue_.pop_front();
+    }
+
+    Shard &shard = *prefetch.shard_;
+    Page &page = shard.pages_[prefetch.frame_id_];
+    if (prefetch.write_back_) {
+      prefetch.io_.get();
+      page.ResetMemory();
+      prefetch.io_ = disk_manager_->ReadPageAsync(prefetch.page_id_, page.data_);
+    }
+    prefetch.io_.get();
+
+    std::scoped_lock lock(shard.latch_);
+    if (prefetch.write_back_) {
+      shard.page_table_.erase(prefetch.old_page_id_);
+    }
+    shard.io_in_progress_[prefetch.frame_id_] = false;
+    shard.prefetched_[prefetch.frame_id_] = !prefetch.warm_up_;
+    shard.replacer_->SetEvictable(prefetch.frame_id_, true);
+    shard.io_done_[prefetch.frame_id_].notify_all();
+    if (prefetch.warm_up_) {
+      warm_up_loaded_++;
+    }
+  }
+}
+
+auto BufferPoolManager::DumpResidentPages() -> size_t {
+  if (warm_name_.empty()) {
+    return 0;
+  }
+  std::vector<std::vector<page_id_t>> shard_pages;
+  for (auto &shard : shards_) {
+    std::scoped_lock lock(shard->latch_);
+    auto victims = shard->replacer_->PeekVictims(shard->size_);
+    std::vector<bool> evictable(shard->size_, false);
+    for (frame_id_t frame_id : victims) {
+      evictable[frame_id] = true;
+    }
+    std::vector<page_id_t> &pages = shard_pages.emplace_back();
+    for (const auto &[page_id, frame_id] : shard->page_table_) {
+      // A frame being written back is still mapped from the page it held before.
+      if (!evictable[frame_id] && shard->pages_[frame_id].page_id_ == page_id) {
+        pages.push_back(page_id);
+      }
+    }
+    for (auto it = victims.rbegin(); it != victims.rend(); ++it) {
+      pages.push_back(shard->pages_[*it].page_id_);
+    }
+  }
+
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; page_ids.size() < pool_size_; ++rank) {
+    size_t before = page_ids.size();
+    for (auto &pages : shard_pages) {
+      if (rank < pages.size()) {
+        page_ids.push_back(pages[rank]);
+      }
+    }
+    if (page_ids.size() == before) {
+      break;
+    }
+  }
+
+  // Write a new file and rename it over the old one, so that a crash in between leaves a complete dump behind.
+  std::string tmp_name = warm_name_ + ".tmp";
+  std::ofstream warm_io(tmp_name, std::ios::binary | std::ios::trunc);
+  warm_io.write(reinterpret_cast<const char *>(page_ids.data()),
+                static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+  warm_io.close();
+  if (!warm_io || std::rename(tmp_name.c_str(), warm_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing the warm restart file");
+    return 0;
+  }
+  return page_ids.size();
+}
+
+auto BufferPoolManager::WarmUp() -> size_t {
+  if (warm_name_.empty()) {
+    return 0;
+  }
+  std::ifstream warm_io(warm_name_, std::ios::binary);
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  while (page_ids.size() < pool_size_ && warm_io.read(reinterpret_cast<char *>(&page_id), sizeof(page_id_t))) {
+    if (disk_manager_->IsAllocated(page_id)) {
+      page_ids.push_back(page_id);
+    }
+  }
+  // Adjacent hot pages, such as the pages of an extent, are then read in one sweep over the file.
+  std::sort(page_ids.begin(), page_ids.end());
+
+  size_t started = 0;
+  for (page_id_t id : page_ids) {
+    Shard &shard = ShardOf(id);
+    std::unique_lock lock(shard.latch_);
+    if (shard.page_table_.count(id) > 0 || shard.free_list_.empty()) {
+      continue;
+    }
+    StartPrefetch(shard, lock, id, AccessType::Unknown, true);
+    started++;
+  }
+  warm_up_pages_ += started;
+  return started;
+}
+
+void BufferPoolManager::DumperLoop() {
+  std::unique_lock lock(dumper_latch_);
+  while (!stop_dumper_) {
+    dumper_cv_.wait_for(lock, warm_restart_dump_interval, [&] { return stop_dumper_; });
+    // The last round runs after the pool has been asked to stop, which leaves the final hot set behind.
+    lock.unlock();
+    DumpResidentPages();
+    lock.lock();
   }
-  pages_[frame_id].pin_count_++;
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  latch_.unlock();
-  return &pages_[frame_id];
 }
 
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  latch_.lock();
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
   // Check
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end() || pages_[it->second].pin_count_ <= 0) {
-    latch_.unlock();
+  frame_id_t frame_id = FindFrame(shard, lock, page_id);
+  if (frame_id == -1 || shard.pages_[frame_id].pin_count_ <= 0) {
     return false;
   }
   // Unpin page
-  pages_[it->second].pin_count_--;
+  Page &page = shard.pages_[frame_id];
+  page.pin_count_--;
   if (is_dirty) {
-    pages_[it->second].is_dirty_ = is_dirty;
+    page.is_dirty_ = is_dirty;
   }
-  if (pages_[it->second].pin_count_ == 0) {
-    replacer_->SetEvictable(it->second, true);
+  if (page.pin_count_ == 0) {
+    shard.replacer_->SetEvictable(frame_id, true);
   }
-  latch_.unlock();
   return true;
 }
 
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  // Check
-  if (page_table_.find(page_id) == page_table_.end()) {
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
+  frame_id_t frame_id = FindFrame(shard, lock, page_id);
+  if (frame_id == -1) {
     return false;
   }
-  // Flush page
-  frame_id_t frame_id = page_table_[page_id];
-  disk_manager_->WritePage(page_id, pages_[frame_id].data_);
-  pages_[frame_id].is_dirty_ = false;
+  // Keep the frame from being evicted, and other threads away from it, while the write is performed without the latch.
+  Page &page = shard.pages_[frame_id];
+  shard.replacer_->SetEvictable(frame_id, false);
+  shard.io_in_progress_[frame_id] = true;
+  page.is_dirty_ = false;
+  lock.unlock();
+
+  disk_manager_->WritePage(page_id, page.data_);
+
+  lock.lock();
+  shard.io_in_progress_[frame_id] = false;
+  if (page.pin_count_ == 0) {
+    shard.replacer_->SetEvictable(frame_id, true);
+  }
+  shard.io_done_[frame_id].notify_all();
   return true;
 }
 
 void BufferPoolManager::FlushAllPages() {
-  latch_.lock();
-  for (auto &it : page_table_) {
-    if (pages_[it.second].is_dirty_) {
-      FlushPage(it.first);
+  for (auto &shard : shards_) {
+    // Reserve the dirty frames the same way FlushPage() does, so that the shard keeps serving other pages meanwhile.
+    std::unique_lock lock(shard->latch_);
+    std::vector<frame_id_t> frames;
+    std::vector<std::pair<page_id_t, const char *>> pages;
+    for (auto &[page_id, frame_id] : shard->page_table_) {
+      Page &page = shard->pages_[frame_id];
+      // Frames with I/O in progress are being flushed by someone else, or not loaded yet.
+      if (page.is_dirty_ && !shard->io_in_progress_[frame_id]) {
+        shard->replacer_->SetEvictable(frame_id, false);
+        shard->io_in_progress_[frame_id] = true;
+        page.is_dirty_ = false;
+        frames.push_back(frame_id);
+        pages.emplace_back(page_id, page.data_);
+      }
+    }
+    lock.unlock();
+
+    // All the writes of the shard are in flight at the same time.
+    for (auto &write : WriteBack(&pages)) {
+      write.get();
+    }
+
+    lock.lock();
+    for (frame_id_t frame_id : frames) {
+      shard->io_in_progress_[frame_id] = false;
+      if (shard->pages_[frame_id].pin_count_ == 0) {
+        shard->replacer_->SetEvictable(frame_id, true);
+      }
+      shard->io_done_[frame_id].notify_all();
+    }
+  }
+  disk_manager_->SyncFreeSpaceMap();
+}
+
+auto BufferPoolManager::WriteBack(std::vector<std::pair<page_id_t, const char *>> *pages)
+    -> std::vector<std::future<bool>> {
+  std::sort(pages->begin(), pages->end());
+  std::vector<std::future<bool>> writes;
+  std::vector<const char *> run;
+  for (size_t i = 0; i < pages->size(); ++i) {
+    run.push_back((*pages)[i].second);
+    if (i + 1 == pages->size() || (*pages)[i + 1].first != (*pages)[i].first + 1) {
+      writes.push_back(
+          disk_manager_->WritePagesAsync((*pages)[i].first - static_cast<page_id_t>(run.size() - 1), run));
+      run.clear();
     }
   }
-  latch_.unlock();
+  return writes;
+}
+
+void BufferPoolManager::FlusherLoop() {
+  std::unique_lock lock(flusher_latch_);
+  while (!stop_flusher_) {
+    lock.unlock();
+    BackgroundFlush();
+    lock.lock();
+    flusher_cv_.wait_for(lock, background_flush_interval, [&] { return stop_flusher_; });
+  }
+}
+
+void BufferPoolManager::BackgroundFlush() {
+  struct Victim {
+    page_id_t page_id_;
+    Shard *shard_;
+    frame_id_t frame_id_;
+  };
+  std::vector<Victim> victims;
+
+  // Pick the dirty frames among the next victims of each shard, and reserve them the same way FlushPage() does.
+  for (auto &shard : shards_) {
+    std::scoped_lock lock(shard->latch_);
+    if (shard->free_list_.size() >= shard->flush_watermark_) {
+      continue;
+    }
+    for (frame_id_t frame_id : shard->replacer_->PeekVictims(shard->flush_watermark_ - shard->free_list_.size())) {
+      Page &page = shard->pages_[frame_id];
+      if (!page.is_dirty_) {
+        continue;
+      }
+      shard->replacer_->SetEvictable(frame_id, false);
+      shard->io_in_progress_[frame_id] = true;
+      page.is_dirty_ = false;
+      victims.push_back({page.page_id_, shard.get(), frame_id});
+    }
+  }
+  if (victims.empty()) {
+    return;
+  }
+
+  // Runs of adjacent page ids may span several shards.
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (auto &victim : victims) {
+    pages.emplace_back(victim.page_id_, victim.shard_->pages_[victim.frame_id_].data_);
+  }
+  for (auto &write : WriteBack(&pages)) {
+    write.get();
+  }
+  background_flushes_ += victims.size();
+
+  for (auto &victim : victims) {
+    Shard &shard = *victim.shard_;
+    std::scoped_lock lock(shard.latch_);
+    shard.io_in_progress_[victim.frame_id_] = false;
+    if (shard.pages_[victim.frame_id_].pin_count_ == 0) {
+      shard.replacer_->SetEvictable(victim.frame_id_, true);
+    }
+    shard.io_done_[victim.frame_id_].notify_all();
+  }
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  latch_.lock();
+  if (!DropPage(page_id)) {
+    return false;
+  }
+  DeallocatePage(page_id);
+  return true;
+}
+
+auto BufferPoolManager::DropPage(page_id_t page_id) -> bool {
+  Shard &shard = ShardOf(page_id);
+  std::unique_lock lock(shard.latch_);
   // Check if can delete
-  if (page_table_.find(page_id) == page_table_.end()) {
-    latch_.unlock();
+  frame_id_t frame_id = FindFrame(shard, lock, page_id);
+  if (frame_id == -1) {
     return true;
   }
-  frame_id_t frame_id = page_table_[page_id];
-  if (pages_[frame_id].GetPinCount() > 0) {
-    latch_.unlock();
+  Page &page = shard.pages_[frame_id];
+  // A swizzled page holds one pin of its own. Unswizzling it waits for nobody, like the pin check.
+  bool swizzled = page.IsSwizzled();
+  if (page.GetPinCount() > (swizzled ? 1 : 0) || (swizzled && !page.TryWLatch())) {
     return false;
   }
+  if (swizzled) {
+    page.swizzled_.store(false);
+    page.pin_count_ = 0;
+    shard.num_swizzled_--;
+    shard.replacer_->SetEvictable(frame_id, true);
+    page.WUnlatch();
+  }
   // Delete page
-  page_table_.erase(page_id);
-  replacer_->Remove(frame_id);
-  pages_[frame_id].ResetMemory();
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].pin_count_ = 0;
-  pages_[frame_id].is_dirty_ = false;
-  free_list_.emplace_back(frame_id);
-  latch_.unlock();
-  DeallocatePage(page_id);
+  shard.page_table_.erase(page_id);
+  shard.replacer_->Remove(frame_id);
+  page.ResetMemory();
+  page.page_id_ = INVALID_PAGE_ID;
+  page.pin_count_ = 0;
+  page.is_dirty_ = false;
+  shard.prefetched_[frame_id] = false;
+  shard.free_list_.emplace_back(frame_id);
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::GetGroup(const std::string &name) -> size_t {
+  std::unique_lock lock(group_latch_);
+  auto it = std::find(group_names_.begin(), group_names_.end(), name);
+  if (it != group_names_.end()) {
+    return it - group_names_.begin();
+  }
+  if (group_names_.size() == BUFFER_POOL_MAX_GROUPS) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "too many buffer pool groups");
+  }
+  group_names_.push_back(name);
+  group_reservations_.push_back(0);
+  return group_names_.size() - 1;
+}
+
+auto BufferPoolManager::FindGroup(const std::string &name) -> std::optional<size_t> {
+  std::shared_lock lock(group_latch_);
+  auto it = std::find(group_names_.begin(), group_names_.end(), name);
+  if (it == group_names_.end()) {
+    return std::nullopt;
+  }
+  return it - group_names_.begin();
+}
+
+void BufferPoolManager::SetGroupReservation(size_t group, size_t num_frames) {
+  BUSTUB_ENSURE(num_frames <= pool_size_, "cannot reserve more frames than the pool has");
+  {
+    std::unique_lock lock(group_latch_);
+    BUSTUB_ENSURE(group < group_names_.size(), "the group does not exist");
+    group_reservations_[group] = num_frames;
+  }
+  for (auto &shard : shards_) {
+    // Each shard reserves its share of the frames, rounded up.
+    shard->replacer_->SetReservation(group, (num_frames * shard->size_ + pool_size_ - 1) / pool_size_);
+  }
+}
+
+auto BufferPoolManager::GetGroupReservation(size_t group) -> size_t {
+  std::shared_lock lock(group_latch_);
+  return group < group_reservations_.size() ? group_reservations_[group] : 0;
+}
+
+auto BufferPoolManager::GetGroupSize(size_t group) -> size_t {
+  size_t size = 0;
+  for (auto &shard : shards_) {
+    size += shard->replacer_->GetGroupSize(group);
+  }
+  return size;
+}
+
+void BufferPoolManager::SetPageGroup(page_id_t first_page_id, size_t num_pages, size_t group) {
+  auto end_page_id = first_page_id + static_cast<page_id_t>(num_pages);
+  {
+    std::unique_lock lock(group_latch_);
+    BUSTUB_ENSURE(group < group_names_.size(), "the group does not exist");
+    if (group == 0) {
+      page_groups_.erase(first_page_id);
+    } else {
+      page_groups_[first_page_id] = {end_page_id, group};
+    }
+  }
+  for (page_id_t page_id = first_page_id; page_id < end_page_id; ++page_id) {
+    Shard &shard = ShardOf(page_id);
+    std::scoped_lock lock(shard.latch_);
+    auto it = shard.page_table_.find(page_id);
+    if (it != shard.page_table_.end() && shard.pages_[it->second].page_id_ == page_id) {
+      shard.replacer_->SetGroup(it->second, group);
+    }
+  }
+}
+
+auto BufferPoolManager::GroupOf(page_id_t page_id) -> size_t {
+  std::shared_lock lock(group_latch_);
+  auto it = page_groups_.upper_bound(page_id);
+  if (it == page_groups_.begin() || page_id >= std::prev(it)->second.first) {
+    return 0;
+  }
+  return std::prev(it)->second.second;
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+auto BufferPoolManager::AllocatePage(Shard &shard) -> page_id_t {
+  return disk_manager_->AllocatePage(shard.num_shards_, shard.index_);
+}
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  Page *page = FetchPage(page_id, AccessType::Scan);
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  Page *page = FetchPage(page_id, access_type);
   if (page != nullptr) {
     page->RLatch();
   }
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  Page *page = FetchPage(page_id, AccessType::Get);
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  Page *page = FetchPage(page_id, access_type);
   if (page != nullptr) {
     page->WLatch();
   }
   return {this, page};
 }
 
+auto BufferPoolManager::TryFetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  Page *page = FetchPage(page_id, access_type);
+  if (page != nullptr && !page->TryRLatch()) {
+    UnpinPage(page_id, false);
+    page = nullptr;
+  }
+  return {this, page};
+}
+
 auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
 
 }  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BUSTUB_FRAME_GUARDS
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BUSTUB_FRAME_GUARDS
+#endif
+#endif
+
+#ifdef BUSTUB_FRAME_GUARDS
+#include <sanitizer/asan_interface.h>
+#endif
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) : num_frames_(num_frames) {
+#ifdef BUSTUB_FRAME_GUARDS
+  stride_ = 2 * BUSTUB_PAGE_SIZE;
+#endif
+  size_t size = std::max<size_t>(num_frames_, 1) * stride_;
+  void *mem = MAP_FAILED;
+  if (huge_pages && size >= HUGE_PAGE_SIZE) {
+    length_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    // Fails unless enough huge pages are reserved, which is the cue to fall back to transparent huge pages.
+    mem = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_tlb_ = mem != MAP_FAILED;
+#endif
+    if (mem == MAP_FAILED) {
+      // Map one huge page more than needed and trim both ends, so that the arena starts on a huge page boundary.
+      size_t padded = length_ + HUGE_PAGE_SIZE;
+      mem = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mem != MAP_FAILED) {
+        auto start = reinterpret_cast<uintptr_t>(mem);
+        auto aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if (aligned > start) {
+          munmap(mem, aligned - start);
+        }
+        if (start + padded > aligned + length_) {
+          munmap(reinterpret_cast<void *>(aligned + length_), start + padded - aligned - length_);
+        }
+        mem = reinterpret_cast<void *>(aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(mem, length_, MADV_HUGEPAGE);
+#endif
+      }
+    }
+  } else {
+    length_ = size;
+    mem = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (mem == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+  }
+  base_ = static_cast<char *>(mem);
+
+#ifdef BUSTUB_FRAME_GUARDS
+  for (size_t i = 0; i < num_frames_; i++) {
+    ASAN_POISON_MEMORY_REGION(GetFrame(i) + BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE);
+  }
+#endif
+}
+
+FrameArena::~FrameArena() {
+#ifdef BUSTUB_FRAME_GUARDS
+  ASAN_UNPOISON_MEMORY_REGION(base_, length_);
+#endif
+  munmap(base_, length_);
+}
+
+}  // namespace bustub
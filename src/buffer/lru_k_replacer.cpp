@@ -14,81 +14,179 @@
 #include "common/exception.h"
 
 namespace bustub {
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : node_store_(num_frames, LRUKNode(k)), groups_(BUFFER_POOL_MAX_GROUPS), replacer_size_(num_frames), k_(k) {
+  // Evict() runs on every miss, so it works in these buffers instead of allocating.
+  cursors_.reserve(BUFFER_POOL_MAX_GROUPS);
+  victims_.reserve(1);
+}
+
+auto LRUKReplacer::SetOf(const LRUKNode &node) -> FrameSet & {
+  Group &group = groups_[node.GetGroup()];
+  if (node.IsScanOnly()) {
+    return group.scan_frames_;
+  }
+  return node.HasKAccesses() ? group.k_frames_ : group.inf_frames_;
+}
+
+void LRUKReplacer::Link(frame_id_t frame_id) {
+  auto &node = node_store_[frame_id];
+  SetOf(node).emplace(node.GetOldest(), frame_id);
+}
+
+void LRUKReplacer::Unlink(frame_id_t frame_id) {
+  auto &node = node_store_[frame_id];
+  SetOf(node).erase({node.GetOldest(), frame_id});
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-  latch_.lock();
+  std::scoped_lock lock(latch_);
   if (curr_size_ == 0) {
-    latch_.unlock();
     return false;
   }
-  auto evict = node_store_.end();
-  for (auto cur = node_store_.begin(); cur != node_store_.end(); ++cur) {
-    if (!cur->second.GetEvictable()) {
-      continue;
-    }
-    if (evict == node_store_.end()) {
-      evict = cur;
-      continue;
-    }
-    if (evict->second.GetBackwardKDis() == cur->second.GetBackwardKDis()) {
-      if (evict->second.GetLeastRecent() > cur->second.GetLeastRecent()) {
-        evict = cur;
-      }
-    } else if (evict->second.GetBackwardKDis() > cur->second.GetBackwardKDis()) {
-      evict = cur;
-    }
-  }
-  *frame_id = evict->first;
+  CollectVictims(1, &victims_);
+  *frame_id = victims_[0];
+  Unlink(*frame_id);
   --curr_size_;
-  node_store_.erase(*frame_id);
-  latch_.unlock();
+  Forget(*frame_id);
   return true;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+void LRUKReplacer::Forget(frame_id_t frame_id) {
+  auto &node = node_store_[frame_id];
+  groups_[node.GetGroup()].num_frames_--;
+  node.SetEvictable(false);
+  node.Reset();
+  node.SetGroup(0);
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
   BUSTUB_ASSERT((size_t)frame_id < replacer_size_, fmt::format("frame id {} is invalid", frame_id).c_str());
-  latch_.lock();
-  auto it = node_store_.find(frame_id);
-  if (it == node_store_.end()) {
-    node_store_[frame_id] = LRUKNode(k_, frame_id);
-    node_store_[frame_id].Access(++current_timestamp_);
-  } else {
-    it->second.Access(++current_timestamp_);
+  std::scoped_lock lock(latch_);
+  auto &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (is_scan && node.IsTracked() && !node.IsScanOnly()) {
+    // Do not let a scan pollute the history of a frame that is used otherwise.
+    return;
+  }
+  if (!node.IsTracked()) {
+    groups_[node.GetGroup()].num_frames_++;
+  }
+  if (node.GetEvictable()) {
+    Unlink(frame_id);
+  }
+  if (!is_scan && node.IsScanOnly()) {
+    // First real access to a frame brought in by a scan: its history starts now.
+    node.Reset();
+    node.SetScanOnly(false);
+  }
+  node.Access(++current_timestamp_);
+  if (node.GetEvictable()) {
+    Link(frame_id);
   }
-  latch_.unlock();
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
-  latch_.lock();
-  auto it = node_store_.find(frame_id);
-  if (it != node_store_.end()) {
-    bool diff = (it->second.GetEvictable() != set_evictable);
-    it->second.SetEvictable(set_evictable);
-    if (diff) {
-      if (set_evictable) {
-        ++curr_size_;
-      } else {
-        --curr_size_;
-      }
-    }
+  BUSTUB_ASSERT((size_t)frame_id < replacer_size_, fmt::format("frame id {} is invalid", frame_id).c_str());
+  std::scoped_lock lock(latch_);
+  auto &node = node_store_[frame_id];
+  if (!node.IsTracked() || node.GetEvictable() == set_evictable) {
+    return;
+  }
+  node.SetEvictable(set_evictable);
+  if (set_evictable) {
+    Link(frame_id);
+    ++curr_size_;
+  } else {
+    Unlink(frame_id);
+    --curr_size_;
   }
-  latch_.unlock();
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
-  latch_.lock();
-  auto it = node_store_.find(frame_id);
-  if (it != node_store_.end()) {
-    if (!it->second.GetEvictable()) {
-      throw ExecutionException("Remove a non-evictable frame");
-    }
-    --curr_size_;
-    node_store_.erase(frame_id);
+  BUSTUB_ASSERT((size_t)frame_id < replacer_size_, fmt::format("frame id {} is invalid", frame_id).c_str());
+  std::scoped_lock lock(latch_);
+  auto &node = node_store_[frame_id];
+  if (!node.IsTracked()) {
+    return;
   }
-  latch_.unlock();
+  if (!node.GetEvictable()) {
+    throw ExecutionException("Remove a non-evictable frame");
+  }
+  Unlink(frame_id);
+  --curr_size_;
+  Forget(frame_id);
 }
 
 auto LRUKReplacer::Size() -> size_t { return curr_size_; }
 
+auto LRUKReplacer::PeekVictims(size_t n) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> victims;
+  CollectVictims(n, &victims);
+  return victims;
+}
+
+void LRUKReplacer::CollectVictims(size_t n, std::vector<frame_id_t> *victims) {
+  victims->clear();
+  // Groups outside their reservation go first. Within that, frames only touched by scans go first, then frames with
+  // +inf backward k-distance, then the rest, merged over the groups by their oldest remembered access.
+  for (bool reserved : {false, true}) {
+    for (FrameSet Group::*frames : {&Group::scan_frames_, &Group::inf_frames_, &Group::k_frames_}) {
+      cursors_.clear();
+      for (const auto &group : groups_) {
+        if (IsReserved(group) == reserved && !(group.*frames).empty()) {
+          cursors_.emplace_back((group.*frames).begin(), (group.*frames).end());
+        }
+      }
+      while (victims->size() < n) {
+        auto oldest = cursors_.end();
+        for (auto it = cursors_.begin(); it != cursors_.end(); ++it) {
+          if (it->first != it->second && (oldest == cursors_.end() || *it->first < *oldest->first)) {
+            oldest = it;
+          }
+        }
+        if (oldest == cursors_.end()) {
+          break;
+        }
+        victims->push_back(oldest->first->second);
+        ++oldest->first;
+      }
+    }
+  }
+}
+
+void LRUKReplacer::SetGroup(frame_id_t frame_id, size_t group) {
+  BUSTUB_ASSERT((size_t)frame_id < replacer_size_, fmt::format("frame id {} is invalid", frame_id).c_str());
+  BUSTUB_ASSERT(group < groups_.size(), "group is invalid");
+  std::scoped_lock lock(latch_);
+  auto &node = node_store_[frame_id];
+  if (node.GetGroup() == group) {
+    return;
+  }
+  if (node.GetEvictable()) {
+    Unlink(frame_id);
+  }
+  if (node.IsTracked()) {
+    groups_[node.GetGroup()].num_frames_--;
+    groups_[group].num_frames_++;
+  }
+  node.SetGroup(group);
+  if (node.GetEvictable()) {
+    Link(frame_id);
+  }
+}
+
+void LRUKReplacer::SetReservation(size_t group, size_t num_frames) {
+  BUSTUB_ASSERT(group < groups_.size(), "group is invalid");
+  std::scoped_lock lock(latch_);
+  groups_[group].reserved_ = num_frames;
+}
+
+auto LRUKReplacer::GetGroupSize(size_t group) -> size_t {
+  BUSTUB_ASSERT(group < groups_.size(), "group is invalid");
+  std::scoped_lock lock(latch_);
+  return groups_[group].num_frames_;
+}
+
 }  // namespace bustub
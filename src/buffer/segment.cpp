@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// segment.cpp
+//
+// Identification: src/buffer/segment.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/segment.h"
+
+namespace bustub {
+
+Segment::Segment(BufferPoolManager *bpm, size_t extent_size, size_t group)
+    : bpm_(bpm), extent_size_(extent_size), group_(group) {
+  BUSTUB_ASSERT(extent_size > 0, "an extent holds at least one page");
+}
+
+auto Segment::NewPage(page_id_t *page_id) -> Page * {
+  // Consecutive page ids belong to different shards of the buffer pool. If the shard of a candidate has every frame
+  // pinned, the next candidates are likely to be in other shards.
+  std::vector<page_id_t> skipped;
+  Page *page = nullptr;
+  for (size_t attempt = 0; attempt < bpm_->GetNumShards() && page == nullptr; ++attempt) {
+    {
+      std::scoped_lock lock(latch_);
+      *page_id = TakePageId();
+    }
+    page = bpm_->NewPageWithId(*page_id);
+    if (page == nullptr) {
+      skipped.push_back(*page_id);
+    }
+  }
+  if (!skipped.empty()) {
+    std::scoped_lock lock(latch_);
+    free_pages_.insert(skipped.begin(), skipped.end());
+  }
+  if (page == nullptr) {
+    *page_id = INVALID_PAGE_ID;
+  }
+  return page;
+}
+
+auto Segment::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {bpm_, NewPage(page_id)}; }
+
+auto Segment::DeletePage(page_id_t page_id) -> bool {
+  if (!bpm_->DropPage(page_id)) {
+    return false;
+  }
+  std::scoped_lock lock(latch_);
+  free_pages_.insert(page_id);
+  return true;
+}
+
+void Segment::Drop() {
+  std::scoped_lock lock(latch_);
+  for (page_id_t first_page_id : extents_) {
+    for (size_t i = 0; i < extent_size_; ++i) {
+      BUSTUB_ENSURE(bpm_->DropPage(first_page_id + static_cast<page_id_t>(i)), "cannot drop a pinned page");
+    }
+    if (group_ != 0) {
+      bpm_->SetPageGroup(first_page_id, extent_size_, 0);
+    }
+    bpm_->DeallocateExtent(first_page_id, extent_size_);
+  }
+  extents_.clear();
+  next_offset_ = 0;
+  free_pages_.clear();
+}
+
+auto Segment::GetExtents() -> std::vector<page_id_t> {
+  std::scoped_lock lock(latch_);
+  return extents_;
+}
+
+auto Segment::GetNumPages() -> size_t {
+  std::scoped_lock lock(latch_);
+  if (extents_.empty()) {
+    return 0;
+  }
+  return (extents_.size() - 1) * extent_size_ + next_offset_ - free_pages_.size();
+}
+
+void Segment::SetGroup(size_t group) {
+  std::scoped_lock lock(latch_);
+  group_ = group;
+  for (page_id_t first_page_id : extents_) {
+    bpm_->SetPageGroup(first_page_id, extent_size_, group_);
+  }
+}
+
+auto Segment::GetGroup() -> size_t {
+  std::scoped_lock lock(latch_);
+  return group_;
+}
+
+auto Segment::TakePageId() -> page_id_t {
+  if (!free_pages_.empty()) {
+    page_id_t page_id = *free_pages_.begin();
+    free_pages_.erase(free_pages_.begin());
+    return page_id;
+  }
+  if (extents_.empty() || next_offset_ == extent_size_) {
+    extents_.push_back(bpm_->AllocateExtent(extent_size_));
+    next_offset_ = 0;
+    // Register the extent before its first page is created, so that the page is loaded into the right group.
+    if (group_ != 0) {
+      bpm_->SetPageGroup(extents_.back(), extent_size_, group_);
+    }
+  }
+  return extents_.back() + static_cast<page_id_t>(next_offset_++);
+}
+
+}  // namespace bustub
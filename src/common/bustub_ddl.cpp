@@ -1,6 +1,8 @@
 // DDL (Data Definition Language) statement handling in BusTub, including create table, create index, and set/show
 // variable.
 
+#include <algorithm>
+#include <cctype>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -36,6 +38,8 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/table/table_heap.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -56,25 +60,26 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   for (const auto &col : stmt.cols_) {
     auto idx = stmt.table_->schema_.GetColIdx(col->col_name_.back());
     col_ids.push_back(idx);
-    if (stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-      throw NotImplementedException("only support creating index on integer column");
-    }
   }
   auto key_schema = Schema::CopySchema(&stmt.table_->schema_, col_ids);
+  std::vector<uint32_t> include_ids;
+  for (const auto &col : stmt.include_cols_) {
+    include_ids.push_back(stmt.table_->schema_.GetColIdx(col->col_name_.back()));
+  }
 
-  // TODO(spring2023): If you want to support composite index key for leaderboard optimization, remove this assertion
-  // and create index with different key type that can hold multiple keys based on number of index columns.
-  //
   // You can also create clustered index that directly stores value inside the index by modifying the value type.
 
-  if (col_ids.empty() || col_ids.size() > 2) {
-    throw NotImplementedException("only support creating index with exactly one or two columns");
+  if (col_ids.empty()) {
+    throw NotImplementedException("index must have at least one column");
   }
 
+  // The catalog picks the key type and comparator from the key schema. Without UNIQUE, a key may map to any number
+  // of tuples. Included columns are stored in the entries after the key, so that scans reading only them and the key
+  // need not fetch the tuples.
+  auto index_type = stmt.index_type_ == "hash" ? IndexType::HashTableIndex : IndexType::BPlusTreeIndex;
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+  auto info = catalog_->CreateIndex(txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema,
+                                    col_ids, stmt.unique_, include_ids, index_type);
   l.unlock();
 
   if (info == nullptr) {
@@ -133,6 +138,50 @@ void BustubInstance::HandleVariableShowStatement(Transaction *txn, const Variabl
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  // `SET buffer_pool_group_<table or index> = '<group>'` moves the pages of an object to a buffer pool group, creating
+  // the group if needed, and `SET buffer_pool_reserve_<group> = <frames>` reserves frames for an existing group. The
+  // B+ tree indexes start out in the "index" group.
+  const std::string reserve_prefix = "buffer_pool_reserve_";
+  const std::string group_prefix = "buffer_pool_group_";
+  if (StringUtil::StartsWith(stmt.variable_, reserve_prefix)) {
+    auto name = stmt.variable_.substr(reserve_prefix.size());
+    auto group = buffer_pool_manager_->FindGroup(name);
+    if (!group.has_value()) {
+      throw bustub::Exception(fmt::format("buffer pool group {} not found", name));
+    }
+    auto is_digit = [](unsigned char c) { return std::isdigit(c) != 0; };
+    if (stmt.value_.empty() || !std::all_of(stmt.value_.begin(), stmt.value_.end(), is_digit) ||
+        stmt.value_.size() > std::to_string(buffer_pool_manager_->GetPoolSize()).size() ||
+        std::stoul(stmt.value_) > buffer_pool_manager_->GetPoolSize()) {
+      throw bustub::Exception(fmt::format("invalid number of frames: {}, the buffer pool has {} frames", stmt.value_,
+                                          buffer_pool_manager_->GetPoolSize()));
+    }
+    buffer_pool_manager_->SetGroupReservation(*group, std::stoul(stmt.value_));
+  } else if (StringUtil::StartsWith(stmt.variable_, group_prefix)) {
+    auto name = stmt.variable_.substr(group_prefix.size());
+    std::shared_lock<std::shared_mutex> l(catalog_lock_);
+    Segment *segment = nullptr;
+    if (auto *table_info = catalog_->GetTable(name); table_info != Catalog::NULL_TABLE_INFO) {
+      segment = table_info->table_->GetSegment();
+    } else {
+      for (const auto &table_name : catalog_->GetTableNames()) {
+        for (auto *index_info : catalog_->GetTableIndexes(table_name)) {
+          if (index_info->name_ != name) {
+            continue;
+          }
+          auto *index = dynamic_cast<BPlusTreeIndexBase *>(index_info->index_.get());
+          if (index == nullptr) {
+            throw bustub::Exception(fmt::format("index {} cannot be assigned to a buffer pool group", name));
+          }
+          segment = index->GetSegment();
+        }
+      }
+    }
+    if (segment == nullptr) {
+      throw bustub::Exception(fmt::format("table or index {} not found", name));
+    }
+    segment->SetGroup(buffer_pool_manager_->GetGroup(stmt.value_));
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
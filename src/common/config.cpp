@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds background_flush_interval = std::chrono::milliseconds(10);
+
+std::atomic<bool> enable_warm_restart(false);
+
+std::chrono::milliseconds warm_restart_dump_interval = std::chrono::seconds(10);
+
 }  // namespace bustub
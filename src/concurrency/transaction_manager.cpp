@@ -38,12 +38,14 @@ void TransactionManager::Abort(Transaction *txn) {
   for (auto &write_record : *index_write_set) {
     auto index_info = write_record.catalog_->GetIndex(write_record.index_oid_);
     if (write_record.wtype_ == WType::INSERT) {
-      auto key = write_record.tuple_.KeyFromTuple(write_record.catalog_->GetTable(write_record.table_oid_)->schema_,
-                                                  index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      auto key =
+          write_record.tuple_.KeyFromTuple(write_record.catalog_->GetTable(write_record.table_oid_)->schema_,
+                                           *index_info->index_->GetEntrySchema(), index_info->index_->GetEntryAttrs());
       index_info->index_->DeleteEntry(key, write_record.rid_, txn);
     } else if (write_record.wtype_ == WType::DELETE) {
-      auto key = write_record.tuple_.KeyFromTuple(write_record.catalog_->GetTable(write_record.table_oid_)->schema_,
-                                                  index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      auto key =
+          write_record.tuple_.KeyFromTuple(write_record.catalog_->GetTable(write_record.table_oid_)->schema_,
+                                           *index_info->index_->GetEntrySchema(), index_info->index_->GetEntryAttrs());
       index_info->index_->InsertEntry(key, write_record.rid_, txn);
     }
   }
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -19,14 +20,29 @@
 #include "common/logger.h"
 #include "common/rid.h"
 #include "container/disk/hash/disk_extendible_hash_table.h"
+#include "storage/index/normalized_key.h"
+#include "storage/index/packed_integer_key.h"
 
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                         const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+                                         const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                                         bool is_unique)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      hash_fn_(std::move(hash_fn)),
+      is_unique_(is_unique) {
+  // an empty table is a directory of global depth 0 pointing to one empty bucket
+  auto dir_page =
+      reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->NewPage(&directory_page_id_)->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&bucket_page_id)->GetData())->Init();
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,22 +62,156 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::IsDuplicate(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value)
+    -> bool {
+  // The values are compared first, they are cheaper to compare than keys and tell the pairs of many equal keys apart.
+  auto holds = [&](HASH_TABLE_BUCKET_TYPE *page) {
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE && page->IsOccupied(slot); slot++) {
+      if (page->IsReadable(slot) && (is_unique_ || page->ValueAt(slot) == value) &&
+          comparator_(key, page->KeyAt(slot)) == 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  bool duplicate = holds(bucket);
+  page_id_t page_id = bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID && !duplicate) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    duplicate = holds(overflow);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return duplicate;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetChainValue(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, std::vector<ValueType> *result)
+    -> bool {
+  bool found = bucket->GetValue(key, comparator_, result);
+  page_id_t page_id = bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    found = overflow->GetValue(key, comparator_, result) || found;
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertIntoChain(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value)
+    -> bool {
+  if (bucket->Insert(key, value, comparator_)) {
+    return true;
+  }
+  page_id_t page_id = bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    bool inserted = !overflow->IsFull() && overflow->Insert(key, value, comparator_);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      return true;
+    }
+    page_id = next_page_id;
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::RemoveFromChain(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value)
+    -> bool {
+  if (bucket->Remove(key, value, comparator_)) {
+    return true;
+  }
+  // The page before the current one stays pinned, to unlink the current one from it. The bucket is pinned by the
+  // caller.
+  HASH_TABLE_BUCKET_TYPE *prev = bucket;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    bool removed = overflow->Remove(key, value, comparator_);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    bool unlinked = removed && overflow->IsEmpty();
+    if (unlinked) {
+      prev->SetNextPageId(next_page_id);
+    }
+    if (prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, unlinked);
+    }
+    if (removed) {
+      buffer_pool_manager_->UnpinPage(page_id, !unlinked);
+      if (unlinked) {
+        buffer_pool_manager_->DeletePage(page_id);
+      }
+      return true;
+    }
+    prev = overflow;
+    prev_page_id = page_id;
+    page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::AppendOverflowPage(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value) {
+  // The order of the overflow pages does not matter, so the new one goes right after the bucket.
+  page_id_t overflow_page_id;
+  auto overflow =
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&overflow_page_id)->GetData());
+  overflow->Init();
+  overflow->Insert(key, value, comparator_);
+  overflow->SetNextPageId(bucket->GetNextPageId());
+  bucket->SetNextPageId(overflow_page_id);
+  buffer_pool_manager_->UnpinPage(overflow_page_id, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CollectChain(HASH_TABLE_BUCKET_TYPE *bucket, std::vector<MappingType> *pairs,
+                                   std::vector<page_id_t> *overflow_page_ids) {
+  auto collect = [pairs](HASH_TABLE_BUCKET_TYPE *page) {
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE; slot++) {
+      if (page->IsReadable(slot)) {
+        pairs->emplace_back(page->KeyAt(slot), page->ValueAt(slot));
+      }
+    }
+  };
+  collect(bucket);
+  page_id_t page_id = bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    HASH_TABLE_BUCKET_TYPE *overflow = FetchBucketPage(page_id);
+    collect(overflow);
+    overflow_page_ids->push_back(page_id);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
 }
 
 /*****************************************************************************
@@ -69,7 +219,17 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->RLatch();
+  bool found = GetChainValue(reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData()), key, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +237,100 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool duplicate = IsDuplicate(bucket, key, value);
+  bool inserted = !duplicate && InsertIntoChain(bucket, key, value);
+  bool full = !duplicate && !inserted;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (!full) {
+    return inserted;
+  }
+  return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  bool inserted = false;
+  // Another thread may have split the bucket in the meantime, and all the pairs may land in the same half, so split
+  // until the bucket of the key has room.
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket = FetchBucketPage(bucket_page_id);
+    if (IsDuplicate(bucket, key, value)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    if (InsertIntoChain(bucket, key, value)) {
+      inserted = true;
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      break;
+    }
+
+    // Splits only separate pairs whose hashes differ in the bits a full directory looks at. If none of the pairs
+    // does from the key, as for many equal keys, the pair goes to an overflow page. So a bucket whose local depth is
+    // that of a full directory is never split.
+    std::vector<MappingType> pairs;
+    std::vector<page_id_t> overflow_page_ids;
+    CollectChain(bucket, &pairs, &overflow_page_ids);
+    uint32_t hash = Hash(key);
+    if (std::none_of(pairs.begin(), pairs.end(), [this, hash](const MappingType &pair) {
+          return ((Hash(pair.first) ^ hash) & (DIRECTORY_ARRAY_SIZE - 1)) != 0;
+        })) {
+      AppendOverflowPage(bucket, key, value);
+      inserted = true;
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      break;
+    }
+
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+
+    // The directory entries of the bucket, and its pairs, whose hash has the bit above the local depth set move to
+    // the split image. The overflow pages are dropped, and refilled as needed.
+    page_id_t image_page_id;
+    auto image = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&image_page_id)->GetData());
+    image->Init();
+    uint32_t high_bit = 1U << local_depth;
+    for (uint32_t idx = 0; idx < dir_page->Size(); idx++) {
+      if (dir_page->GetBucketPageId(idx) == bucket_page_id) {
+        dir_page->IncrLocalDepth(idx);
+        if ((idx & high_bit) != 0) {
+          dir_page->SetBucketPageId(idx, image_page_id);
+        }
+      }
+    }
+    for (page_id_t overflow_page_id : overflow_page_ids) {
+      buffer_pool_manager_->DeletePage(overflow_page_id);
+    }
+    bucket->Init();
+    for (const auto &[pair_key, pair_value] : pairs) {
+      HASH_TABLE_BUCKET_TYPE *half = (Hash(pair_key) & high_bit) != 0 ? image : bucket;
+      if (!InsertIntoChain(half, pair_key, pair_value)) {
+        AppendOverflowPage(half, pair_key, pair_value);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    dir_dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,14 +338,72 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = RemoveFromChain(bucket, key, value);
+  bool empty = IsChainEmpty(bucket);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  // Merge the bucket of the key with its split image while one of them is empty, the merged bucket may be empty again.
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    bool bucket_empty = IsChainEmpty(FetchBucketPage(bucket_page_id));
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    bool image_empty = IsChainEmpty(FetchBucketPage(image_page_id));
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+
+    page_id_t keep_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    page_id_t drop_page_id = bucket_empty ? bucket_page_id : image_page_id;
+    for (uint32_t idx = 0; idx < dir_page->Size(); idx++) {
+      page_id_t page_id = dir_page->GetBucketPageId(idx);
+      if (page_id == keep_page_id || page_id == drop_page_id) {
+        dir_page->SetBucketPageId(idx, keep_page_id);
+        dir_page->SetLocalDepth(idx, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(drop_page_id);
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+    dir_dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -134,5 +440,10 @@ template class DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>
 template class DiskExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class DiskExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class DiskExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+template class DiskExtendibleHashTable<PackedIntegerKey, RID, PackedIntegerComparator>;
+template class DiskExtendibleHashTable<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class DiskExtendibleHashTable<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class DiskExtendibleHashTable<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class DiskExtendibleHashTable<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
@@ -10,12 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "common/exception.h"
+#include "common/macros.h"
 #include "common/logger.h"
 #include "common/rid.h"
 #include "container/disk/hash/linear_probe_hash_table.h"
@@ -26,20 +28,124 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateTable(num_buckets, &size_);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  table_latch_.RLock();
+  bool found = GetValueFrom(header_page_id_, key, result);
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    found = GetValueFrom(old_header_page_id_, key, result) || found;
+  }
+  table_latch_.RUnlock();
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetValueFrom(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result)
+    -> bool {
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id);
+  auto header = header_guard.As<HashTableHeaderPage>();
+  size_t size = header->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  ReadPageGuard block_guard;
+  const HASH_TABLE_BLOCK_TYPE *block = nullptr;
+  bool found = false;
+  for (size_t i = 0; i < size; i++, slot = (slot + 1) % size) {
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (i == 0 || offset == 0) {
+      // Latch one block at a time, a probe sequence can wrap around to the first block.
+      block_guard.Drop();
+      block_guard = buffer_pool_manager_->FetchPageRead(header->GetBlockPageId(slot / BLOCK_ARRAY_SIZE));
+      block = block_guard.As<HASH_TABLE_BLOCK_TYPE>();
+    }
+    if (!block->IsOccupied(offset)) {
+      break;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+  }
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
+  while (true) {
+    table_latch_.RLock();
+    page_id_t header_page_id = header_page_id_;
+    bool migrating = old_header_page_id_ != INVALID_PAGE_ID;
+    bool inserted = false;
+    bool full = false;
+    std::vector<ValueType> old_values;
+    if (!migrating || !GetValueFrom(old_header_page_id_, key, &old_values) ||
+        std::find(old_values.begin(), old_values.end(), value) == old_values.end()) {
+      inserted = InsertInto(key, value, MaxOccupied(), &full);
+    }
+    table_latch_.RUnlock();
+
+    if (!full) {
+      if (inserted) {
+        num_live_++;
+      }
+      if (inserted && migrating) {
+        table_latch_.WLock();
+        MigrateBlocks(MIGRATE_BLOCKS_PER_INSERT);
+        table_latch_.WUnlock();
+      }
+      return inserted;
+    }
+
+    // Another insert may have grown the table already.
+    table_latch_.WLock();
+    bool grown = header_page_id_ != header_page_id || Grow(GrowthSize());
+    table_latch_.WUnlock();
+    if (!grown) {
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertInto(const KeyType &key, const ValueType &value, size_t max_occupied, bool *full)
+    -> bool {
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  auto header = header_guard.As<HashTableHeaderPage>();
+  size_t size = header->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  WritePageGuard block_guard;
+  HASH_TABLE_BLOCK_TYPE *block = nullptr;
+  *full = false;
+  for (size_t i = 0; i < size; i++, slot = (slot + 1) % size) {
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (i == 0 || offset == 0) {
+      block_guard.Drop();
+      block_guard = buffer_pool_manager_->FetchPageWrite(header->GetBlockPageId(slot / BLOCK_ARRAY_SIZE));
+      block = block_guard.AsMut<HASH_TABLE_BLOCK_TYPE>();
+    }
+    if (!block->IsOccupied(offset)) {
+      if (num_occupied_ >= max_occupied) {
+        break;
+      }
+      // The block is write latched, so nobody else can claim the slot.
+      block->Insert(offset, key, value);
+      num_occupied_++;
+      return true;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value) {
+      return false;
+    }
+  }
+  *full = true;
   return false;
 }
 
@@ -48,6 +154,39 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
+  table_latch_.RLock();
+  bool removed = RemoveFrom(header_page_id_, key, value) ||
+                 (old_header_page_id_ != INVALID_PAGE_ID && RemoveFrom(old_header_page_id_, key, value));
+  if (removed) {
+    num_live_--;
+  }
+  table_latch_.RUnlock();
+  return removed;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::RemoveFrom(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool {
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id);
+  auto header = header_guard.As<HashTableHeaderPage>();
+  size_t size = header->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  WritePageGuard block_guard;
+  HASH_TABLE_BLOCK_TYPE *block = nullptr;
+  for (size_t i = 0; i < size; i++, slot = (slot + 1) % size) {
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (i == 0 || offset == 0) {
+      block_guard.Drop();
+      block_guard = buffer_pool_manager_->FetchPageWrite(header->GetBlockPageId(slot / BLOCK_ARRAY_SIZE));
+      block = block_guard.AsMut<HASH_TABLE_BLOCK_TYPE>();
+    }
+    if (!block->IsOccupied(offset)) {
+      break;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value) {
+      block->Remove(offset);
+      return true;
+    }
+  }
   return false;
 }
 
@@ -55,14 +194,123 @@ auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  while (Grow(2 * size_) && size_ < 2 * initial_size) {
+  }
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::Grow(size_t num_slots) -> bool {
+  // The old entries take at most half of the new table, so migrating a block per insert always empties the old one
+  // long before the new one fills up. Only an explicit Resize can come here mid-migration.
+  MigrateBlocks(SIZE_MAX);
+  if (num_slots > size_ && size_ >= HashTableHeaderPage::MAX_BLOCKS * BLOCK_ARRAY_SIZE) {
+    return false;
+  }
+  old_header_page_id_ = header_page_id_;
+  next_migrate_block_ = 0;
+  header_page_id_ = CreateTable(num_slots, &size_);
+  num_occupied_ = 0;
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GrowthSize() -> size_t {
+  // Tombstones fill a table as much as entries do, so a table whose entries take less than half of it is only rebuilt
+  // at the same size, which leaves its tombstones behind. A table that cannot grow any more is rebuilt as long as it
+  // has any tombstones.
+  bool at_max_size = size_ >= HashTableHeaderPage::MAX_BLOCKS * BLOCK_ARRAY_SIZE;
+  return num_live_ < size_ / 2 || (at_max_size && num_live_ < size_) ? size_ : 2 * size_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateBlocks(size_t num_blocks) {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  WritePageGuard old_header_guard = buffer_pool_manager_->FetchPageWrite(old_header_page_id_);
+  auto old_header = old_header_guard.AsMut<HashTableHeaderPage>();
+  for (; num_blocks > 0 && next_migrate_block_ < old_header->NumBlocks(); num_blocks--, next_migrate_block_++) {
+    WritePageGuard block_guard = buffer_pool_manager_->FetchPageWrite(old_header->GetBlockPageId(next_migrate_block_));
+    auto block = block_guard.AsMut<HASH_TABLE_BLOCK_TYPE>();
+    for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+      if (block->IsReadable(offset)) {
+        ResizeInsert(block->KeyAt(offset), block->ValueAt(offset));
+        block->Remove(offset);
+      }
+    }
+  }
+  if (next_migrate_block_ == old_header->NumBlocks()) {
+    DeleteBlockPages(old_header);
+    old_header_guard.Drop();
+    buffer_pool_manager_->DeletePage(old_header_page_id_);
+    old_header_page_id_ = INVALID_PAGE_ID;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ResizeInsert(const KeyType &key, const ValueType &value) {
+  bool full;
+  [[maybe_unused]] bool inserted = InsertInto(key, value, size_, &full);
+  BUSTUB_ASSERT(inserted, "the new table must have room for every entry of the old one");
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::MaxOccupied() -> size_t {
+  // A table that cannot grow any more takes entries until it is full.
+  return size_ >= HashTableHeaderPage::MAX_BLOCKS * BLOCK_ARRAY_SIZE ? size_ : size_ - size_ / 4;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::CreateTable(size_t num_slots, size_t *size) -> page_id_t {
+  page_id_t header_page_id;
+  BasicPageGuard header_guard = buffer_pool_manager_->NewPageGuarded(&header_page_id);
+  auto header = header_guard.AsMut<HashTableHeaderPage>();
+  header->Init(header_page_id);
+  size_t num_blocks =
+      std::clamp<size_t>((num_slots + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1, HashTableHeaderPage::MAX_BLOCKS);
+  CreateNewBlockPages(header, num_blocks);
+  *size = num_blocks * BLOCK_ARRAY_SIZE;
+  header->SetSize(*size);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks) {
+  // New pages are zeroed, which leaves every slot of a block unoccupied. They are written out as such if evicted.
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    buffer_pool_manager_->NewPageGuarded(&block_page_id).GetDataMut();
+    header_page->AddBlockPageId(block_page_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteBlockPages(HashTableHeaderPage *old_header_page) {
+  for (size_t i = 0; i < old_header_page->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(old_header_page->GetBlockPageId(i));
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  table_latch_.RLock();
+  size_t size = size_;
+  table_latch_.RUnlock();
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::IsMigrating() -> bool {
+  table_latch_.RLock();
+  bool migrating = old_header_page_id_ != INVALID_PAGE_ID;
+  table_latch_.RUnlock();
+  return migrating;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
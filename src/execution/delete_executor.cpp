@@ -50,8 +50,8 @@ auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
     table_info_->table_->UpdateTupleMeta(tuple_meta, *rid);
     auto txn = exec_ctx_->GetTransaction();
     for (auto &index_info : index_info_arr_) {
-      Tuple key =
-          child_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      Tuple key = child_tuple.KeyFromTuple(table_info_->schema_, *index_info->index_->GetEntrySchema(),
+                                           index_info->index_->GetEntryAttrs());
       index_info->index_->DeleteEntry(key, *rid, txn);
     }
     txn->LockTxn();
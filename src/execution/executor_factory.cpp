@@ -20,6 +20,7 @@
 #include "execution/executors/delete_executor.h"
 #include "execution/executors/filter_executor.h"
 #include "execution/executors/hash_join_executor.h"
+#include "execution/executors/index_only_scan_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/init_check_executor.h"
 #include "execution/executors/insert_executor.h"
@@ -58,6 +59,12 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
     }
 
+    // Create a new index-only scan executor
+    case PlanType::IndexOnlyScan: {
+      return std::make_unique<IndexOnlyScanExecutor>(exec_ctx,
+                                                     dynamic_cast<const IndexOnlyScanPlanNode *>(plan.get()));
+    }
+
     // Create a new insert executor
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan.get());
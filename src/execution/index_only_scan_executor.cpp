@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.cpp
+//
+// Identification: src/execution/index_only_scan_executor.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/index_only_scan_executor.h"
+#include "execution/executors/index_scan_executor.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexOnlyScanExecutor::Init() {
+  index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  auto *index = dynamic_cast<BPlusTreeIndexBase *>(index_info_->index_.get());
+  auto cursor = IndexScanExecutor::OpenCursor(index, index_info_->key_schema_, plan_->lower_bound_, plan_->upper_bound_,
+                                              plan_->IsReverse());
+
+  // Build the tuples before emitting anything, for the same reason the index scan collects its RIDs first. The
+  // columns the index does not store stay NULL.
+  tuples_.clear();
+  next_tuple_ = 0;
+  const auto &schema = GetOutputSchema();
+  const auto &entry_attrs = index->GetEntryAttrs();
+  const auto &end_bound = plan_->IsReverse() ? plan_->lower_bound_ : plan_->upper_bound_;
+  std::vector<std::vector<Value>> keys;
+  std::vector<Value> entry;
+  std::vector<Value> values;
+  for (; !cursor->IsEnd(); cursor->Next()) {
+    if (plan_->limit_.has_value() && tuples_.size() == *plan_->limit_) {
+      break;
+    }
+    cursor->GetEntry(&entry);
+    if (!end_bound.empty() && (plan_->IsReverse() ? IndexScanExecutor::BeforeLowerBound(entry, end_bound)
+                                                  : IndexScanExecutor::PastUpperBound(entry, end_bound))) {
+      break;
+    }
+    values.clear();
+    for (const auto &column : schema.GetColumns()) {
+      values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+    }
+    for (size_t i = 0; i < entry_attrs.size(); i++) {
+      values[entry_attrs[i]] = entry[i];
+    }
+    Tuple tuple(values, &schema);
+    if (plan_->filter_predicate_ != nullptr) {
+      auto value = plan_->filter_predicate_->Evaluate(&tuple, schema);
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    tuples_.emplace_back(std::move(tuple), cursor->GetRID());
+    if (plan_->IsMixedOrder()) {
+      keys.emplace_back(entry.begin(), entry.begin() + plan_->key_order_.size());
+    }
+  }
+
+  if (plan_->IsMixedOrder()) {
+    std::vector<std::pair<Tuple, RID>> tuples;
+    for (auto pos : IndexScanExecutor::KeyOrderPermutation(keys, plan_->key_order_)) {
+      tuples.push_back(std::move(tuples_[pos]));
+    }
+    tuples_ = std::move(tuples);
+  }
+}
+
+auto IndexOnlyScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (next_tuple_ == tuples_.size()) {
+    return false;
+  }
+  *tuple = tuples_[next_tuple_].first;
+  *rid = tuples_[next_tuple_].second;
+  next_tuple_++;
+  return true;
+}
+
+}  // namespace bustub
@@ -11,33 +11,212 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "type/value_factory.h"
+
 namespace bustub {
+
+namespace {
+
+/** @return true if the first n columns of lhs and rhs are equal, NULL being equal to NULL */
+auto SamePrefix(const std::vector<Value> &lhs, const std::vector<Value> &rhs, size_t n) -> bool {
+  for (size_t i = 0; i < n; i++) {
+    if (lhs[i].IsNull() || rhs[i].IsNull()) {
+      if (lhs[i].IsNull() != rhs[i].IsNull()) {
+        return false;
+      }
+    } else if (lhs[i].CompareEquals(rhs[i]) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto IsDesc(OrderByType type) -> bool { return type == OrderByType::DESC; }
+
+}  // namespace
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void IndexScanExecutor::Init() {
   index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
   table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
-  tree_ = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get());
-  iter_ = tree_->GetBeginIterator();
+  rids_.clear();
+  next_rid_ = 0;
+  num_read_ = 0;
+  num_emitted_ = 0;
+  index_ = dynamic_cast<BPlusTreeIndexBase *>(index_info_->index_.get());
+  if (index_ == nullptr) {
+    // A hash index only looks up whole keys, the plan bounds all the key columns by the same values.
+    index_info_->index_->ScanKey(Tuple(plan_->lower_bound_, &index_info_->key_schema_), &rids_,
+                                 exec_ctx_->GetTransaction());
+    index_done_ = true;
+    return;
+  }
+  index_done_ = false;
+  // Read the RIDs before emitting anything, so that a parent modifying the index (e.g. an update of the key) does not
+  // invalidate the cursor or see its own entries again. With a limit, only read as many entries as it lets through,
+  // so that the top rows of a large index take a leaf or two.
+  ReadEntries(plan_->limit_.value_or(std::numeric_limits<size_t>::max()));
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   if (index_info_ == nullptr) {
     return false;
   }
-  bool found = false;
-  while (!iter_.IsEnd()) {
-    *rid = (*iter_).second;
-    ++iter_;
-    auto tuple_pair = table_info_->table_->GetTuple(*rid);
-    if (!tuple_pair.first.is_deleted_) {
-      found = true;
+  while (true) {
+    while (next_rid_ < rids_.size()) {
+      *rid = rids_[next_rid_++];
+      auto tuple_pair = table_info_->table_->GetTuple(*rid);
+      if (tuple_pair.first.is_deleted_) {
+        continue;
+      }
+      if (plan_->filter_predicate_ != nullptr) {
+        auto value = plan_->filter_predicate_->Evaluate(&tuple_pair.second, GetOutputSchema());
+        if (value.IsNull() || !value.GetAs<bool>()) {
+          continue;
+        }
+      }
       *tuple = tuple_pair.second;
+      num_emitted_++;
+      return true;
+    }
+    // Deleted tuples must not count towards the limit, so read the entries after them. Only a limit stops the scan
+    // early, and the parent of a limited scan is the limit, which does not modify the index.
+    if (index_done_ || !plan_->limit_.has_value() || num_emitted_ >= *plan_->limit_) {
+      return false;
+    }
+    ReadEntries(*plan_->limit_ - num_emitted_);
+  }
+}
+
+void IndexScanExecutor::ReadEntries(size_t max_rids) {
+  auto cursor =
+      OpenCursor(index_, index_info_->key_schema_, plan_->lower_bound_, plan_->upper_bound_, plan_->IsReverse());
+  std::vector<RID> batch;
+  for (size_t skipped = 0; skipped < num_read_;) {
+    size_t num_skipped = cursor->NextBatch(&batch, std::min<size_t>(INDEX_SCAN_BATCH_SIZE, num_read_ - skipped));
+    if (num_skipped == 0) {
       break;
     }
+    skipped += num_skipped;
+  }
+
+  rids_.clear();
+  next_rid_ = 0;
+  const auto &end_bound = plan_->IsReverse() ? plan_->lower_bound_ : plan_->upper_bound_;
+  if (end_bound.empty() && !plan_->IsMixedOrder()) {
+    while (rids_.size() < max_rids &&
+           cursor->NextBatch(&batch, std::min<size_t>(INDEX_SCAN_BATCH_SIZE, max_rids - rids_.size())) > 0) {
+      rids_.insert(rids_.end(), batch.begin(), batch.end());
+    }
+  } else {
+    // The keys are decoded from the leaves, the tuples are only fetched once they are emitted.
+    std::vector<std::vector<Value>> keys;
+    std::vector<Value> entry;
+    for (; rids_.size() < max_rids && !cursor->IsEnd(); cursor->Next()) {
+      cursor->GetEntry(&entry);
+      if (!end_bound.empty() &&
+          (plan_->IsReverse() ? BeforeLowerBound(entry, end_bound) : PastUpperBound(entry, end_bound))) {
+        index_done_ = true;
+        break;
+      }
+      rids_.push_back(cursor->GetRID());
+      if (plan_->IsMixedOrder()) {
+        keys.emplace_back(entry.begin(), entry.begin() + plan_->key_order_.size());
+      }
+    }
+    if (plan_->IsMixedOrder()) {
+      std::vector<RID> rids;
+      for (auto pos : KeyOrderPermutation(keys, plan_->key_order_)) {
+        rids.push_back(rids_[pos]);
+      }
+      rids_ = std::move(rids);
+    }
+  }
+  num_read_ += rids_.size();
+  index_done_ = index_done_ || cursor->IsEnd();
+}
+
+auto IndexScanExecutor::OpenCursor(BPlusTreeIndexBase *index, const Schema &key_schema,
+                                   const std::vector<Value> &lower_bound, const std::vector<Value> &upper_bound,
+                                   bool reverse) -> std::unique_ptr<BPlusTreeIndexCursor> {
+  if (reverse) {
+    return upper_bound.empty() ? index->ReverseScan() : index->ReverseScan(upper_bound);
+  }
+  if (lower_bound.empty()) {
+    return index->Scan();
+  }
+  // Key columns past the bound are NULL, which sorts before any value.
+  std::vector<Value> values;
+  const auto &key_columns = key_schema.GetColumns();
+  for (size_t i = 0; i < key_columns.size(); i++) {
+    values.push_back(i < lower_bound.size() ? lower_bound[i]
+                                            : ValueFactory::GetNullValueByType(key_columns[i].GetType()));
+  }
+  return index->Scan(Tuple(values, &key_schema));
+}
+
+auto IndexScanExecutor::PastUpperBound(const std::vector<Value> &key, const std::vector<Value> &upper_bound) -> bool {
+  for (size_t i = 0; i < upper_bound.size(); i++) {
+    const Value &value = key[i];
+    const Value &bound = upper_bound[i];
+    if (value.IsNull()) {
+      return false;
+    }
+    if (value.CompareGreaterThan(bound) == CmpBool::CmpTrue) {
+      return true;
+    }
+    if (value.CompareLessThan(bound) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return false;
+}
+
+auto IndexScanExecutor::BeforeLowerBound(const std::vector<Value> &key, const std::vector<Value> &lower_bound)
+    -> bool {
+  for (size_t i = 0; i < lower_bound.size(); i++) {
+    const Value &value = key[i];
+    const Value &bound = lower_bound[i];
+    if (value.IsNull()) {
+      return true;
+    }
+    if (value.CompareLessThan(bound) == CmpBool::CmpTrue) {
+      return true;
+    }
+    if (value.CompareGreaterThan(bound) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return false;
+}
+
+auto IndexScanExecutor::KeyOrderPermutation(const std::vector<std::vector<Value>> &keys,
+                                            const std::vector<OrderByType> &key_order) -> std::vector<size_t> {
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  bool desc = !key_order.empty() && IsDesc(key_order[0]);
+  for (size_t k = 1; k < key_order.size(); k++) {
+    if (IsDesc(key_order[k]) == desc) {
+      continue;
+    }
+    // Reversing the runs that agree on the first k columns turns column k and all the ones after it around.
+    for (size_t begin = 0; begin < order.size();) {
+      size_t end = begin + 1;
+      while (end < order.size() && SamePrefix(keys[order[begin]], keys[order[end]], k)) {
+        end++;
+      }
+      std::reverse(order.begin() + begin, order.begin() + end);
+      begin = end;
+    }
+    desc = !desc;
   }
-  return found;
+  return order;
 }
 
 }  // namespace bustub
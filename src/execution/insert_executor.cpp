@@ -56,8 +56,8 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
     }
     bool flag = true;
     for (auto &index_info : index_info_arr_) {
-      Tuple key =
-          child_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      Tuple key = child_tuple.KeyFromTuple(table_info_->schema_, *index_info->index_->GetEntrySchema(),
+                                           index_info->index_->GetEntryAttrs());
       bool res = index_info->index_->InsertEntry(key, *new_rid, txn);
       if (!res) {
         flag = false;
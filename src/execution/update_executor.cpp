@@ -51,8 +51,8 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
     tuple_meta.is_deleted_ = true;
     table_info_->table_->UpdateTupleMeta(tuple_meta, crid);
     for (auto &index_info : index_info_arr_) {
-      Tuple key =
-          child_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      Tuple key = child_tuple.KeyFromTuple(table_info_->schema_, *index_info->index_->GetEntrySchema(),
+                                           index_info->index_->GetEntryAttrs());
       index_info->index_->DeleteEntry(key, crid, nullptr);
     }
     std::vector<Value> values{};
@@ -66,8 +66,8 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
     }
     bool flag = true;
     for (auto &index_info : index_info_arr_) {
-      Tuple key =
-          updated.KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      Tuple key = updated.KeyFromTuple(table_info_->schema_, *index_info->index_->GetEntrySchema(),
+                                       index_info->index_->GetEntryAttrs());
       bool res = index_info->index_->InsertEntry(key, *new_rid, nullptr);
       if (!res) {
         flag = false;
@@ -12,11 +12,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/frame_arena.h"
 #include "buffer/lru_k_replacer.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
@@ -28,6 +40,43 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The data of all frames lives in one FrameArena, a single page-aligned (and, for large pools, huge page backed)
+ * mapping, while the Page objects only hold the metadata of the frames. Frames can thus be read and written with
+ * O_DIRECT as they are, and creating a pool of any size does not touch its memory.
+ *
+ * The frames of the pool can be partitioned into several independent shards. Every page id maps to exactly one shard
+ * (page_id % num_shards), and each shard has its own latch, page table, free list and replacer, so operations on pages
+ * of different shards never contend with each other. With a single shard the pool behaves like a classic buffer pool.
+ *
+ * Disk I/O is never performed while holding a shard latch. A frame that is being filled from (or written back to) disk
+ * is reserved and marked as "I/O in progress" first; other threads looking for a page mapped to such a frame wait on
+ * the frame's condition variable instead of blocking the whole shard.
+ *
+ * Optionally, a background flusher thread writes dirty frames back ahead of demand. It keeps at least
+ * flush_watermark frames that can be reused without a disk write (free frames plus clean frames at the head of the
+ * eviction order), so that misses on the foreground path rarely have to write a dirty victim first. Dirty frames with
+ * adjacent page ids are written back with a single DiskManager::WritePages call.
+ *
+ * PrefetchPage() starts loading a page without waiting for it, so that sequential scans can keep several reads in
+ * flight. The read completes on a background thread, after which the page sits unpinned in the pool.
+ *
+ * Page ids are handed out by the free-space map of the disk manager. Every shard allocates the lowest free id it owns,
+ * so the ids of pages removed with DeletePage() are reused before the database file grows.
+ *
+ * Hot pages, such as the upper levels of an index, can be swizzled: SwizzlePage() keeps the page pinned in its frame
+ * and points a Swip at the frame, and TryFetchSwizzledRead() follows the swip without taking the shard latch, looking
+ * the page up or touching the replacer. Up to 1/SWIZZLE_BUDGET_DIVISOR of the frames of a shard are swizzled. When a
+ * shard runs out of frames to evict, it unswizzles a swizzled frame that nobody uses, which makes it evictable again.
+ *
+ * With enable_warm_restart set, the pool survives restarts warm: a background thread periodically (and once more when
+ * the pool is destroyed) dumps the ids of the resident pages, hottest first, to a sidecar file of the database file
+ * (test.db -> test.warm). A new pool on the same database loads the hottest of them back into its free frames, with
+ * the reads issued together in page id order, before the first miss has to fault anything in one page at a time.
+ *
+ * Pages can be assigned to named groups, such as "index" for the nodes of every B+ tree, and a group can reserve a
+ * number of frames. As long as a group holds no more frames than it has reserved, its pages are evicted only when no
+ * other page can be (see LRUKReplacer), so a large scan of a cold table does not flush the hot pages of the group.
  */
 class BufferPoolManager {
  public:
@@ -37,9 +86,11 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the LookBack constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_shards the number of independent partitions the frames are split into, must be in [1, pool_size]
+   * @param flush_watermark the number of clean reusable frames the background flusher maintains, 0 = no flusher
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_shards = 1, size_t flush_watermark = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -52,6 +103,75 @@ class BufferPoolManager {
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the number of shards the buffer pool is partitioned into. */
+  auto GetNumShards() -> size_t { return shards_.size(); }
+
+  /** @brief Return the number of dirty victims written back synchronously on the fetch / new page path. */
+  auto GetForegroundFlushCount() -> uint64_t { return foreground_flushes_.load(); }
+
+  /** @brief Return the number of dirty pages written back by the background flusher. */
+  auto GetBackgroundFlushCount() -> uint64_t { return background_flushes_.load(); }
+
+  /** @brief Return the number of pages loaded by PrefetchPage(). */
+  auto GetPrefetchCount() -> uint64_t { return prefetches_.load(); }
+
+  /** @brief Return the number of dirty victims written back to make room for a prefetched page. */
+  auto GetPrefetchFlushCount() -> uint64_t { return prefetch_flushes_.load(); }
+
+  /** @brief Return the number of prefetched pages that were fetched afterwards, before being evicted. */
+  auto GetPrefetchHitCount() -> uint64_t { return prefetch_hits_.load(); }
+
+  /** @brief Return the number of pages that are currently swizzled. */
+  auto GetSwizzledCount() -> size_t;
+
+  /** @brief Return the number of pages unswizzled to make room for other pages. */
+  auto GetUnswizzleCount() -> uint64_t { return unswizzles_.load(); }
+
+  /** @brief Return the number of page reads started by WarmUp(). */
+  auto GetWarmUpCount() -> uint64_t { return warm_up_pages_.load(); }
+
+  /** @brief Return the number of page reads started by WarmUp() that have completed. */
+  auto GetWarmUpLoadedCount() -> uint64_t { return warm_up_loaded_.load(); }
+
+  /**
+   * @brief Return the id of the group called name, creating the group if it does not exist yet. Group 0 is called
+   * "default" and holds every page that is not assigned to another group, group 1 is called "index" and holds the pages
+   * of the B+ trees.
+   *
+   * @param name the name of the group
+   * @return the id of the group
+   * @throws Exception if the pool already has BUFFER_POOL_MAX_GROUPS groups
+   */
+  auto GetGroup(const std::string &name) -> size_t;
+
+  /** @brief Return the id of the group called name, std::nullopt if there is no such group. */
+  auto FindGroup(const std::string &name) -> std::optional<size_t>;
+
+  /**
+   * @brief Reserve frames for the pages of a group. The reservation is split over the shards like the frames are.
+   *
+   * @param group the id of the group
+   * @param num_frames the number of frames the group keeps through any amount of other traffic, 0 for none, at most
+   * the pool size
+   */
+  void SetGroupReservation(size_t group, size_t num_frames);
+
+  /** @brief Return the number of frames reserved for a group. */
+  auto GetGroupReservation(size_t group) -> size_t;
+
+  /** @brief Return the number of frames currently holding pages of a group. */
+  auto GetGroupSize(size_t group) -> size_t;
+
+  /**
+   * @brief Assign a range of page ids, such as an extent of a Segment, to a group. Resident pages of the range move to
+   * the group right away.
+   *
+   * @param first_page_id the first page id of the range
+   * @param num_pages the number of page ids in the range
+   * @param group the id of the group, 0 takes the range back into the default group
+   */
+  void SetPageGroup(page_id_t first_page_id, size_t num_pages, size_t group);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -99,7 +219,7 @@ class BufferPoolManager {
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page, scan accesses are kept from polluting the replacer's hot set
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
@@ -115,11 +235,57 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, pass AccessType::Scan for sequential scans
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Like FetchPageRead, but does not wait for a writer holding the page latch.
+   *
+   * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page
+   * @return a guard holding the read latch, or an empty guard (and the page unpinned) if the latch is held by a writer
+   */
+  auto TryFetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+
+  /**
+   * @brief Swizzle a page the caller has pinned: keep it pinned in its frame on behalf of swip, and point swip at the
+   * frame. Nothing is done if the page is not swizzled yet and its shard has used up its budget of swizzled frames.
+   *
+   * A swizzled page stays swizzled until it is deleted, or unswizzled because its shard has no other frame to evict.
+   *
+   * @param swip the swip to point at the frame, such as one of the parent page (see Page::GetSwip)
+   * @param page_id id of the page to swizzle
+   */
+  void SwizzlePage(Swip *swip, page_id_t page_id);
+
+  /**
+   * @brief Read latch the swizzled page a swip points at, without the shard latch, the page table or the replacer.
+   *
+   * This never waits: if the swip does not point at a swizzled frame holding page_id, or a writer holds the latch of
+   * the page, the caller falls back to FetchPageRead() or FetchPageBasic(). A swizzled page is only unswizzled with its
+   * latch held in write mode, so the read latch alone keeps it in its frame, and the returned guard holds no pin.
+   *
+   * @param swip the swip to follow
+   * @param page_id id of the page the swip should point at
+   * @return a guard holding the read latch, or an empty guard
+   */
+  auto TryFetchSwizzledRead(Swip *swip, page_id_t page_id) -> ReadPageGuard;
+
+  /**
+   * @brief Start loading a page into the buffer pool in the background, without pinning it.
+   *
+   * Nothing is done if the page is already resident (or being loaded), or if fewer than half of the frames of its
+   * shard are free or evictable, so that prefetching never starves regular fetches. A fetch of the page while the read
+   * is in flight waits for it to complete.
+   *
+   * @param page_id id of page to be prefetched
+   * @param access_type type of access to the page, prefetched pages are usually scanned
+   */
+  void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Scan);
 
   /**
    * TODO(P1): Add implementation
@@ -153,7 +319,7 @@ class BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, along with the free-space map of the disk manager.
    */
   void FlushAllPages();
 
@@ -165,50 +331,257 @@ class BufferPoolManager {
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
    * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * free the page on the disk, so that its id can be reused.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
+  /**
+   * @brief Allocate an extent of pages with consecutive ids on disk (see DiskManager::AllocateExtent). None of the
+   * pages is created in the buffer pool, that is up to NewPageWithId().
+   *
+   * @param num_pages the number of pages in the extent
+   * @return the id of the first page of the extent
+   */
+  auto AllocateExtent(size_t num_pages) -> page_id_t { return disk_manager_->AllocateExtent(num_pages); }
+
+  /**
+   * @brief Free every page of an extent on disk. The pages must have been dropped from the buffer pool first.
+   *
+   * @param first_page_id id of the first page of the extent
+   * @param num_pages the number of pages in the extent
+   */
+  void DeallocateExtent(page_id_t first_page_id, size_t num_pages) {
+    disk_manager_->DeallocateExtent(first_page_id, num_pages);
+  }
+
+  /**
+   * @brief Like NewPage(), but for a page id the caller allocated itself, such as a page of an extent. The page is
+   * created in the shard that owns page_id.
+   *
+   * @param page_id an allocated id that is not in use
+   * @return nullptr if every frame of the shard is pinned, otherwise pointer to the new page
+   */
+  auto NewPageWithId(page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Like DeletePage(), but leave the page allocated on disk, so that the caller can hand its id out again.
+   *
+   * @param page_id id of page to be dropped
+   * @return false if the page exists but could not be dropped, true if the page didn't exist or dropping succeeded
+   */
+  auto DropPage(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Write the ids of the resident pages to the warm restart file, hottest first. Within a shard, pages in use
+   * come first, followed by the evictable pages in the reverse of the replacer's eviction order. The lists of the
+   * shards are interleaved.
+   *
+   * @return the number of page ids written, 0 if the disk manager has no database file
+   */
+  auto DumpResidentPages() -> size_t;
+
+  /**
+   * @brief Start loading the pages listed in the warm restart file into the free frames of the pool, without waiting
+   * for them. The hottest pages that fit in the pool are read, in page id order. Pages that are already resident or
+   * have been deleted since the dump are skipped, and no page is evicted for the warm-up.
+   *
+   * A new pool calls this itself when warm restart is enabled.
+   *
+   * @return the number of page reads started
+   */
+  auto WarmUp() -> size_t;
+
  private:
+  /**
+   * A shard owns a contiguous range of frames and every page whose id is congruent to its index modulo the number of
+   * shards. Frame ids used inside a shard (page table, free list, replacer) are relative to the shard's own frames.
+   */
+  struct Shard {
+    Shard(size_t index, size_t num_shards, Page *pages, size_t size, size_t replacer_k);
+
+    /** Index of this shard, pages allocated by this shard have ids index_, index_ + num_shards_, ... */
+    const size_t index_;
+    /** Total number of shards, which is the stride between page ids allocated by this shard. */
+    const size_t num_shards_;
+    /** Number of frames owned by this shard. */
+    const size_t size_;
+    /** The frames owned by this shard, a slice of the pool-wide pages_ array. */
+    Page *pages_;
+    /** Page table for keeping track of the pages resident in this shard. */
+    std::unordered_map<page_id_t, frame_id_t> page_table_;
+    /** Replacer to find unpinned frames of this shard for replacement. */
+    std::unique_ptr<LRUKReplacer> replacer_;
+    /** List of free frames of this shard that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** True for frames whose data is being read from or written back to disk without holding the latch. */
+    std::vector<bool> io_in_progress_;
+    /** Signalled when the I/O on the corresponding frame completes. Waited on with latch_. */
+    std::vector<std::condition_variable> io_done_;
+    /** True for frames loaded by PrefetchPage() and not fetched since. */
+    std::vector<bool> prefetched_;
+    /** Number of clean reusable frames the background flusher keeps in this shard. */
+    size_t flush_watermark_{0};
+    /** Number of swizzled frames, each of them holds one pin on behalf of its swips. */
+    size_t num_swizzled_{0};
+    /** Protects every member above except the immutable ones. */
+    std::mutex latch_;
+  };
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
 
-  /** Array of buffer pool pages. */
+  /** The memory of the frames, one aligned mapping. */
+  FrameArena arena_;
+  /** Array of buffer pool pages, the metadata of the frames. pages_[i] holds the data of frame i of the arena. */
   Page *pages_;
-  /** Pointer to the disk manager. */
+  /** Pointer to the disk manager, which also keeps track of the allocated pages. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /** The independent partitions of the pool. */
+  std::vector<std::unique_ptr<Shard>> shards_;
+  /** Round-robin cursor used to spread NewPage() calls over the shards. */
+  std::atomic<size_t> next_shard_{0};
+  /** Number of dirty victims written back on the foreground path. */
+  std::atomic<uint64_t> foreground_flushes_{0};
+  /** Number of pages written back by the background flusher. */
+  std::atomic<uint64_t> background_flushes_{0};
+  /** Number of dirty victims written back by prefetches, which no foreground caller waits for. */
+  std::atomic<uint64_t> prefetch_flushes_{0};
+  /** The background flusher thread, not started if flush_watermark is 0. */
+  std::thread flusher_;
+  /** Protects stop_flusher_, flusher_cv_ wakes the flusher up early. */
+  std::mutex flusher_latch_;
+  std::condition_variable flusher_cv_;
+  bool stop_flusher_{false};
+
+  /** A prefetch whose I/O has been issued but not completed yet. */
+  struct Prefetch {
+    Shard *shard_;
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    /** The page evicted for the prefetch, which is written back first if it is dirty. */
+    page_id_t old_page_id_;
+    bool write_back_;
+    /** The write of the old page if write_back_, otherwise the read of the new page. */
+    std::future<bool> io_;
+    /** True if the page is loaded by WarmUp() rather than PrefetchPage(). */
+    bool warm_up_{false};
+  };
+  std::atomic<uint64_t> unswizzles_{0};
+  std::atomic<uint64_t> prefetches_{0};
+  std::atomic<uint64_t> prefetch_hits_{0};
+  /** Completes prefetches in issue order, started by the first PrefetchPage() call. */
+  std::thread prefetcher_;
+  /** Protects prefetch_queue_ and stop_prefetcher_. */
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  std::deque<Prefetch> prefetch_queue_;
+  bool stop_prefetcher_{false};
+
+  /** The warm restart file, empty if warm restart is disabled or the disk manager has no database file. */
+  std::string warm_name_;
+  std::atomic<uint64_t> warm_up_pages_{0};
+  std::atomic<uint64_t> warm_up_loaded_{0};
+  /** Dumps the resident pages every warm_restart_dump_interval, started along with the pool if warm_name_ is set. */
+  std::thread dumper_;
+  /** Protects stop_dumper_, dumper_cv_ wakes the dumper up to stop. */
+  std::mutex dumper_latch_;
+  std::condition_variable dumper_cv_;
+  bool stop_dumper_{false};
+
+  /** Names of the groups, indexed by group id. Protected by group_latch_, like the members below. */
+  std::vector<std::string> group_names_{"default", "index"};
+  std::vector<size_t> group_reservations_{0, 0};
+  /** Ranges of page ids assigned to groups other than the default one, first page id -> (end page id, group). */
+  std::map<page_id_t, std::pair<page_id_t, size_t>> page_groups_;
+  std::shared_mutex group_latch_;
+
+  /** @return the shard responsible for page_id */
+  auto ShardOf(page_id_t page_id) -> Shard & { return *shards_[static_cast<size_t>(page_id) % shards_.size()]; }
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, reusing the lowest free page id of the shard. Caller should acquire the shard
+   * latch before calling this function.
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(Shard &shard) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, so that its id is handed out again by AllocatePage().
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+  /**
+   * @brief Make room in a shard that has no free or evictable frame by unswizzling a swizzled frame that is neither
+   * pinned nor latched by anyone else. Caller must hold the shard latch.
+   * @return true if a frame became evictable
+   */
+  auto UnswizzleFrame(Shard &shard) -> bool;
+
+  /** @return the group page_id is assigned to */
+  auto GroupOf(page_id_t page_id) -> size_t;
+
+  /** @brief Take a frame from the free list or evict one. Caller must hold the shard latch and ensure one exists. */
+  auto GetFreeFrame(Shard &shard) -> frame_id_t;
+
+  /**
+   * @brief Find the frame holding page_id, waiting for any in-flight I/O on that frame to finish first.
+   * @param lock the held shard latch, it is temporarily released while waiting
+   * @return the frame holding the page, or -1 if the page is not resident
+   */
+  auto FindFrame(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id) -> frame_id_t;
+
+  /**
+   * @brief Reserve a frame for page_id and pin it. The shard latch is released while the previous content of the
+   * frame is written back and while the page is read from disk (if read_page is true). The caller must ensure that a
+   * free or evictable frame exists.
+   * @param lock the held shard latch, it is held again when this function returns
+   * @return the pinned page holding page_id
+   */
+  auto LoadFrame(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id, bool read_page,
+                 AccessType access_type = AccessType::Unknown) -> Page *;
+
+  /** @brief NewPage() restricted to one shard. Returns nullptr if every frame of the shard is pinned. */
+  auto NewPageInShard(Shard &shard, page_id_t *page_id) -> Page *;
+
+  /**
+   * @brief Put a new, zeroed page with an allocated id into a frame of its shard, and pin it.
+   * @param lock the held shard latch, it is held again when this function returns
+   * @return the pinned page, or nullptr if every frame of the shard is pinned
+   */
+  auto CreatePage(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Start writing pages back to disk, with one I/O per run of adjacent page ids.
+   * @param pages (page id, data) of the pages to write, sorted by page id on return
+   * @return the futures of the writes
+   */
+  auto WriteBack(std::vector<std::pair<page_id_t, const char *>> *pages) -> std::vector<std::future<bool>>;
+
+  /** @brief Main loop of the background flusher, runs BackgroundFlush() until the buffer pool is destroyed. */
+  void FlusherLoop();
+
+  /** @brief Write back the dirty frames among the next victims of every shard that is short of clean frames. */
+  void BackgroundFlush();
+
+  /**
+   * @brief Reserve a frame for page_id like LoadFrame() does, but leave it unpinned, and hand the I/O over to the
+   * prefetcher thread. The caller must ensure that page_id is not resident and that a free or evictable frame exists.
+   * @param lock the held shard latch, it is released when this function returns
+   * @param warm_up whether the page is loaded by WarmUp()
+   */
+  void StartPrefetch(Shard &shard, std::unique_lock<std::mutex> &lock, page_id_t page_id, AccessType access_type,
+                     bool warm_up);
 
-  auto GetFreeFrame() -> frame_id_t;
+  /** @brief Main loop of the prefetcher thread, waits for prefetch I/O and makes the loaded pages available. */
+  void PrefetchLoop();
 
-  // TODO(student): You may add additional private members and helper functions
+  /** @brief Main loop of the dumper thread, runs DumpResidentPages() until the buffer pool is destroyed. */
+  void DumperLoop();
 };
 }  // namespace bustub
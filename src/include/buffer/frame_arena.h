@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory the frames of a buffer pool live in: one anonymous mapping, carved into BUSTUB_PAGE_SIZE
+ * frames that are aligned to BUSTUB_PAGE_SIZE, so that they can be handed to O_DIRECT I/O without a bounce buffer.
+ *
+ * The mapping is zero-filled by the kernel on first touch, so creating even a very large arena costs a single mmap.
+ * Arenas of at least HUGE_PAGE_SIZE are aligned to it and backed by huge pages when possible: explicit ones
+ * (MAP_HUGETLB) if the system has reserved enough of them, otherwise transparent huge pages (MADV_HUGEPAGE). Either
+ * way, a scan over the pool touches one TLB entry per huge page instead of one per frame.
+ *
+ * In builds with AddressSanitizer, every frame is followed by a poisoned gap of the same size, so that overflowing a
+ * page is still reported instead of silently spilling into the next frame.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the memory of num_frames frames.
+   * @param num_frames the number of frames
+   * @param huge_pages whether to try to back the arena with huge pages
+   */
+  explicit FrameArena(size_t num_frames, bool huge_pages = BUFFER_POOL_HUGE_PAGES);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the memory of frame frame_index */
+  auto GetFrame(size_t frame_index) const -> char * { return base_ + frame_index * stride_; }
+
+  /** @return the number of frames in the arena */
+  auto GetNumFrames() const -> size_t { return num_frames_; }
+
+  /** @return true if the arena is mapped with explicit huge pages (MAP_HUGETLB) */
+  auto IsHugeTLB() const -> bool { return huge_tlb_; }
+
+ private:
+  /** Number of frames. */
+  const size_t num_frames_;
+  /** Distance between the starts of two frames, BUSTUB_PAGE_SIZE unless there are guard gaps. */
+  size_t stride_{BUSTUB_PAGE_SIZE};
+  /** Start of the mapping, frame 0 starts here. */
+  char *base_{nullptr};
+  /** Length of the mapping. */
+  size_t length_{0};
+  /** True if the mapping uses explicit huge pages. */
+  bool huge_tlb_{false};
+};
+
+}  // namespace bustub
@@ -13,9 +13,9 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -28,26 +28,49 @@ enum class AccessType { Unknown = 0, Get, Scan };
 class LRUKNode {
  public:
   LRUKNode() = default;
-  LRUKNode(size_t k, frame_id_t fid) : k_(k), fid_(fid) {}
+  explicit LRUKNode(size_t k) : history_(k) {}
   ~LRUKNode() = default;
+
+  /** Record an access, overwriting the oldest remembered timestamp once k of them are remembered. */
   void Access(size_t time_stamp) {
-    if (history_.size() == k_) {
-      history_.pop_front();
+    if (size_ == history_.size()) {
+      history_[head_] = time_stamp;
+      head_ = (head_ + 1) % history_.size();
+    } else {
+      history_[(head_ + size_) % history_.size()] = time_stamp;
+      ++size_;
     }
-    history_.emplace_back(time_stamp);
   }
-  auto GetEvictable() -> bool { return is_evictable_; }
+  /** Forget the whole access history. */
+  void Reset() {
+    head_ = 0;
+    size_ = 0;
+    scan_only_ = true;
+  }
+  auto IsTracked() const -> bool { return size_ > 0; }
+  auto HasKAccesses() const -> bool { return size_ == history_.size(); }
+  /**
+   * @return the oldest remembered timestamp: the k-th most recent access once the frame has k accesses, otherwise its
+   * first access. In both cases a smaller value means a larger backward k-distance.
+   */
+  auto GetOldest() const -> size_t { return history_[head_]; }
+  auto GetEvictable() const -> bool { return is_evictable_; }
   void SetEvictable(bool is_evictable) { is_evictable_ = is_evictable; }
-  auto GetBackwardKDis() -> size_t { return history_.size() == k_ ? history_.front() : 0; }
-  auto GetLeastRecent() -> size_t { return history_.front(); }
+  auto IsScanOnly() const -> bool { return scan_only_; }
+  void SetScanOnly(bool scan_only) { scan_only_ = scan_only; }
+  auto GetGroup() const -> size_t { return group_; }
+  void SetGroup(size_t group) { group_ = group; }
 
  private:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-  std::list<size_t> history_;
-  size_t k_;
-  [[maybe_unused]] frame_id_t fid_;
+  /** Ring buffer of the last k timestamps of this frame, the least recent one is stored at head_. */
+  std::vector<size_t> history_;
+  size_t head_{0};
+  size_t size_{0};
   bool is_evictable_{false};
+  /** True while every recorded access to the frame was a scan. */
+  bool scan_only_{true};
+  /** The group the page in the frame belongs to. */
+  size_t group_{0};
 };
 
 /**
@@ -60,6 +83,18 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * To resist sequential flooding, frames that were only ever accessed by scans (AccessType::Scan) are kept apart
+ * and evicted before any other frame, in LRU order. A scan access to a frame that already has non-scan accesses is
+ * ignored, so a scan never makes a page look hotter than it is.
+ *
+ * Every frame belongs to one of BUFFER_POOL_MAX_GROUPS groups, group 0 unless SetGroup() says otherwise, and a group
+ * can reserve a number of frames. As long as a group holds no more frames than it has reserved, its frames are only
+ * evicted once no frame of a group outside its reservation is evictable. Pages of a group with a reservation, such as
+ * index pages, thus survive scans that flood the pool, without ever making the pool run out of victims.
+ *
+ * Evictable frames are kept in ordered sets keyed by their oldest remembered access, one set per kind of frame and
+ * group, so every operation is O(log n) in the number of frames.
  */
 class LRUKReplacer {
  public:
@@ -85,7 +120,8 @@ class LRUKReplacer {
    * TODO(P1): Add implementation
    *
    * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
-   * that are marked as 'evictable' are candidates for eviction.
+   * that are marked as 'evictable' are candidates for eviction. Frames only accessed by scans
+   * are evicted first.
    *
    * A frame with less than k historical references is given +inf as its backward k-distance.
    * If multiple frames have inf backward k-distance, then evict frame with earliest timestamp
@@ -109,8 +145,8 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received. Scan accesses do not count towards the
+   * history of frames that have been accessed otherwise.
    */
   void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
 
@@ -161,10 +197,74 @@ class LRUKReplacer {
    */
   auto Size() -> size_t;
 
+  /**
+   * @brief Return up to n evictable frames in the order Evict would pick them, without evicting them.
+   *
+   * @param n maximum number of frames to return
+   * @return the next victims, first victim first
+   */
+  auto PeekVictims(size_t n) -> std::vector<frame_id_t>;
+
+  /**
+   * @brief Move a frame to another group. The frame keeps its access history.
+   *
+   * @param frame_id id of the frame
+   * @param group the group of the page in the frame, less than BUFFER_POOL_MAX_GROUPS
+   */
+  void SetGroup(frame_id_t frame_id, size_t group);
+
+  /**
+   * @brief Reserve frames for a group, 0 removes the reservation.
+   *
+   * @param group the group
+   * @param num_frames the number of frames of the group that are only evicted as a last resort
+   */
+  void SetReservation(size_t group, size_t num_frames);
+
+  /** @return the number of frames the group holds, evictable or not */
+  auto GetGroupSize(size_t group) -> size_t;
+
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;
+  using FrameSet = std::set<std::pair<size_t, frame_id_t>>;
+
+  /** The evictable frames of a group, and how many frames the group holds and has reserved. */
+  struct Group {
+    /** Evictable frames only accessed by scans, keyed by oldest remembered access. */
+    FrameSet scan_frames_;
+    /** Evictable frames with less than k accesses (+inf backward k-distance), keyed by first access. */
+    FrameSet inf_frames_;
+    /** Evictable frames with k accesses, keyed by their k-th most recent access. */
+    FrameSet k_frames_;
+    /** Number of frames of the group with an access history, evictable or not. */
+    size_t num_frames_{0};
+    size_t reserved_{0};
+  };
+
+  /** @return the set the evictable frame belongs to, according to its current history. */
+  auto SetOf(const LRUKNode &node) -> FrameSet &;
+
+  /** Insert into / erase from the eviction sets. Caller must hold latch_ and the frame must be evictable. */
+  void Link(frame_id_t frame_id);
+  void Unlink(frame_id_t frame_id);
+
+  /** Drop the history of a frame that is no longer evictable. Caller must hold latch_. */
+  void Forget(frame_id_t frame_id);
+
+  /** @return true if the frames of group are only evicted as a last resort */
+  static auto IsReserved(const Group &group) -> bool {
+    return group.reserved_ > 0 && group.num_frames_ <= group.reserved_;
+  }
+
+  /** PeekVictims() into victims, without taking latch_. */
+  void CollectVictims(size_t n, std::vector<frame_id_t> *victims);
+
+  /** Access history of every frame, indexed by frame id. */
+  std::vector<LRUKNode> node_store_;
+  std::vector<Group> groups_;
+  /** Position in and end of one set of frames of every group CollectVictims() merges, reused across calls. */
+  std::vector<std::pair<FrameSet::const_iterator, FrameSet::const_iterator>> cursors_;
+  /** The victim picked by Evict(), reused across calls. */
+  std::vector<frame_id_t> victims_;
   size_t current_timestamp_{0};
   size_t curr_size_{0};
   size_t replacer_size_;
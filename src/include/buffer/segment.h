@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// segment.h
+//
+// Identification: src/include/buffer/segment.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * Segment is the set of pages of one table heap or index. Instead of taking page ids one at a time from the global
+ * allocation order, where they interleave with the pages of every other object, a segment takes whole extents of
+ * extent_size pages with consecutive ids from the disk manager and hands their pages out in order. Pages created one
+ * after the other, such as the page chain of a table heap or the leaves of a bulk load, are then adjacent on disk, so
+ * that scans read (and the buffer pool writes back) long sequential runs.
+ *
+ * Deleted pages stay in the segment and are handed out again before the next unused page. Dropping the segment frees
+ * all its extents at once.
+ *
+ * The extents of a segment can be assigned to a group of the buffer pool (see BufferPoolManager::GetGroup), which then
+ * holds all its pages.
+ *
+ * The extents of a segment are not persisted, like the rest of the catalog.
+ */
+class Segment {
+ public:
+  /**
+   * @brief Create an empty segment, its first extent is allocated with its first page.
+   * @param bpm the buffer pool manager the pages are created in
+   * @param extent_size the number of pages in an extent
+   * @param group the buffer pool group the pages of the segment belong to
+   */
+  explicit Segment(BufferPoolManager *bpm, size_t extent_size = SEGMENT_EXTENT_SIZE, size_t group = 0);
+
+  DISALLOW_COPY_AND_MOVE(Segment);
+
+  /**
+   * @brief Create a new page in the buffer pool, with the lowest deleted page id of the segment or else the next unused
+   * page id of its last extent. A new extent is allocated once the last one is used up.
+   * @param[out] page_id id of the created page, INVALID_PAGE_ID if no page could be created
+   * @return nullptr if every frame the page could go to is pinned, otherwise pointer to the new page
+   */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
+  /** @brief PageGuard wrapper for NewPage */
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+
+  /**
+   * @brief Delete a page of the segment from the buffer pool. Its id stays allocated to the segment for reuse.
+   * @param page_id id of the page to delete
+   * @return false if the page is pinned and could not be deleted, true otherwise
+   */
+  auto DeletePage(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Drop every page of the segment from the buffer pool and free all its extents on disk. None of the pages may
+   * be pinned. The segment is empty afterwards.
+   */
+  void Drop();
+
+  /** @return the ids of the first pages of the extents, in allocation order */
+  auto GetExtents() -> std::vector<page_id_t>;
+
+  /** @return the number of pages in an extent */
+  auto GetExtentSize() const -> size_t { return extent_size_; }
+
+  /** @return the number of pages currently in use */
+  auto GetNumPages() -> size_t;
+
+  /**
+   * @brief Move the pages of the segment, the resident ones as well as the ones created later, to a buffer pool group.
+   * @param group the id of the group, 0 for the default group
+   */
+  void SetGroup(size_t group);
+
+  /** @return the buffer pool group the pages of the segment belong to */
+  auto GetGroup() -> size_t;
+
+ private:
+  /** @return the page id NewPage() tries next, taken out of the segment. Caller must hold latch_. */
+  auto TakePageId() -> page_id_t;
+
+  BufferPoolManager *bpm_;
+  const size_t extent_size_;
+
+  std::mutex latch_;
+  /** buffer pool group of the pages */
+  size_t group_;
+  /** first page ids of the extents, in allocation order */
+  std::vector<page_id_t> extents_;
+  /** offset of the next unused page in the last extent */
+  size_t next_offset_{0};
+  /** deleted pages, handed out again lowest first */
+  std::set<page_id_t> free_pages_;
+};
+
+}  // namespace bustub
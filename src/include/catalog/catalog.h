@@ -20,6 +20,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
@@ -35,6 +36,14 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The kinds of index the catalog can build. */
+enum class IndexType {
+  /** A B+ tree, for lookups and ordered range scans; the default */
+  BPlusTreeIndex,
+  /** An extendible hash table, for lookups of whole keys only */
+  HashTableIndex,
+};
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -70,15 +79,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param index_type The kind of index
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        index_type_{index_type} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +102,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The kind of index */
+  const IndexType index_type_;
 };
 
 /**
@@ -198,12 +211,17 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param is_unique Whether a key maps to a single tuple, or to any number of them
+   * @param include_attrs Attributes stored in the index entries after the key
+   * @param index_type The kind of index to build
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool is_unique = true,
+                   const std::vector<uint32_t> &include_attrs = {},
+                   IndexType index_type = IndexType::BPlusTreeIndex) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -220,29 +238,48 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
-
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique, include_attrs);
 
-    // Populate the index with all tuples in table heap
+    // Construct the index, take ownership of metadata, and populate it with all tuples in table heap
     auto *table_meta = GetTable(table_name);
-    for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
-      auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::HashTableIndex) {
+      auto hash_index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(
+          std::move(meta), bpm_, hash_function);
+      for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+        auto [meta, tuple] = iter.GetTuple();
+        // Pairs that do not fit their bucket go to overflow pages, so only a duplicate key of a unique index fails.
+        if (!meta.is_deleted_ &&
+            !hash_index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn)) {
+          throw Exception("cannot create unique index " + index_name + " on duplicate keys");
+        }
+      }
+      index = std::move(hash_index);
+    } else {
+      // a B+ tree loads the sorted keys bottom-up
+      auto tree_index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      const auto *entry_schema = tree_index->GetEntrySchema();
+      const auto &entry_attrs = tree_index->GetEntryAttrs();
+      std::vector<std::pair<KeyType, ValueType>> entries;
+      for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+        auto [meta, tuple] = iter.GetTuple();
+        if (meta.is_deleted_) {
+          continue;
+        }
+        KeyType key;
+        key.SetFromKey(tuple.KeyFromTuple(schema, *entry_schema, entry_attrs), *entry_schema);
+        entries.emplace_back(key, tuple.GetRid());
+      }
+      tree_index->BulkLoad(&entries);
+      index = std::move(tree_index);
     }
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, index_type);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -252,6 +289,58 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Create a new index whose key type and comparator are chosen from the key schema:
+   * integer keys that fit in 64 bits are packed into one integer, INT/BIGINT/VARCHAR keys are normalized so that
+   * they compare with memcmp, and other keys fall back to GenericKey, which compares column by column. A covering
+   * index keeps its entries as GenericKey, whose comparator can look at the key columns alone. A hash index hashes
+   * the same key types, and cannot be covering.
+   * @param txn The transaction in which the table is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @param is_unique Whether a key maps to a single tuple, or to any number of them
+   * @param include_attrs Attributes stored in the index entries after the key, for scans to read without the table
+   * @param index_type The kind of index to build
+   * @return A (non-owning) pointer to the metadata of the new index, nullptr if no key type can hold the key
+   */
+  auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
+                   const Schema &key_schema, const std::vector<uint32_t> &key_attrs, bool is_unique = true,
+                   const std::vector<uint32_t> &include_attrs = {},
+                   IndexType index_type = IndexType::BPlusTreeIndex) -> IndexInfo * {
+    if (!include_attrs.empty()) {
+      if (index_type != IndexType::BPlusTreeIndex) {
+        return NULL_INDEX_INFO;
+      }
+      std::vector<uint32_t> entry_attrs = key_attrs;
+      entry_attrs.insert(entry_attrs.end(), include_attrs.begin(), include_attrs.end());
+      auto entry_schema = Schema::CopySchema(&schema, entry_attrs);
+      // a GenericKey holds the tuple, VARCHAR characters, their terminator and length included
+      size_t key_size = entry_schema.GetLength();
+      for (const auto &col : entry_schema.GetColumns()) {
+        if (!col.IsInlined()) {
+          key_size += sizeof(uint32_t) + col.GetVariableLength() + 1;
+        }
+      }
+      return CreateIndexWithKeySize<GenericKey, GenericComparator>(txn, index_name, table_name, schema, key_schema,
+                                                                   key_attrs, key_size, is_unique, include_attrs);
+    }
+    if (PackedIntegerKey::CanPack(key_schema)) {
+      return CreateIndex<PackedIntegerKey, RID, PackedIntegerComparator>(
+          txn, index_name, table_name, schema, key_schema, key_attrs, sizeof(PackedIntegerKey),
+          HashFunction<PackedIntegerKey>{}, is_unique, {}, index_type);
+    }
+    if (size_t key_size = NormalizedKeySize(key_schema); key_size != 0) {
+      return CreateIndexWithKeySize<NormalizedKey, NormalizedComparator>(
+          txn, index_name, table_name, schema, key_schema, key_attrs, key_size, is_unique, {}, index_type);
+    }
+    return CreateIndexWithKeySize<GenericKey, GenericComparator>(txn, index_name, table_name, schema, key_schema,
+                                                                 key_attrs, key_schema.GetLength(), is_unique, {},
+                                                                 index_type);
+  }
+
   /**
    * Get the index `index_name` for table `table_name`.
    * @param index_name The name of the index for which to query
@@ -300,7 +389,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -344,6 +433,35 @@ class Catalog {
   }
 
  private:
+  /** Create an index with the smallest instantiation of KeyType and KeyComparator that holds key_size bytes. */
+  template <template <size_t> class KeyType, template <size_t> class KeyComparator>
+  auto CreateIndexWithKeySize(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                              const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                              size_t key_size, bool is_unique, const std::vector<uint32_t> &include_attrs = {},
+                              IndexType index_type = IndexType::BPlusTreeIndex) -> IndexInfo * {
+    if (key_size <= 8) {
+      return CreateIndex<KeyType<8>, RID, KeyComparator<8>>(txn, index_name, table_name, schema, key_schema, key_attrs,
+                                                            8, HashFunction<KeyType<8>>{}, is_unique, include_attrs,
+                                                            index_type);
+    }
+    if (key_size <= 16) {
+      return CreateIndex<KeyType<16>, RID, KeyComparator<16>>(txn, index_name, table_name, schema, key_schema,
+                                                              key_attrs, 16, HashFunction<KeyType<16>>{}, is_unique,
+                                                              include_attrs, index_type);
+    }
+    if (key_size <= 32) {
+      return CreateIndex<KeyType<32>, RID, KeyComparator<32>>(txn, index_name, table_name, schema, key_schema,
+                                                              key_attrs, 32, HashFunction<KeyType<32>>{}, is_unique,
+                                                              include_attrs, index_type);
+    }
+    if (key_size <= 64) {
+      return CreateIndex<KeyType<64>, RID, KeyComparator<64>>(txn, index_name, table_name, schema, key_schema,
+                                                              key_attrs, 64, HashFunction<KeyType<64>>{}, is_unique,
+                                                              include_attrs, index_type);
+    }
+    return NULL_INDEX_INFO;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
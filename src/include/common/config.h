@@ -21,6 +21,15 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** The buffer pool background flusher checks the free-frame reserve every BACKGROUND_FLUSH_INTERVAL milliseconds. */
+extern std::chrono::milliseconds background_flush_interval;
+
+/** True if buffer pools should dump their hot set while running and load it back when they start. */
+extern std::atomic<bool> enable_warm_restart;
+
+/** A buffer pool with warm restart enabled dumps the ids of its resident pages every WARM_RESTART_DUMP_INTERVAL. */
+extern std::chrono::milliseconds warm_restart_dump_interval;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
@@ -35,7 +44,17 @@ static constexpr int BUSTUB_PAGE_SIZE = 4096;
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
-static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_K = 10;        // lookback window for lru-k replacer
+static constexpr int DISK_SCHEDULER_WORKERS = 4;  // number of I/O threads of the disk scheduler thread pool
+static constexpr int TABLE_HEAP_READ_AHEAD = 8;   // number of pages prefetched ahead of a sequential table scan
+static constexpr int SWIZZLE_BUDGET_DIVISOR = 4;  // at most 1/N of the frames of a buffer pool shard are swizzled
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;  // back the buffer pool frames with huge pages when possible
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;      // size of a huge page in byte
+static constexpr int INDEX_SCAN_BATCH_SIZE = 256;  // number of index entries an index scan copies out per call
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;  // how full a bulk loaded B+ tree packs its nodes
+static constexpr size_t BULK_LOAD_SORT_RUN = 65536;   // minimum number of keys a bulk load sorts on one thread
+static constexpr size_t SEGMENT_EXTENT_SIZE = 64;     // number of pages a table heap or index allocates at once
+static constexpr size_t BUFFER_POOL_MAX_GROUPS = 8;   // number of groups the frames of a buffer pool can be split into
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
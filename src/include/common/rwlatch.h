@@ -34,11 +34,23 @@ class ReaderWriterLatch {
    */
   void WUnlock() { mutex_.unlock(); }
 
+  /**
+   * Try to acquire a write latch without blocking.
+   * @return true if the latch was acquired
+   */
+  auto TryWLock() -> bool { return mutex_.try_lock(); }
+
   /**
    * Acquire a read latch.
    */
   void RLock() { mutex_.lock_shared(); }
 
+  /**
+   * Try to acquire a read latch without blocking.
+   * @return true if the latch was acquired
+   */
+  auto TryRLock() -> bool { return mutex_.try_lock_shared(); }
+
   /**
    * Release a read latch.
    */
@@ -30,6 +30,19 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Lookups, inserts and removes that fit their bucket hold the table latch in
+ * read mode and latch the bucket page, so they only wait for each other on the
+ * same bucket. A full bucket is split, and an emptied bucket merged into its
+ * split image, with the table latch in write mode, which also protects the
+ * directory page.
+ *
+ * A full bucket is not split when no split could separate its pairs from the
+ * new one, because they all share the bucket a full directory of
+ * DIRECTORY_ARRAY_SIZE buckets would give them, as many equal keys do. The
+ * pair goes to an overflow page chained to the bucket instead. The overflow
+ * pages are only reached through their bucket, so the bucket page latch
+ * covers them as well.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -40,9 +53,11 @@ class DiskExtendibleHashTable {
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
    * @param hash_fn the hash function
+   * @param is_unique whether a key maps to a single value
    */
   explicit DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                   const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+                                   const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                                   bool is_unique = false);
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -50,7 +65,8 @@ class DiskExtendibleHashTable {
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
-   * @return true if insert succeeded, false otherwise
+   * @return true if insert succeeded, false if the pair is already there, the key is already there in a unique
+   * table, or the bucket of the key is full and the directory cannot grow any more
    */
   auto Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
@@ -161,6 +177,50 @@ class DiskExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * @return true if the bucket or one of its overflow pages already holds the pair, or the key in a unique table
+   */
+  auto IsDuplicate(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Collects the values of the key from the bucket and its overflow pages.
+   *
+   * @return true if at least one key matched
+   */
+  auto GetChainValue(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Inserts a pair that is not a duplicate into the first page of the bucket and its overflow pages with room.
+   *
+   * @return false if all of them are full
+   */
+  auto InsertIntoChain(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Removes the pair from the bucket or one of its overflow pages, deleting the overflow page if it runs empty.
+   *
+   * @return true if removed, false if not found
+   */
+  auto RemoveFromChain(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Links a new overflow page holding the pair to the bucket. Requires the table latch in write mode.
+   */
+  void AppendOverflowPage(HASH_TABLE_BUCKET_TYPE *bucket, const KeyType &key, const ValueType &value);
+
+  /**
+   * Collects the pairs of the bucket and its overflow pages, and the page ids of the overflow pages.
+   */
+  void CollectChain(HASH_TABLE_BUCKET_TYPE *bucket, std::vector<MappingType> *pairs,
+                    std::vector<page_id_t> *overflow_page_ids);
+
+  /**
+   * @return true if neither the bucket nor any overflow page holds a pair
+   */
+  static auto IsChainEmpty(HASH_TABLE_BUCKET_TYPE *bucket) -> bool {
+    return bucket->IsEmpty() && bucket->GetNextPageId() == INVALID_PAGE_ID;
+  }
+
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
@@ -169,6 +229,7 @@ class DiskExtendibleHashTable {
   // Readers includes inserts and removes, writers are splits and merges
   ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
+  bool is_unique_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -29,7 +30,21 @@ namespace bustub {
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table dynamically grows once full.
+ * table dynamically grows once three quarters of its slots are occupied,
+ * tombstones included. It doubles if the entries take at least half of it, and
+ * is otherwise rebuilt at the same size, which drops the tombstones.
+ *
+ * Growing is incremental: a resize only allocates the blocks of the new table
+ * and makes it the one inserts go to. The entries of the old table
+ * move over a few blocks at a time, as part of later inserts, and until they
+ * all have, lookups and removes consult both tables. Moving an entry leaves a
+ * tombstone in the old table, so its probe sequences stay intact.
+ *
+ * Inserts, removes and lookups hold the table latch in read mode and latch one
+ * block page at a time. A slot is never reused within a table, inserts only
+ * claim the first slot that was never occupied, so an insert that scans the
+ * probe sequence in order sees every pair a concurrent insert could add before
+ * it. Starting a resize and moving blocks hold the table latch in write mode.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -73,30 +88,82 @@ class LinearProbeHashTable {
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Starts growing the table to at least twice the initial size provided. The
+   * entries move over to the new blocks incrementally, see MigrateBlocks.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return current size of the hash table, in slots
    */
   auto GetSize() -> size_t;
 
+  /** @return true while entries of a previous, smaller table are still waiting to be moved */
+  auto IsMigrating() -> bool;
+
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
+  /** The number of old blocks an insert moves to the new table while a resize is in progress. */
+  static constexpr size_t MIGRATE_BLOCKS_PER_INSERT = 1;
+
+  /**
+   * Allocate a table with the blocks for at least num_slots slots, as many as a header page allows.
+   * @param[out] size the number of slots of the table
+   * @return the header page of the table
+   */
+  auto CreateTable(size_t num_slots, size_t *size) -> page_id_t;
   void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
+  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
+
+  /** Collect the values of key in one of the tables. */
+  auto GetValueFrom(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Insert a pair into the current table, into the first slot of its probe sequence that was never occupied.
+   * @param max_occupied the number of occupied slots, tombstones included, past which the table is full
+   * @param[out] full set if the pair was not inserted because the table is full
+   * @return true if inserted, false if the pair is a duplicate or the table is full
+   */
+  auto InsertInto(const KeyType &key, const ValueType &value, size_t max_occupied, bool *full) -> bool;
+
+  /** @return true if the pair was in the table and is now a tombstone */
+  auto RemoveFrom(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool;
+
+  /** Move a pair of the old table into the new one, which always has room for it. Holds the table latch. */
+  void ResizeInsert(const KeyType &key, const ValueType &value);
+
+  /**
+   * Replace the current table by a new one, finishing any migration first. Holds the table latch.
+   * @param num_slots the size of the new table, at least that of the current one
+   * @return false if the table has to grow but cannot get any larger
+   */
+  auto Grow(size_t num_slots) -> bool;
+
+  /** @return the size of the table a full table is replaced by, see Grow. Holds the table latch. */
+  auto GrowthSize() -> size_t;
+
+  /** Move the entries of up to num_blocks blocks of the old table over. Holds the table latch. */
+  void MigrateBlocks(size_t num_blocks);
+
+  /** @return the number of occupied slots past which the current table grows */
+  auto MaxOccupied() -> size_t;
 
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
+  // The table being migrated from, INVALID_PAGE_ID when no resize is in progress, and its next block to migrate
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  size_t next_migrate_block_{0};
+
+  // The size of the current table and its occupied slots, tombstones included
+  size_t size_{0};
+  std::atomic<size_t> num_occupied_{0};
+  // The number of pairs in both tables
+  std::atomic<size_t> num_live_{0};
+
   // Readers includes inserts and removes, writer is only resize
   ReaderWriterLatch table_latch_;
 
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.h
+//
+// Identification: src/include/execution/executors/index_only_scan_executor.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexOnlyScanExecutor executes an index scan that answers from the index entries, without fetching the tuples from
+ * the table. The index drops the entry of a tuple when the tuple is deleted, so every entry is of a live tuple.
+ */
+class IndexOnlyScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new index-only scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the index-only scan plan to be executed
+   */
+  IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan);
+
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+ private:
+  /** The index-only scan plan node to be executed. */
+  const IndexOnlyScanPlanNode *plan_;
+  IndexInfo *index_info_ = nullptr;
+  /** Tuples built from the index entries within the bounds that pass the filter, and their RIDs, collected by Init. */
+  std::vector<std::pair<Tuple, RID>> tuples_;
+  size_t next_tuple_ = 0;
+};
+}  // namespace bustub
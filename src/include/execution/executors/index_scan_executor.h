@@ -12,18 +12,21 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table, from the plan's lower bound up to its upper bound, or from
+ * the upper bound down to the lower bound if the plan asks for the first key column in descending order.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -41,12 +44,56 @@ class IndexScanExecutor : public AbstractExecutor {
 
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * A scan yields its entries sorted on all key columns in the direction of the first one. Turn that into the order of
+   * key_order by reversing, for every later key column that must go the other way, the runs of entries that agree on
+   * the columns before it.
+   * @param keys the key columns of the entries, in the order of the scan
+   * @param key_order the direction of each key column, as many as there are columns in keys
+   * @return the positions in keys of the entries, in key_order
+   */
+  static auto KeyOrderPermutation(const std::vector<std::vector<Value>> &keys,
+                                  const std::vector<OrderByType> &key_order) -> std::vector<size_t>;
+
+  /**
+   * Position a cursor at the first entry a scan between the bounds yields.
+   * @param index the index to scan
+   * @param key_schema the key schema of the index
+   * @param lower_bound values of a prefix of the key columns, empty for none
+   * @param upper_bound values of a prefix of the key columns, empty for none
+   * @param reverse whether the scan goes from the upper bound down to the lower bound
+   * @return the cursor, which does not stop at the other bound
+   */
+  static auto OpenCursor(BPlusTreeIndexBase *index, const Schema &key_schema, const std::vector<Value> &lower_bound,
+                         const std::vector<Value> &upper_bound, bool reverse) -> std::unique_ptr<BPlusTreeIndexCursor>;
+
+  /** @return true if key, the values of (at least) the bounded key columns, sorts after upper_bound */
+  static auto PastUpperBound(const std::vector<Value> &key, const std::vector<Value> &upper_bound) -> bool;
+
+  /** @return true if key, the values of (at least) the bounded key columns, sorts before lower_bound */
+  static auto BeforeLowerBound(const std::vector<Value> &key, const std::vector<Value> &lower_bound) -> bool;
+
  private:
+  /**
+   * Replace rids_ with the RIDs of the next entries within the bounds, in the order of the plan, reading no tuples.
+   * @param max_rids the maximum number of RIDs to read
+   */
+  void ReadEntries(size_t max_rids);
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   TableInfo *table_info_ = nullptr;
   IndexInfo *index_info_ = nullptr;
-  BPlusTreeIndexForTwoIntegerColumn *tree_ = nullptr;
-  IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType> iter_;
+  /** The index as a B+ tree, nullptr for a hash index. */
+  BPlusTreeIndexBase *index_ = nullptr;
+  /** RIDs of the index entries within the bounds, read by Init, and by Next if a limit stopped Init early. */
+  std::vector<RID> rids_;
+  size_t next_rid_ = 0;
+  /** Number of index entries read so far. */
+  size_t num_read_ = 0;
+  /** Number of tuples emitted so far. */
+  size_t num_emitted_ = 0;
+  /** Whether the scan read the last entry within the bounds. */
+  bool index_done_ = false;
 };
 }  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_plan.h
+//
+// Identification: src/include/execution/plans/index_only_scan_plan.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_order_by.h"
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
+
+namespace bustub {
+/**
+ * IndexOnlyScanPlanNode is an index scan that reads the columns of the index entries instead of the tuples.
+ *
+ * It returns the same range as IndexScanPlanNode, in tuples of the table schema whose columns the index does not
+ * store are NULL. The optimizer only plans it when the parent and the filter read nothing but the columns the index
+ * stores: its key columns and the columns it includes.
+ */
+class IndexOnlyScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new index-only scan plan node.
+   * @param output The output format of this scan plan node
+   * @param index_oid The identifier of the index to be scanned
+   * @param filter_predicate The predicate the returned tuples must satisfy, over columns the index stores
+   * @param lower_bound Values of a prefix of the key columns that the returned keys are not less than
+   * @param upper_bound Values of a prefix of the key columns that the returned keys are not greater than
+   * @param key_order The order of each key column in the output, all ascending if empty
+   * @param limit The number of tuples to return at most, std::nullopt for all of them
+   */
+  IndexOnlyScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef filter_predicate = nullptr,
+                        std::vector<Value> lower_bound = {}, std::vector<Value> upper_bound = {},
+                        std::vector<OrderByType> key_order = {}, std::optional<size_t> limit = std::nullopt)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        filter_predicate_(std::move(filter_predicate)),
+        lower_bound_(std::move(lower_bound)),
+        upper_bound_(std::move(upper_bound)),
+        key_order_(std::move(key_order)),
+        limit_(limit) {}
+
+  /** Creates an index-only scan over the range of an index scan. */
+  explicit IndexOnlyScanPlanNode(const IndexScanPlanNode &index_scan)
+      : IndexOnlyScanPlanNode(index_scan.output_schema_, index_scan.index_oid_, index_scan.filter_predicate_,
+                              index_scan.lower_bound_, index_scan.upper_bound_, index_scan.key_order_,
+                              index_scan.limit_) {}
+
+  auto GetType() const -> PlanType override { return PlanType::IndexOnlyScan; }
+
+  /** @return the identifier of the index that should be scanned */
+  auto GetIndexOid() const -> index_oid_t { return index_oid_; }
+
+  /** @return true if the scan goes from the largest key down, for a descending first column */
+  auto IsReverse() const -> bool { return !key_order_.empty() && key_order_[0] == OrderByType::DESC; }
+
+  /** @return true if a key column goes the other way than the first one, so that the scan has to reorder entries */
+  auto IsMixedOrder() const -> bool {
+    return std::any_of(key_order_.begin(), key_order_.end(),
+                       [this](OrderByType type) { return (type == OrderByType::DESC) != IsReverse(); });
+  }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexOnlyScanPlanNode);
+
+  /** The index whose entries should be scanned. */
+  index_oid_t index_oid_;
+
+  /** The predicate to filter the tuples in the key range with, nullptr if all of them are returned. */
+  AbstractExpressionRef filter_predicate_;
+
+  /** The lower bound of the key range. */
+  std::vector<Value> lower_bound_;
+
+  /** The upper bound of the key range. */
+  std::vector<Value> upper_bound_;
+
+  /**
+   * The order of the key columns in the output. The scan goes through the index in the order of the first column,
+   * the entries whose first columns are equal are reordered for the others.
+   */
+  std::vector<OrderByType> key_order_;
+
+  /** The number of tuples to return at most. */
+  std::optional<size_t> limit_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    std::string desc = fmt::format("IndexOnlyScan {{ index_oid={}", index_oid_);
+    if (!lower_bound_.empty()) {
+      desc += fmt::format(", lower=[{}]", fmt::join(lower_bound_, ", "));
+    }
+    if (!upper_bound_.empty()) {
+      desc += fmt::format(", upper=[{}]", fmt::join(upper_bound_, ", "));
+    }
+    if (filter_predicate_ != nullptr) {
+      desc += fmt::format(", filter={}", filter_predicate_);
+    }
+    if (!key_order_.empty()) {
+      desc += fmt::format(", order=[{}]", fmt::join(key_order_, ", "));
+    }
+    if (limit_.has_value()) {
+      desc += fmt::format(", limit={}", *limit_);
+    }
+    return desc + " }";
+  }
+};
+
+}  // namespace bustub
@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
@@ -22,6 +26,9 @@
 namespace bustub {
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * The scan returns the tuples whose index key lies between lower_bound_ and upper_bound_ (both inclusive), in key
+ * order. A bound holds values for a prefix of the key columns, an empty bound leaves that side of the range open.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -29,25 +36,79 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output The output format of this scan plan node
    * @param table_oid The identifier of table to be scanned
+   * @param filter_predicate The predicate the returned tuples must satisfy
+   * @param lower_bound Values of a prefix of the key columns that the returned keys are not less than
+   * @param upper_bound Values of a prefix of the key columns that the returned keys are not greater than
+   * @param key_order The order of each key column in the output, all ascending if empty
+   * @param limit The number of tuples to return at most, std::nullopt for all of them
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef filter_predicate = nullptr,
+                    std::vector<Value> lower_bound = {}, std::vector<Value> upper_bound = {},
+                    std::vector<OrderByType> key_order = {}, std::optional<size_t> limit = std::nullopt)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        filter_predicate_(std::move(filter_predicate)),
+        lower_bound_(std::move(lower_bound)),
+        upper_bound_(std::move(upper_bound)),
+        key_order_(std::move(key_order)),
+        limit_(limit) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return true if the scan goes from the largest key down, for a descending first column */
+  auto IsReverse() const -> bool { return !key_order_.empty() && key_order_[0] == OrderByType::DESC; }
+
+  /** @return true if a key column goes the other way than the first one, so that the scan has to reorder entries */
+  auto IsMixedOrder() const -> bool {
+    return std::any_of(key_order_.begin(), key_order_.end(),
+                       [this](OrderByType type) { return (type == OrderByType::DESC) != IsReverse(); });
+  }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The predicate to filter the tuples in the key range with, nullptr if all of them are returned. */
+  AbstractExpressionRef filter_predicate_;
+
+  /** The lower bound of the key range. */
+  std::vector<Value> lower_bound_;
+
+  /** The upper bound of the key range. */
+  std::vector<Value> upper_bound_;
+
+  /**
+   * The order of the key columns in the output. The scan goes through the index in the order of the first column,
+   * the entries whose first columns are equal are reordered for the others.
+   */
+  std::vector<OrderByType> key_order_;
+
+  /** The number of tuples to return at most. */
+  std::optional<size_t> limit_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string desc = fmt::format("IndexScan {{ index_oid={}", index_oid_);
+    if (!lower_bound_.empty()) {
+      desc += fmt::format(", lower=[{}]", fmt::join(lower_bound_, ", "));
+    }
+    if (!upper_bound_.empty()) {
+      desc += fmt::format(", upper=[{}]", fmt::join(upper_bound_, ", "));
+    }
+    if (filter_predicate_ != nullptr) {
+      desc += fmt::format(", filter={}", filter_predicate_);
+    }
+    if (!key_order_.empty()) {
+      desc += fmt::format(", order=[{}]", fmt::join(key_order_, ", "));
+    }
+    if (limit_.has_value()) {
+      desc += fmt::format(", limit={}", *limit_);
+    }
+    return desc + " }";
   }
 };
 
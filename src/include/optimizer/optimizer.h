@@ -83,6 +83,18 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize filter over seq scan as a bounded index scan if the filter restricts a prefix of the key columns
+   * of an index on the table to constants
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief optimize an index scan as an index-only scan if its parent and its filter read only the columns that the
+   * entries of the index store
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
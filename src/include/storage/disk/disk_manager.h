@@ -15,24 +15,42 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/disk_scheduler.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Page I/O on the database file is performed by a DiskScheduler, so that many page reads and writes can be in flight
+ * at the same time. The synchronous ReadPage / WritePage calls simply wait for their request to complete, while the
+ * *Async variants hand the future of the request back to the caller.
+ *
+ * Page allocation is tracked in a free-space map, a bitmap with one bit per page of the database file. AllocatePage()
+ * hands out the lowest free page id, so that pages freed by DeallocatePage() are reused before the file grows, and
+ * Shrink() gives the free pages at the end of the file back to the file system. The map is kept in a sidecar file
+ * next to the database file (test.db -> test.fsm) and written back by SyncFreeSpaceMap(). Pages found in the database
+ * file beyond the end of the map, such as pages written after the last sync, are considered allocated on open. The
+ * first allocation after a sync deletes the sidecar file, so that a map missing allocations made since (after a crash)
+ * is never loaded: without a map, every page of the database file is considered allocated.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param backend the I/O backend of the disk scheduler
+   * @param direct_io whether page I/O bypasses the OS page cache
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskSchedulerBackend backend = DiskSchedulerBackend::ThreadPool,
+                       bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
@@ -51,6 +69,13 @@ class DiskManager {
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write a run of pages with consecutive ids to the database file as a single sequential write.
+   * @param first_page_id id of the first page in the run
+   * @param pages raw data of the pages, pages[i] is written to page first_page_id + i
+   */
+  virtual void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages);
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -58,6 +83,76 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read a page from the database file without waiting for the read to complete. In-memory disk managers perform the
+   * read right away and return a ready future.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the future is ready
+   * @return a future set to true once the page has been read
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Write a run of pages with consecutive ids without waiting for the write to complete.
+   * @param first_page_id id of the first page in the run
+   * @param pages raw data of the pages, must stay unchanged until the future is ready
+   * @return a future set to true once the pages have been written
+   */
+  virtual auto WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages) -> std::future<bool>;
+
+  /**
+   * Allocate the lowest free page id that is congruent to residue modulo stride. Callers that partition the page ids,
+   * such as the shards of a buffer pool, pass their own stride and residue.
+   * @param stride the distance between the page ids the caller may receive
+   * @param residue the remainder of the page ids the caller may receive, must be less than stride
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(size_t stride = 1, size_t residue = 0) -> page_id_t;
+
+  /**
+   * Mark a page free, so that its id can be handed out again. The content of the page is left as it is.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Allocate an extent: the lowest run of num_pages free pages with consecutive ids that starts at a multiple of
+   * num_pages. Aligned extents never overlap, so a freed extent leaves a hole that the next extent fills exactly.
+   * @param num_pages the number of pages in the extent
+   * @return the id of the first page of the extent
+   */
+  auto AllocateExtent(size_t num_pages) -> page_id_t;
+
+  /**
+   * Mark every page of an extent free.
+   * @param first_page_id id of the first page of the extent
+   * @param num_pages the number of pages in the extent
+   */
+  void DeallocateExtent(page_id_t first_page_id, size_t num_pages);
+
+  /** @return true if page_id is allocated */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /** @return the number of pages up to and including the last allocated page */
+  auto GetNumPages() -> size_t;
+
+  /** Write the free-space map to its sidecar file if it changed since the last sync. */
+  void SyncFreeSpaceMap();
+
+  /**
+   * Truncate the database file after its last allocated page. This may run while a buffer pool is using the disk
+   * manager, since free pages are never resident in (or written back by) a buffer pool.
+   * @return the number of pages cut off the end of the file
+   */
+  auto Shrink() -> size_t;
+
+  /**
+   * @param extension the extension of the sidecar file, including the dot
+   * @return the name of a file that belongs with the database file, such as test.fsm for test.db and ".fsm", or an
+   * empty string if there is no database file
+   */
+  auto GetSidecarFileName(const std::string &extension) const -> std::string;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -93,19 +188,41 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
-  auto GetFileSize(const std::string &file_name) -> int;
+  auto GetFileSize(const std::string &file_name) -> int64_t;
+  /** Read the free-space map from its sidecar file, db_pages is the number of pages in the database file. */
+  void LoadFreeSpaceMap(size_t db_pages);
+  /** Mark page_id allocated or free in the map. Caller must hold fsm_latch_. */
+  void SetAllocated(page_id_t page_id, bool allocated);
+  /** Mark page_id free and lower the allocation hint of its residue. Caller must hold fsm_latch_. */
+  void FreePage(page_id_t page_id);
+  /** Write the free-space map to its sidecar file if it is dirty. Caller must hold fsm_latch_. */
+  void WriteFreeSpaceMap();
+  /** Delete the sidecar file before pages are allocated, unless it is gone already. Caller must hold fsm_latch_. */
+  void InvalidateFreeSpaceMap();
+  /** @return the number of pages up to and including the last allocated page. Caller must hold fsm_latch_. */
+  auto CountPages() -> size_t;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // scheduler performing the page I/O on the db file
+  std::unique_ptr<DiskScheduler> scheduler_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+
+  // the free-space map, bit i of word i / 64 is set iff page i is allocated
+  std::vector<uint64_t> fsm_;
+  // sidecar file of the free-space map, empty for in-memory disk managers
+  std::string fsm_name_;
+  bool fsm_dirty_{false};
+  // whether the sidecar file may exist, it is deleted before the map changes in a way it does not reflect
+  bool fsm_on_disk_{true};
+  // every page id congruent to r modulo hint_stride_ and below next_free_[r] is allocated
+  std::vector<page_id_t> next_free_;
+  size_t hint_stride_{0};
+  std::mutex fsm_latch_;
 };
 
 }  // namespace bustub
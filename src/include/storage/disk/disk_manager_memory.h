@@ -46,6 +46,13 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  /**
+   * Write a run of pages with consecutive ids.
+   * @param first_page_id id of the first page in the run
+   * @param pages raw data of the pages
+   */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -74,19 +81,21 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     if (latency_ > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
+    CopyIn(page_id, page_data);
+  }
 
-    std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size())) {
-      data_.resize(page_id + 1);
+  /**
+   * Write a run of pages with consecutive ids, paying the disk latency once for the whole run.
+   * @param first_page_id id of the first page in the run
+   * @param pages raw data of the pages
+   */
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override {
+    if (latency_ > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
-    if (data_[page_id] == nullptr) {
-      data_[page_id] = std::make_shared<ProtectedPage>();
+    for (size_t i = 0; i < pages.size(); i++) {
+      CopyIn(first_page_id + static_cast<page_id_t>(i), pages[i]);
     }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
-    std::unique_lock<std::shared_mutex> l_page(ptr->second);
-    l.unlock();
-
-    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
   }
 
   /**
@@ -118,6 +127,22 @@ class DiskManagerUnlimitedMemory : public DiskManager {
   void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
 
  private:
+  /** Store one page, creating it on first write. */
+  void CopyIn(page_id_t page_id, const char *page_data) {
+    std::unique_lock<std::mutex> l(mutex_);
+    if (page_id >= static_cast<int>(data_.size())) {
+      data_.resize(page_id + 1);
+    }
+    if (data_[page_id] == nullptr) {
+      data_[page_id] = std::make_shared<ProtectedPage>();
+    }
+    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
+    std::unique_lock<std::shared_mutex> l_page(ptr->second);
+    l.unlock();
+
+    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
+  }
+
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a read or write request for the DiskScheduler to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /** ID of the first page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** One BUSTUB_PAGE_SIZE buffer per page: data_[i] is read into / written from page page_id_ + i. */
+  std::vector<char *> data_;
+
+  /** Callback used to signal to the request issuer when the request has been completed, false if the I/O failed. */
+  std::promise<bool> callback_;
+};
+
+/** The mechanism a DiskScheduler uses to perform I/O. */
+enum class DiskSchedulerBackend {
+  /** A pool of worker threads, each doing blocking preadv/pwritev calls. */
+  ThreadPool,
+  /** A single io_uring instance, with one thread submitting requests and one reaping completions. */
+  IoUring
+};
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations on a database file.
+ *
+ * Requests are queued with Schedule() and executed in the background; the issuer waits on the future of the
+ * request's callback. Any number of requests may be outstanding at the same time, and requests on different pages
+ * may complete in any order. A request covering several consecutive pages is performed with a single vectored I/O.
+ *
+ * The io_uring backend is used only if the kernel supports it, otherwise the scheduler falls back to the thread pool.
+ * With direct_io the file is opened with O_DIRECT (if the file system supports it), which bypasses the OS page cache.
+ * O_DIRECT needs page-aligned buffers, requests whose buffers are not aligned are copied through an aligned bounce
+ * buffer.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Open (or create) the database file and start the background threads.
+   * @param db_file the database file name
+   * @param backend the preferred I/O backend
+   * @param direct_io whether to bypass the OS page cache
+   * @param num_workers the number of worker threads of the thread pool backend
+   */
+  explicit DiskScheduler(const std::string &db_file, DiskSchedulerBackend backend = DiskSchedulerBackend::ThreadPool,
+                         bool direct_io = false, size_t num_workers = DISK_SCHEDULER_WORKERS);
+
+  /** @brief Complete every scheduled request, stop the background threads and close the file. */
+  ~DiskScheduler();
+
+  /**
+   * @brief Schedules a request for the background threads to execute.
+   * @param r the request to be scheduled
+   */
+  void Schedule(DiskRequest r);
+
+  /** @brief Schedule a read of one page. @return a future set to true once page_data holds the page */
+  auto ReadPage(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /** @brief Schedule a write of one page. @return a future set to true once the page is written */
+  auto WritePage(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /** @brief Schedule a write of the pages first_page_id, first_page_id + 1, ... with a single I/O. */
+  auto WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) -> std::future<bool>;
+
+  /**
+   * @brief Cut the database file down to its first num_pages pages. The caller guarantees that no request on the
+   * pages being cut off is scheduled or in flight.
+   * @return true if the file was truncated
+   */
+  auto Truncate(size_t num_pages) -> bool;
+
+  /** @return the backend actually in use */
+  auto GetBackend() const -> DiskSchedulerBackend { return backend_; }
+
+  /** @return true if the file was opened with O_DIRECT */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+ private:
+  struct PendingIO;
+  struct IoUring;
+
+  /** Turn a request into iovecs, going through a bounce buffer if O_DIRECT cannot use the caller's buffers. */
+  auto Prepare(DiskRequest r) -> std::unique_ptr<PendingIO>;
+
+  /** Perform (the remainder after the first done bytes of) an I/O with blocking system calls. */
+  auto Transfer(PendingIO &io, size_t done) -> bool;
+
+  /** Copy data out of the bounce buffer if any, and signal the issuer. */
+  void Complete(std::unique_ptr<PendingIO> io, bool ok);
+
+  /** Pop the next request, blocking until there is one. Returns false once the scheduler is shut down and idle. */
+  auto PopRequest(DiskRequest *r) -> bool;
+
+  /** Thread pool backend: execute requests one at a time. */
+  void WorkerLoop();
+
+  /** io_uring backend: move requests from the queue to the submission ring. */
+  void SubmitLoop();
+
+  /** io_uring backend: signal the issuers of completed requests. */
+  void ReapLoop();
+
+  int fd_{-1};
+  DiskSchedulerBackend backend_;
+  bool direct_io_{false};
+
+  /** Requests not yet picked up by a background thread. */
+  std::deque<DiskRequest> queue_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool shutdown_{false};
+
+  std::unique_ptr<IoUring> ring_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
@@ -3,22 +3,34 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, or in a non-unique tree a key maps to a posting list of values
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is a B-link tree (Lehman & Yao): every page has a high key and a link
+ * to its right sibling, so a search that reaches a page after it split can move
+ * right to find its key. Searches hold a single latch at a time instead of
+ * coupling down from the header, and splits latch one level at a time, adding
+ * the separator to the parent after the split page has been released.
  */
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <deque>
+#include <functional>
 #include <iostream>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "buffer/segment.h"
 #include "common/config.h"
 #include "common/macros.h"
 #include "concurrency/transaction.h"
@@ -59,6 +71,8 @@ class Context {
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
 // Main class providing the API for the Interactive B+ Tree.
+// The nodes of the tree are allocated from a segment of its own, so that leaves split or bulk loaded one after the
+// other are adjacent on disk.
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
@@ -67,7 +81,7 @@ class BPlusTree {
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE - 1,
-                     int internal_max_size = INTERNAL_PAGE_SIZE - 1);
+                     int internal_max_size = INTERNAL_PAGE_SIZE - 1, bool unique = true);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -75,15 +89,37 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
 
+  /**
+   * @brief Fill an empty tree with entries, building it bottom-up instead of inserting them one by one.
+   *
+   * The entries are sorted (in parallel when there are many), then packed left to right into leaves filled to
+   * fill_factor of their max size, and the internal levels are built on top of them. Of entries with equal keys, a
+   * unique tree only loads the first, like Insert would do, and a non-unique tree loads all their values. If the tree
+   * is not empty, the entries are inserted one by one.
+   *
+   * @param entries the entries to load, in any order; sorted in place
+   * @param fill_factor the fraction of each node that is filled, the rest is left for later inserts
+   */
+  void BulkLoad(std::vector<MappingType> *entries, double fill_factor = BULK_LOAD_FILL_FACTOR);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *txn);
 
+  // Remove a single value of a key from this B+ tree, and the key if it was the last one.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *txn);
+
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  // Return the number of pages of the tree's segment in use, the header page is not part of it
+  auto GetNumPages() -> size_t { return segment_.GetNumPages(); }
+
+  // Return the segment holding the pages of the tree
+  auto GetSegment() -> Segment * { return &segment_; }
+
   // Index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
 
@@ -91,6 +127,16 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Index iterator in descending key order, from the last entry
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  /**
+   * @brief Index iterator in descending key order, from the last entry whose key satisfies pred.
+   * @param pred holds for the keys up to some key and for none after it, like `key <= bound`
+   * @return iterator positioned at the last value of that key, or the end if no key satisfies pred
+   */
+  auto RBegin(const std::function<bool(const KeyType &)> &pred) -> INDEXITERATOR_TYPE;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -128,9 +174,94 @@ class BPlusTree {
   void BatchOpsFromFile(const std::string &file_name, Transaction *txn = nullptr);
 
  private:
-  auto LeafBinarySearch(const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *page, const KeyType &key) -> int;
-  auto InternalBinarySearch(const BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *page, const KeyType &key)
-      -> int;
+  // the iterator searches the tree again when it cannot latch the next leaf
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
+  /**
+   * Descend to the leaf that holds key, or the leftmost leaf if key is nullptr, latching one page at a time and moving
+   * right past pages that split. Guard is ReadPageGuard or WritePageGuard, the latch taken on the leaf.
+   * @param path if not nullptr, filled with the internal pages descended through from the root
+   * @return the guard of the leaf, std::nullopt if the tree is empty
+   */
+  template <typename Guard>
+  auto FindLeaf(const KeyType *key, std::vector<page_id_t> *path = nullptr) -> std::optional<Guard>;
+  // read latch the header page, following header_swip_ once it is swizzled
+  auto FetchHeaderRead() -> ReadPageGuard;
+  /**
+   * Move a read latch down or right, from the page guard holds to next_page_id, a page it refers to. Internal pages are
+   * swizzled, and reached through the swip of the page that refers to them without going through the buffer pool.
+   */
+  void Descend(ReadPageGuard *guard, page_id_t next_page_id);
+  // true if key belongs to a page to the right of page, because page split after its parent pointed to it
+  auto IsBeyond(const BPlusTreePage *page, const KeyType &key) const -> bool;
+  static auto RightPageId(const BPlusTreePage *page) -> page_id_t;
+  // only valid if page has a right page
+  static auto HighKey(const BPlusTreePage *page) -> KeyType;
+  /**
+   * Add the separator of a split at level (0 for leaves) to the parent, splitting it in turn if it overflows.
+   * @param path the pages above the split page, from the root down, as FindLeaf filled it
+   */
+  void InsertIntoParent(std::vector<page_id_t> *path, int level, page_id_t left_page_id, const KeyType &separator,
+                        page_id_t right_page_id);
+  // the pages that lead down to the pages at level that may hold key
+  auto PathTo(const KeyType &key, int level) -> std::vector<page_id_t>;
+  // fullness checks of a leaf or internal page, whichever page is
+  static auto IsInsertSafe(const BPlusTreePage *page) -> bool;
+  static auto IsRemoveSafe(const BPlusTreePage *page) -> bool;
+  static auto IsOverflow(const BPlusTreePage *page) -> bool;
+  static auto IsUnderflow(const BPlusTreePage *page) -> bool;
+  void SortEntries(std::vector<MappingType> *entries);
+  // add another value to the entry of a key in a non-unique tree
+  auto InsertDuplicate(LeafPage *leaf_page, int pos, const ValueType &value) -> bool;
+  // removes value of key, or the whole entry when value is nullptr
+  void RemoveEntry(const KeyType &key, const ValueType *value, Transaction *txn);
+  // remove value of key latching only the leaf, returns false without changing anything if the leaf would underflow
+  auto RemoveFromLeaf(const KeyType &key, const ValueType *value, bool allow_underflow) -> bool;
+  void RemoveWithRebalance(const KeyType &key, const ValueType *value);
+  // remove value from the entry at pos if it is in its posting list, returns true if the whole entry has to go
+  auto RemoveFromEntry(LeafPage *leaf_page, int pos, const ValueType *value) -> bool;
+  void RemoveEntryAt(LeafPage *leaf_page, int pos);
+  /**
+   * Pages taken out of the tree may still be pinned by searches that are about to see that they are deleted, and
+   * splits may fetch them again from the pages they descended through. The segment hands the ids of deleted pages out
+   * again, so retired pages are only deleted once no operation that started before they were retired is running, and
+   * no one has them pinned.
+   *
+   * Every operation registers in the epoch current when it starts. The epoch only advances once no operation of the
+   * previous epoch is left, so the running operations all belong to the current epoch or the one before. A page
+   * retired in epoch e is deleted once the epoch reaches e + 2. Inserts and removes reclaim pages and try to advance
+   * the epoch, so that pages are reclaimed under any steady traffic, and a remove with no other operation running
+   * deletes all retired pages. Pages still retired when the tree goes away stay in its segment like all its other
+   * pages, so the tree does not use the buffer pool once it is destroyed.
+   */
+  void RetirePage(page_id_t page_id);
+  void ReclaimPages();
+
+  // number of epochs operations can register in, the current one, the one before, and the next one
+  static constexpr size_t NUM_EPOCH_SLOTS = 3;
+
+  // registers a search or modification in the current epoch for as long as it lives
+  class OperationGuard {
+   public:
+    explicit OperationGuard(BPlusTree *tree) : tree_(tree) {
+      // Retry if the epoch advanced meanwhile, so that the slot does not count for a later epoch.
+      while (true) {
+        epoch_ = tree_->epoch_.load();
+        tree_->active_ops_[epoch_ % NUM_EPOCH_SLOTS].fetch_add(1);
+        if (tree_->epoch_.load() == epoch_) {
+          break;
+        }
+        tree_->active_ops_[epoch_ % NUM_EPOCH_SLOTS].fetch_sub(1);
+      }
+    }
+    ~OperationGuard() { tree_->active_ops_[epoch_ % NUM_EPOCH_SLOTS].fetch_sub(1); }
+    OperationGuard(const OperationGuard &) = delete;
+    auto operator=(const OperationGuard &) -> OperationGuard & = delete;
+
+   private:
+    BPlusTree *tree_;
+    uint64_t epoch_;
+  };
   /* Debug Routines for FREE!! */
   void ToGraph(page_id_t page_id, const BPlusTreePage *page, std::ofstream &out);
 
@@ -147,11 +278,22 @@ class BPlusTree {
   // member variable
   std::string index_name_;
   BufferPoolManager *bpm_;
+  Segment segment_;
   KeyComparator comparator_;
   std::vector<std::string> log;  // NOLINT
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  Swip header_swip_{0};
+  bool unique_;
+  std::mutex retired_latch_;
+  // retired pages and the epochs they were retired in
+  std::vector<std::pair<uint64_t, page_id_t>> retired_pages_;
+  std::atomic<size_t> num_retired_{0};
+  // see RetirePage
+  std::atomic<uint64_t> epoch_{0};
+  // number of operations descending the tree or holding page ids taken from it, per epoch modulo NUM_EPOCH_SLOTS
+  std::array<std::atomic<int>, NUM_EPOCH_SLOTS> active_ops_{};
 };
 
 /**
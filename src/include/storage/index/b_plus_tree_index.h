@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
@@ -24,8 +25,68 @@ namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/** A cursor over the entries of a B+ tree index in key order, whatever key type the index uses. */
+class BPlusTreeIndexCursor {
+ public:
+  virtual ~BPlusTreeIndexCursor() = default;
+
+  /** @return true once the cursor has moved past the last entry */
+  virtual auto IsEnd() -> bool = 0;
+
+  /** @return the RID of the current entry */
+  virtual auto GetRID() -> RID = 0;
+
+  /**
+   * Decode the current entry, so that a scan needs not fetch the tuple when the index covers the columns it reads.
+   * @param values cleared, then filled with the columns of the entry schema
+   */
+  virtual void GetEntry(std::vector<Value> *values) = 0;
+
+  /** Move to the next entry. */
+  virtual void Next() = 0;
+
+  /**
+   * Copy the RIDs of the entries starting at the current one into rids, and move past them.
+   * @param rids cleared, then filled with up to max_size RIDs
+   * @param max_size the maximum number of RIDs to copy
+   * @return the number of RIDs copied, 0 once the cursor is at the end
+   */
+  virtual auto NextBatch(std::vector<RID> *rids, size_t max_size) -> size_t = 0;
+};
+
+/**
+ * The part of BPlusTreeIndex that does not depend on the key type. The catalog picks the key type and comparator of a
+ * B+ tree index from its key schema, so executors reach the index through this interface.
+ */
+class BPlusTreeIndexBase : public Index {
+ public:
+  explicit BPlusTreeIndexBase(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+  /** @return a cursor positioned at the first entry of the index */
+  virtual auto Scan() -> std::unique_ptr<BPlusTreeIndexCursor> = 0;
+
+  /**
+   * @param key a tuple of the key schema, NULL columns sort before any value
+   * @return a cursor positioned at the first entry whose key is not less than key
+   */
+  virtual auto Scan(const Tuple &key) -> std::unique_ptr<BPlusTreeIndexCursor> = 0;
+
+  /** @return a cursor positioned at the last entry of the index, moving to smaller keys */
+  virtual auto ReverseScan() -> std::unique_ptr<BPlusTreeIndexCursor> = 0;
+
+  /**
+   * @param bound values of a prefix of the key columns, NULL sorts before any value
+   * @return a cursor positioned at the last entry whose key columns are not greater than bound, compared on as many
+   * columns as bound has, moving to smaller keys
+   */
+  virtual auto ReverseScan(const std::vector<Value> &bound) -> std::unique_ptr<BPlusTreeIndexCursor> = 0;
+
+  /** @return the segment holding the pages of the tree */
+  virtual auto GetSegment() -> Segment * = 0;
+};
+
 INDEX_TEMPLATE_ARGUMENTS
-class BPlusTreeIndex : public Index {
+class BPlusTreeIndex : public BPlusTreeIndexBase {
  public:
   BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
 
@@ -35,6 +96,22 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto Scan() -> std::unique_ptr<BPlusTreeIndexCursor> override;
+
+  auto Scan(const Tuple &key) -> std::unique_ptr<BPlusTreeIndexCursor> override;
+
+  auto ReverseScan() -> std::unique_ptr<BPlusTreeIndexCursor> override;
+
+  auto ReverseScan(const std::vector<Value> &bound) -> std::unique_ptr<BPlusTreeIndexCursor> override;
+
+  auto GetSegment() -> Segment * override { return container_->GetSegment(); }
+
+  /**
+   * Fill the empty index with entries, building the tree bottom-up.
+   * @param entries index keys and their RIDs, in any order; sorted in place
+   */
+  void BulkLoad(std::vector<MappingType> *entries);
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -42,8 +119,14 @@ class BPlusTreeIndex : public Index {
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
  protected:
-  // comparator for key
+  /** @return the index key to search for key, a tuple of the key schema, with the included columns NULL */
+  auto ProbeKey(const Tuple &key) -> KeyType;
+
+  // comparator for key, which orders a non-unique covering index by its included columns too, so that the tuples
+  // sharing a posting list share their included values
   KeyComparator comparator_;
+  // comparator for the key columns alone
+  KeyComparator key_comparator_;
   // container
   std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
 };
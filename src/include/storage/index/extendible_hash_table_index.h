@@ -25,6 +25,11 @@ namespace bustub {
 
 #define HASH_TABLE_INDEX_TYPE ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * An index that keeps its entries in a DiskExtendibleHashTable. It only answers lookups of whole keys, but takes one
+ * directory and one bucket page access for them where a B+ tree descends from the root. Created with
+ * `CREATE INDEX ... USING HASH`.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTableIndex : public Index {
  public:
@@ -14,6 +14,7 @@
 
 #include <cstring>
 
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -30,11 +31,17 @@ template <size_t KeySize>
 class GenericKey {
  public:
   inline void SetFromKey(const Tuple &tuple) {
+    if (tuple.GetLength() > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "key is too long for the index");
+    }
     // initialize to 0
     memset(data_, 0, KeySize);
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // the key is kept in its tuple format, which does not depend on the schema
+  inline void SetFromKey(const Tuple &tuple, const Schema & /* key_schema */) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -71,7 +78,7 @@ class GenericKey {
 };
 
 /**
- * Function object returns true if lhs < rhs, used for trees
+ * Function object returns true if lhs < rhs, used for trees. NULL sorts before any other value.
  */
 template <size_t KeySize>
 class GenericComparator {
@@ -83,6 +90,12 @@ class GenericComparator {
       Value lhs_value = (lhs.ToValue(key_schema_, i));
       Value rhs_value = (rhs.ToValue(key_schema_, i));
 
+      if (lhs_value.IsNull() || rhs_value.IsNull()) {
+        if (lhs_value.IsNull() != rhs_value.IsNull()) {
+          return lhs_value.IsNull() ? -1 : 1;
+        }
+        continue;
+      }
       if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
         return -1;
       }
@@ -43,11 +43,21 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether a key maps to a single tuple, or to any number of them
+   * @param include_attrs The mapping from columns stored in the entries, but not part of the key, to base table columns
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)),
+        is_unique_(is_unique) {
     key_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, key_attrs_));
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = include_attrs_.empty() ? key_schema_
+                                           : std::make_shared<Schema>(Schema::CopySchema(tuple_schema, entry_attrs_));
   }
 
   ~IndexMetadata() = default;
@@ -72,6 +82,18 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return The mapping relation between included columns and base table columns, empty if the index covers none */
+  inline auto GetIncludeAttrs() const -> const std::vector<uint32_t> & { return include_attrs_; }
+
+  /** @return The key attributes followed by the included attributes, the columns an index entry holds */
+  inline auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return entry_attrs_; }
+
+  /** @return A schema object pointer that represents an index entry: the key columns, then the included columns */
+  inline auto GetEntrySchema() const -> Schema * { return entry_schema_.get(); }
+
+  /** @return Whether a key maps to a single tuple, or to any number of them */
+  inline auto IsUnique() const -> bool { return is_unique_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -81,6 +103,9 @@ class IndexMetadata {
        << "Type = B+Tree, "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
+    if (!include_attrs_.empty()) {
+      os << " INCLUDE " << entry_schema_->ToString();
+    }
 
     return os.str();
   }
@@ -92,8 +117,16 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** The mapping relation between included columns and tuple schema */
+  const std::vector<uint32_t> include_attrs_;
+  /** The key attributes followed by the included attributes */
+  std::vector<uint32_t> entry_attrs_;
   /** The schema of the indexed key */
   std::shared_ptr<Schema> key_schema_;
+  /** The schema of an index entry, the key schema itself if no column is included */
+  std::shared_ptr<Schema> entry_schema_;
+  /** Whether a key maps to a single tuple */
+  bool is_unique_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +172,15 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /** @return The schema of an index entry, which InsertEntry and DeleteEntry take */
+  auto GetEntrySchema() const -> Schema * { return metadata_->GetEntrySchema(); }
+
+  /** @return The index entry attributes, the key attributes followed by the included ones */
+  auto GetEntryAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetEntryAttrs(); }
+
+  /** @return Whether the index stores columns besides the key in its entries */
+  auto IsCovering() const -> bool { return !metadata_->GetIncludeAttrs().empty(); }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -153,7 +195,7 @@ class Index {
 
   /**
    * Insert an entry into the index.
-   * @param key The index key
+   * @param key The index entry, a tuple of the entry schema
    * @param rid The RID associated with the key
    * @param transaction The transaction context
    * @returns whether insertion is successful
@@ -162,15 +204,15 @@ class Index {
 
   /**
    * Delete an index entry by key.
-   * @param key The index key
-   * @param rid The RID associated with the key (unused)
+   * @param key The index entry, a tuple of the entry schema
+   * @param rid The RID associated with the key; a non-unique index only deletes the entry of this RID
    * @param transaction The transaction context
    */
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
   /**
    * Search the index for the provided key.
-   * @param key The index key
+   * @param key The index key, a tuple of the key schema
    * @param result The collection of RIDs that is populated with results of the search
    * @param transaction The transaction context
    */
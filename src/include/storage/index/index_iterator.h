@@ -13,39 +13,97 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class BPlusTree;
+
+/**
+ * Iterator over the entries of a B+ tree in key order.
+ *
+ * The iterator keeps the current leaf pinned and read latched, so dereferencing and advancing within a leaf do not
+ * go through the buffer pool, and writers cannot change the leaf under it. Moving to the next leaf latches it before
+ * releasing the current one. Since writers latch siblings in the other direction, the iterator only tries the next
+ * latch; if a writer holds it, the iterator lets go of its leaf and searches the tree again for the key after the last
+ * one it visited.
+ *
+ * In a non-unique tree, the iterator yields a key once for each of its values. The values of a key with a posting
+ * list are read a posting page at a time, under the latch of the leaf.
+ *
+ * A reverse iterator (see BPlusTree::RBegin) yields the entries in descending order instead. Leaves are only linked
+ * to the right, so to move to the previous leaf it lets go of the current one and searches the tree for the last key
+ * less than the first key of the leaf. It reads the posting list of a key whole, to yield its values last to first.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
-  IndexIterator(page_id_t cur_page_id, int idx, BufferPoolManager *bpm);
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm, ReadPageGuard guard,
+                int idx, bool reverse = false);
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
 
-  auto operator*() -> const MappingType &;
+  auto operator*() -> MappingType;
 
   auto operator++() -> IndexIterator &;
 
+  /**
+   * Copy the entries starting at the current one into batch, and move past them.
+   * @param batch cleared, then filled with up to max_size entries
+   * @param max_size the maximum number of entries to copy
+   * @return the number of entries copied, 0 once the iterator is at the end
+   */
+  auto NextBatch(std::vector<MappingType> *batch, size_t max_size) -> size_t;
+
   auto operator==(const IndexIterator &itr) const -> bool {
-    return cur_page_id_ == itr.cur_page_id_ && idx_ == itr.idx_ && bpm_ == itr.bpm_;
+    return cur_page_id_ == itr.cur_page_id_ && idx_ == itr.idx_ && bpm_ == itr.bpm_ &&
+           posting_idx_ == itr.posting_idx_ && posting_next_page_id_ == itr.posting_next_page_id_;
   }
 
-  auto operator!=(const IndexIterator &itr) const -> bool {
-    return cur_page_id_ != itr.cur_page_id_ || idx_ != itr.idx_ || bpm_ != itr.bpm_;
-  }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
+  /** Move to the first entry of the next leaf, or to the end. */
+  void NextLeaf();
+
+  /** Move to the next entry, skipping the rest of the values of the current one. */
+  void NextEntry();
+
+  /** Move to the last entry of the previous leaf, or to the end. */
+  void PrevLeaf();
+
+  /** Move to the previous entry, for a reverse iterator. */
+  void PrevEntry();
+
+  /** Load the first posting page of the current entry, if its value is a posting list. */
+  void EnterEntry();
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_ = nullptr;
   page_id_t cur_page_id_ = INVALID_PAGE_ID;
   int idx_ = 0;
   BufferPoolManager *bpm_ = nullptr;
+  /** Read latch on the current leaf, empty at the end. */
+  ReadPageGuard guard_;
+  const LeafPage *leaf_ = nullptr;
+  /** Values of the current posting page, empty if the current entry has its value inline. */
+  std::vector<ValueType> posting_values_;
+  size_t posting_idx_ = 0;
+  page_id_t posting_next_page_id_ = INVALID_PAGE_ID;
+  /** Whether the iterator moves to smaller keys. */
+  bool reverse_ = false;
 };
 
 }  // namespace bustub
@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * @return the size of the normalized encoding of a key of key_schema, assuming no VARCHAR value is longer than its
+ * declared length, or 0 if some column type cannot be normalized
+ */
+inline auto NormalizedKeySize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &col : key_schema.GetColumns()) {
+    switch (col.GetType()) {
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+        size += col.GetFixedLength();
+        break;
+      case TypeId::VARCHAR:
+        // null marker, characters and a two-byte terminator
+        size += 1 + col.GetVariableLength() + 2;
+        break;
+      default:
+        return 0;
+    }
+  }
+  return size;
+}
+
+/**
+ * Index key holding a normalized encoding of INT/BIGINT/VARCHAR columns, which compares with memcmp.
+ *
+ * Integers are stored big-endian with the sign bit flipped. A VARCHAR is stored as a null marker (0 for NULL, 1
+ * otherwise), its characters with every 0 byte escaped as 0x00 0x01, and a 0x00 0x00 terminator, so that a string
+ * sorts before all strings it is a prefix of. Unused trailing bytes are zero.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    memset(data_, 0, KeySize);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      const auto &col = key_schema.GetColumn(i);
+      switch (col.GetType()) {
+        case TypeId::TINYINT:
+        case TypeId::SMALLINT:
+        case TypeId::INTEGER:
+        case TypeId::BIGINT: {
+          uint32_t bytes = col.GetFixedLength();
+          int64_t value = 0;
+          if (bytes == 1) {
+            value = *reinterpret_cast<const int8_t *>(tuple.GetData() + col.GetOffset());
+          } else if (bytes == 2) {
+            value = *reinterpret_cast<const int16_t *>(tuple.GetData() + col.GetOffset());
+          } else if (bytes == 4) {
+            value = *reinterpret_cast<const int32_t *>(tuple.GetData() + col.GetOffset());
+          } else {
+            value = *reinterpret_cast<const int64_t *>(tuple.GetData() + col.GetOffset());
+          }
+          uint64_t biased = static_cast<uint64_t>(value) ^ (uint64_t{1} << (bytes * 8 - 1));
+          for (uint32_t b = bytes; b > 0; b--) {
+            Append(&pos, static_cast<char>(biased >> ((b - 1) * 8)));
+          }
+          break;
+        }
+        case TypeId::VARCHAR: {
+          Value value = tuple.GetValue(&key_schema, i);
+          if (value.IsNull()) {
+            Append(&pos, 0);
+            break;
+          }
+          Append(&pos, 1);
+          const char *str = value.GetData();
+          for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+            Append(&pos, str[j]);
+            if (str[j] == 0) {
+              Append(&pos, 1);
+            }
+          }
+          Append(&pos, 0);
+          Append(&pos, 0);
+          break;
+        }
+        default:
+          throw Exception(ExceptionType::MISMATCH_TYPE, "column type cannot be normalized");
+      }
+    }
+  }
+
+  /** @return the value of column column_idx of key_schema, decoded from the key */
+  inline auto ToValue(Schema *key_schema, uint32_t column_idx) const -> Value {
+    size_t pos = 0;
+    for (uint32_t i = 0;; i++) {
+      const auto &col = key_schema->GetColumn(i);
+      if (col.GetType() != TypeId::VARCHAR) {
+        uint32_t bytes = col.GetFixedLength();
+        if (i < column_idx) {
+          pos += bytes;
+          continue;
+        }
+        uint64_t biased = 0;
+        for (uint32_t b = 0; b < bytes; b++) {
+          biased = (biased << 8) | static_cast<uint8_t>(data_[pos + b]);
+        }
+        uint32_t bits = bytes * 8;
+        auto value = static_cast<int64_t>((biased ^ (uint64_t{1} << (bits - 1))) << (64 - bits)) >> (64 - bits);
+        switch (col.GetType()) {
+          case TypeId::TINYINT:
+            return {TypeId::TINYINT, static_cast<int8_t>(value)};
+          case TypeId::SMALLINT:
+            return {TypeId::SMALLINT, static_cast<int16_t>(value)};
+          case TypeId::INTEGER:
+            return {TypeId::INTEGER, static_cast<int32_t>(value)};
+          default:
+            return {TypeId::BIGINT, value};
+        }
+      }
+      if (data_[pos++] == 0) {
+        if (i == column_idx) {
+          return ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+        }
+        continue;
+      }
+      std::string str;
+      // an escaped 0 byte is 0x00 0x01, the terminator 0x00 0x00
+      for (; data_[pos] != 0 || data_[pos + 1] != 0; pos++) {
+        str.push_back(data_[pos]);
+        if (data_[pos] == 0) {
+          pos++;
+        }
+      }
+      pos += 2;
+      if (i == column_idx) {
+        return ValueFactory::GetVarcharValue(str);
+      }
+    }
+  }
+
+  // NOTE: for test purpose only
+  // encode key as a single BIGINT column
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    auto biased = static_cast<uint64_t>(key) ^ (uint64_t{1} << 63);
+    for (size_t b = 0; b < sizeof(uint64_t); b++) {
+      data_[b] = static_cast<char>(biased >> ((sizeof(uint64_t) - 1 - b) * 8));
+    }
+  }
+
+  // NOTE: for test purpose only
+  // interpret the first 8 bytes as a single BIGINT column
+  inline auto ToString() const -> int64_t {
+    uint64_t biased = 0;
+    for (size_t b = 0; b < sizeof(uint64_t); b++) {
+      biased = (biased << 8) | static_cast<uint8_t>(data_[b]);
+    }
+    return static_cast<int64_t>(biased ^ (uint64_t{1} << 63));
+  }
+
+  // NOTE: for test purpose only
+  friend auto operator<<(std::ostream &os, const NormalizedKey &key) -> std::ostream & {
+    os << key.ToString();
+    return os;
+  }
+
+  // actual location of data
+  char data_[KeySize];
+
+ private:
+  inline void Append(size_t *pos, char byte) {
+    if (*pos == KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "key is too long for the index");
+    }
+    data_[(*pos)++] = byte;
+  }
+};
+
+/**
+ * Function object returns the order of two normalized keys, which is the order of their bytes.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+  static_assert(KeySize % sizeof(uint64_t) == 0, "normalized keys are compared a word at a time");
+
+ public:
+  inline auto operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const -> int {
+    // Same result as memcmp, but compares big-endian words instead of single bytes.
+    for (size_t i = 0; i < KeySize; i += sizeof(uint64_t)) {
+      uint64_t lhs_word;
+      uint64_t rhs_word;
+      memcpy(&lhs_word, lhs.data_ + i, sizeof(uint64_t));
+      memcpy(&rhs_word, rhs.data_ + i, sizeof(uint64_t));
+      if (lhs_word != rhs_word) {
+        return __builtin_bswap64(lhs_word) < __builtin_bswap64(rhs_word) ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  // constructor, the key schema is only needed to build keys
+  explicit NormalizedComparator(Schema * /* key_schema */) {}
+};
+
+}  // namespace bustub
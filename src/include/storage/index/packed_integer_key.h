@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// packed_integer_key.h
+//
+// Identification: src/include/storage/index/packed_integer_key.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Index key for keys made only of integer columns that fit in 64 bits together.
+ *
+ * The columns are packed into a single unsigned integer, the first column in the most significant bits. Each column is
+ * offset by the minimum of its type, so the unsigned order of two packed keys is the order of their columns, and
+ * comparing two keys is a single integer comparison.
+ */
+class PackedIntegerKey {
+ public:
+  /** @return true if every column of key_schema is an integer and all of them fit in 64 bits */
+  static auto CanPack(const Schema &key_schema) -> bool {
+    uint32_t bytes = 0;
+    for (const auto &col : key_schema.GetColumns()) {
+      switch (col.GetType()) {
+        case TypeId::TINYINT:
+        case TypeId::SMALLINT:
+        case TypeId::INTEGER:
+        case TypeId::BIGINT:
+          bytes += col.GetFixedLength();
+          break;
+        default:
+          return false;
+      }
+    }
+    return bytes > 0 && bytes <= sizeof(uint64_t);
+  }
+
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    data_ = 0;
+    for (const auto &col : key_schema.GetColumns()) {
+      uint32_t bits = col.GetFixedLength() * 8;
+      int64_t value;
+      switch (col.GetType()) {
+        case TypeId::TINYINT:
+          value = *reinterpret_cast<const int8_t *>(tuple.GetData() + col.GetOffset());
+          break;
+        case TypeId::SMALLINT:
+          value = *reinterpret_cast<const int16_t *>(tuple.GetData() + col.GetOffset());
+          break;
+        case TypeId::INTEGER:
+          value = *reinterpret_cast<const int32_t *>(tuple.GetData() + col.GetOffset());
+          break;
+        default:
+          value = *reinterpret_cast<const int64_t *>(tuple.GetData() + col.GetOffset());
+          break;
+      }
+      // Flipping the sign bit maps [min, max] of the type onto [0, 2^bits) in order.
+      uint64_t biased = static_cast<uint64_t>(value) ^ (uint64_t{1} << (bits - 1));
+      if (bits < 64) {
+        biased &= (uint64_t{1} << bits) - 1;
+        data_ = (data_ << bits) | biased;
+      } else {
+        data_ = biased;
+      }
+    }
+  }
+
+  /** @return the value of column column_idx of key_schema, unpacked from the key */
+  inline auto ToValue(Schema *key_schema, uint32_t column_idx) const -> Value {
+    uint32_t shift = 0;
+    for (uint32_t i = key_schema->GetColumnCount() - 1; i > column_idx; i--) {
+      shift += key_schema->GetColumn(i).GetFixedLength() * 8;
+    }
+    const auto &col = key_schema->GetColumn(column_idx);
+    uint32_t bits = col.GetFixedLength() * 8;
+    uint64_t biased = bits < 64 ? (data_ >> shift) & ((uint64_t{1} << bits) - 1) : data_;
+    // Flipping the sign bit back, then shifting it to the top and back sign-extends the column.
+    auto value = static_cast<int64_t>((biased ^ (uint64_t{1} << (bits - 1))) << (64 - bits)) >> (64 - bits);
+    switch (col.GetType()) {
+      case TypeId::TINYINT:
+        return {TypeId::TINYINT, static_cast<int8_t>(value)};
+      case TypeId::SMALLINT:
+        return {TypeId::SMALLINT, static_cast<int16_t>(value)};
+      case TypeId::INTEGER:
+        return {TypeId::INTEGER, static_cast<int32_t>(value)};
+      default:
+        return {TypeId::BIGINT, value};
+    }
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) { data_ = static_cast<uint64_t>(key) ^ (uint64_t{1} << 63); }
+
+  // NOTE: for test purpose only
+  // interpret the key as a single BIGINT column
+  inline auto ToString() const -> int64_t { return static_cast<int64_t>(data_ ^ (uint64_t{1} << 63)); }
+
+  // NOTE: for test purpose only
+  friend auto operator<<(std::ostream &os, const PackedIntegerKey &key) -> std::ostream & {
+    os << key.ToString();
+    return os;
+  }
+
+  uint64_t data_;
+};
+
+/**
+ * Function object returns the order of two packed integer keys, without looking at the key schema.
+ */
+class PackedIntegerComparator {
+ public:
+  inline auto operator()(const PackedIntegerKey &lhs, const PackedIntegerKey &rhs) const -> int {
+    return lhs.data_ < rhs.data_ ? -1 : (lhs.data_ > rhs.data_ ? 1 : 0);
+  }
+
+  // constructor, the key schema is only needed to build keys
+  explicit PackedIntegerComparator(Schema * /* key_schema */) {}
+};
+
+}  // namespace bustub
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// packed_key_search.h
+//
+// Identification: src/include/storage/index/packed_key_search.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Lower-bound search over the packed integer keys of a B+ tree page, which are stored contiguously.
+ *
+ * The search halves the range until a few vectors of keys are left, then compares the key against all of them at
+ * once with AVX2 (or SSE4.2) and counts the smaller ones, instead of taking the last, hard to predict branches. The
+ * instruction set is picked once at startup from what the CPU supports, with a scalar fallback.
+ *
+ * @param keys n keys sorted in increasing order
+ * @return the number of keys less than key, that is the index of the first key not less than key
+ */
+auto CountKeysLess(const uint64_t *keys, size_t n, uint64_t key) -> size_t;
+
+/** @return the number of keys less than or equal to key, among n keys sorted in increasing order */
+inline auto CountKeysLessEqual(const uint64_t *keys, size_t n, uint64_t key) -> size_t {
+  return key == UINT64_MAX ? n : CountKeysLess(keys, n, key + 1);
+}
+
+/** Same result as CountKeysLess, using plain binary search. */
+auto CountKeysLessScalar(const uint64_t *keys, size_t n, uint64_t key) -> size_t;
+
+}  // namespace bustub
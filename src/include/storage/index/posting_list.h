@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.h
+//
+// Identification: src/include/storage/index/posting_list.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+/**
+ * The RIDs of a key that has more than one in a non-unique B+ tree, kept in a chain of posting pages (see
+ * BPlusTreePostingPage) in RID order.
+ *
+ * The leaf entry of such a key holds a reference to the first page of the chain instead of a RID. A key with a single
+ * RID keeps it in the leaf. The pages of a list are only reached through its leaf entry, so the latch on the leaf
+ * protects them: readers of a list hold the leaf read latched, and writers write latched.
+ */
+class PostingList {
+ public:
+  /** Slot number that marks a leaf value as a reference to a posting list, no table page has that many slots. */
+  static constexpr uint32_t REFERENCE_SLOT = UINT32_MAX;
+
+  /** @return true if the leaf value refers to a posting list instead of being a RID */
+  static auto IsReference(const RID &value) -> bool { return value.GetSlotNum() == REFERENCE_SLOT; }
+
+  /** @return the leaf value that refers to the posting list starting at head_page_id */
+  static auto MakeReference(page_id_t head_page_id) -> RID { return {head_page_id, REFERENCE_SLOT}; }
+
+  /** @return the first page of the posting list the leaf value refers to */
+  static auto HeadPageId(const RID &value) -> page_id_t { return value.GetPageId(); }
+
+  /**
+   * Build a posting list.
+   * @param rids at least two RIDs, sorted and without duplicates
+   * @return the first page of the list
+   */
+  static auto Create(BufferPoolManager *bpm, const std::vector<RID> &rids) -> page_id_t;
+
+  /** @return false if rid is already in the list */
+  static auto Insert(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool;
+
+  /** @return false if rid is not in the list */
+  static auto Remove(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool;
+
+  /** @return the number of RIDs in the list */
+  static auto Size(BufferPoolManager *bpm, page_id_t head_page_id) -> size_t;
+
+  /** Append the RIDs of the list to rids, in order. */
+  static void Read(BufferPoolManager *bpm, page_id_t head_page_id, std::vector<RID> *rids);
+
+  /**
+   * Append the RIDs of one page of a list to rids, to read a long list a page at a time.
+   * @return the next page of the list, INVALID_PAGE_ID after the last
+   */
+  static auto ReadPage(BufferPoolManager *bpm, page_id_t page_id, std::vector<RID> *rids) -> page_id_t;
+
+  /** Delete the pages of the list. */
+  static void Drop(BufferPoolManager *bpm, page_id_t head_page_id);
+};
+
+}  // namespace bustub
@@ -0,0 +1,336 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_compressed_entries.h
+//
+// Identification: src/include/storage/page/b_plus_tree_compressed_entries.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Entries of a B+ tree page in a slotted, prefix-compressed format, for fixed-size keys that compare like their bytes
+ * (see NormalizedKey) and are zero-padded.
+ *
+ * A key is stored without its trailing zero bytes, so a short string in a wide key only takes its own length. Keys
+ * that start with the common prefix of the page store only the bytes after it. The prefix is chosen when the entries
+ * are rebuilt (on splits and merges), as the one that saves the most bytes; keys inserted later that do not start
+ * with it are stored whole.
+ *
+ * Area format (the key bytes grow down from the prefix, at the end of the area):
+ *  -------------------------------------------------------------------------------
+ * | HEADER (8) | SLOT(1) | SLOT(2) | ... | SLOT(n) | free | ... KEY BYTES | PREFIX |
+ *  -------------------------------------------------------------------------------
+ *  Slot format:
+ *  ---------------------------------------------------------------
+ * | Value | KeyOffset (2) | KeyLength (1) | SharesPrefix (1) |
+ *  ---------------------------------------------------------------
+ *
+ * The size of the page is kept in the page header, so the methods take it as an argument.
+ */
+template <typename KeyType, typename ValueType, size_t AreaSize>
+class CompressedEntries {
+  static_assert(sizeof(KeyType) <= UINT8_MAX && AreaSize <= UINT16_MAX, "offsets and lengths must fit their fields");
+
+  struct Slot {
+    ValueType value_;
+    uint16_t offset_;
+    uint8_t length_;
+    uint8_t shares_prefix_;
+  };
+
+  struct Header {
+    uint16_t prefix_length_;
+    /** Start of the key bytes, which grow down toward the slots. */
+    uint16_t heap_begin_;
+    /** Live key bytes, including the prefix. Removed keys leave garbage until the key bytes are compacted. */
+    uint16_t heap_bytes_;
+    uint16_t reserved_;
+  };
+
+ public:
+  using EntryType = std::pair<KeyType, ValueType>;
+
+  /** Bytes that a slot takes on top of its key bytes. */
+  static constexpr size_t SLOT_SIZE = sizeof(Slot);
+
+  /**
+   * Bytes a page may use when no insert is under way. The rest of the area leaves room for one more entry of any
+   * length, so an insert always fits, and a page that goes over the budget is split right after.
+   */
+  static constexpr size_t BUDGET = AreaSize - sizeof(Header) - SLOT_SIZE - sizeof(KeyType);
+
+  /** The most entries an area can hold, if all their keys are stored in the prefix. */
+  static constexpr int MAX_ENTRIES = static_cast<int>((AreaSize - sizeof(Header)) / SLOT_SIZE) - 1;
+
+  CompressedEntries() = delete;
+  CompressedEntries(const CompressedEntries &other) = delete;
+  ~CompressedEntries() = delete;
+
+  /** Remove every entry and the prefix. */
+  void Reset() {
+    header_.prefix_length_ = 0;
+    header_.heap_begin_ = AreaSize;
+    header_.heap_bytes_ = 0;
+  }
+
+  /** @return the bytes used by size entries, not counting garbage */
+  auto UsedBytes(int size) const -> size_t { return sizeof(Header) + size * SLOT_SIZE + header_.heap_bytes_; }
+
+  /** @return the bytes the entry at index takes */
+  auto EntryBytes(int index) const -> size_t { return SLOT_SIZE + slots_[index].length_; }
+
+  /** @return the bytes key would take if inserted now */
+  auto InsertBytes(const KeyType &key) const -> size_t {
+    return SLOT_SIZE + (SharesPrefix(key) ? StoredLength(key.data_, PrefixLength()) : StoredLength(key.data_, 0));
+  }
+
+  /**
+   * @return about the bytes key takes in a page after prev, if the page prefix covers what the two keys share. Used
+   * to size pages before building them.
+   */
+  static auto EstimateBytes(const KeyType &prev, const KeyType &key) -> size_t {
+    size_t common = 0;
+    while (common < sizeof(KeyType) && prev.data_[common] == key.data_[common]) {
+      common++;
+    }
+    return SLOT_SIZE + StoredLength(key.data_, std::min(common, StoredLength(key.data_, 0)));
+  }
+
+  auto KeyAt(int index) const -> KeyType {
+    KeyType key;
+    memset(key.data_, 0, sizeof(KeyType));
+    const Slot &slot = slots_[index];
+    size_t pos = 0;
+    if (slot.shares_prefix_ != 0) {
+      memcpy(key.data_, Prefix(), PrefixLength());
+      pos = PrefixLength();
+    }
+    memcpy(key.data_ + pos, Data() + slot.offset_, slot.length_);
+    return key;
+  }
+
+  auto ValueAt(int index) const -> ValueType { return slots_[index].value_; }
+  void SetValueAt(int index, const ValueType &value) { slots_[index].value_ = value; }
+
+  /** @return the first index in [begin, end) whose key is not less than key, or end */
+  auto LowerBound(const KeyType &key, int begin, int end) const -> int {
+    int prefix_cmp = ComparePrefix(key);
+    while (begin < end) {
+      int mid = (begin + end) / 2;
+      if (Compare(key, prefix_cmp, mid) > 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  /** @return the first index in [begin, end) whose key is greater than key, or end */
+  auto UpperBound(const KeyType &key, int begin, int end) const -> int {
+    int prefix_cmp = ComparePrefix(key);
+    while (begin < end) {
+      int mid = (begin + end) / 2;
+      if (Compare(key, prefix_cmp, mid) >= 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  /** Insert key and value at index of the size entries. The caller makes sure the page is within its budget. */
+  void Insert(int index, const KeyType &key, const ValueType &value, int size) {
+    bool shares_prefix = SharesPrefix(key);
+    size_t skip = shares_prefix ? PrefixLength() : 0;
+    size_t length = StoredLength(key.data_, skip);
+    if (header_.heap_begin_ < sizeof(Header) + (size + 1) * SLOT_SIZE + length) {
+      Compact(size);
+    }
+    BUSTUB_ASSERT(header_.heap_begin_ >= sizeof(Header) + (size + 1) * SLOT_SIZE + length, "page overflow");
+    header_.heap_begin_ -= length;
+    header_.heap_bytes_ += length;
+    memcpy(Data() + header_.heap_begin_, key.data_ + skip, length);
+    memmove(static_cast<void *>(&slots_[index + 1]), &slots_[index], (size - index) * SLOT_SIZE);
+    slots_[index] = {value, header_.heap_begin_, static_cast<uint8_t>(length), static_cast<uint8_t>(shares_prefix)};
+  }
+
+  /** Remove the entry at index of the size entries. */
+  void Remove(int index, int size) {
+    header_.heap_bytes_ -= slots_[index].length_;
+    memmove(static_cast<void *>(&slots_[index]), &slots_[index + 1], (size - index - 1) * SLOT_SIZE);
+  }
+
+  /** @return entries [begin, end), decoded */
+  auto Decode(int begin, int end) const -> std::vector<EntryType> {
+    std::vector<EntryType> entries;
+    entries.reserve(end - begin);
+    for (int i = begin; i < end; i++) {
+      entries.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    return entries;
+  }
+
+  /** Replace all entries by entries, which are sorted, with the prefix that saves the most bytes for them. */
+  void Rebuild(const std::vector<EntryType> &entries) { Rebuild(entries.data(), entries.size()); }
+
+  void Rebuild(const EntryType *entries, size_t n) {
+    auto [anchor, prefix_length] = ChoosePrefix(entries, n);
+    Reset();
+    header_.prefix_length_ = prefix_length;
+    header_.heap_begin_ = AreaSize - prefix_length;
+    header_.heap_bytes_ = prefix_length;
+    if (prefix_length > 0) {
+      memcpy(Data() + header_.heap_begin_, entries[anchor].first.data_, prefix_length);
+    }
+    for (size_t i = 0; i < n; i++) {
+      Insert(static_cast<int>(i), entries[i].first, entries[i].second, static_cast<int>(i));
+    }
+  }
+
+  /** @return the bytes used after Rebuild(entries) */
+  static auto RebuiltBytes(const std::vector<EntryType> &entries) -> size_t {
+    return RebuiltBytes(entries.data(), entries.size());
+  }
+
+  static auto RebuiltBytes(const EntryType *entries, size_t n) -> size_t {
+    auto [anchor, prefix_length] = ChoosePrefix(entries, n);
+    size_t bytes = sizeof(Header) + prefix_length;
+    for (size_t i = 0; i < n; i++) {
+      const char *key = entries[i].first.data_;
+      bool shares_prefix = prefix_length > 0 && memcmp(key, entries[anchor].first.data_, prefix_length) == 0;
+      bytes += SLOT_SIZE + StoredLength(key, shares_prefix ? prefix_length : 0);
+    }
+    return bytes;
+  }
+
+ private:
+  auto Data() -> char * { return reinterpret_cast<char *>(this); }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this); }
+  auto PrefixLength() const -> size_t { return header_.prefix_length_; }
+  auto Prefix() const -> const char * { return Data() + AreaSize - PrefixLength(); }
+
+  auto SharesPrefix(const KeyType &key) const -> bool {
+    return PrefixLength() > 0 && memcmp(key.data_, Prefix(), PrefixLength()) == 0;
+  }
+
+  /** @return the length of key after skip bytes, without its trailing zeros */
+  static auto StoredLength(const char *key, size_t skip) -> size_t {
+    size_t length = sizeof(KeyType);
+    while (length > skip && key[length - 1] == 0) {
+      length--;
+    }
+    return length - skip;
+  }
+
+  auto ComparePrefix(const KeyType &key) const -> int {
+    int cmp = memcmp(key.data_, Prefix(), PrefixLength());
+    return (cmp > 0) - (cmp < 0);
+  }
+
+  /** @return the order of key and the key at index, given the order of key and the prefix */
+  auto Compare(const KeyType &key, int prefix_cmp, int index) const -> int {
+    const Slot &slot = slots_[index];
+    size_t skip = 0;
+    if (slot.shares_prefix_ != 0) {
+      if (prefix_cmp != 0) {
+        return prefix_cmp;
+      }
+      skip = PrefixLength();
+    }
+    int cmp = memcmp(key.data_ + skip, Data() + slot.offset_, slot.length_);
+    if (cmp != 0) {
+      return (cmp > 0) - (cmp < 0);
+    }
+    // the stored key continues with zeros
+    for (size_t i = skip + slot.length_; i < sizeof(KeyType); i++) {
+      if (key.data_[i] != 0) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  /** Move the live key bytes together at the end of the area, reclaiming the garbage of removed keys. */
+  void Compact(int size) {
+    std::array<char, AreaSize> buffer;
+    size_t heap_begin = AreaSize - PrefixLength();
+    memcpy(buffer.data() + heap_begin, Prefix(), PrefixLength());
+    for (int i = 0; i < size; i++) {
+      heap_begin -= slots_[i].length_;
+      memcpy(buffer.data() + heap_begin, Data() + slots_[i].offset_, slots_[i].length_);
+      slots_[i].offset_ = heap_begin;
+    }
+    memcpy(Data() + heap_begin, buffer.data() + heap_begin, AreaSize - heap_begin);
+    header_.heap_begin_ = heap_begin;
+  }
+
+  /**
+   * Pick the prefix that saves the most bytes: for every length, the keys that share that many first bytes form runs
+   * of neighbours, and a run saves the bytes its keys would store in the prefix, minus the prefix itself.
+   * @return the index of a key that starts with the prefix, and the length of the prefix
+   */
+  static auto ChoosePrefix(const EntryType *entries, size_t n) -> std::pair<size_t, size_t> {
+    if (n < 2) {
+      return {0, 0};
+    }
+    std::vector<size_t> lengths(n);
+    std::vector<size_t> common(n - 1);
+    for (size_t i = 0; i < n; i++) {
+      lengths[i] = StoredLength(entries[i].first.data_, 0);
+      if (i + 1 < n) {
+        const char *lhs = entries[i].first.data_;
+        const char *rhs = entries[i + 1].first.data_;
+        size_t j = 0;
+        while (j < sizeof(KeyType) && lhs[j] == rhs[j]) {
+          j++;
+        }
+        common[i] = j;
+      }
+    }
+    size_t best_anchor = 0;
+    size_t best_length = 0;
+    size_t best_saving = 0;
+    for (size_t length = 1; length <= sizeof(KeyType); length++) {
+      size_t begin = 0;
+      while (begin < n) {
+        size_t end = begin + 1;
+        size_t saving = std::min(lengths[begin], length);
+        while (end < n && common[end - 1] >= length) {
+          saving += std::min(lengths[end], length);
+          end++;
+        }
+        if (end - begin > 1 && saving > length && saving - length > best_saving) {
+          best_anchor = begin;
+          best_length = length;
+          best_saving = saving - length;
+        }
+        begin = end;
+      }
+    }
+    return {best_anchor, best_length};
+  }
+
+  Header header_;
+  // Flexible array member for the slots.
+  Slot slots_[0];
+};
+
+}  // namespace bustub
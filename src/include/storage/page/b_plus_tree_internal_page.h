@@ -13,12 +13,13 @@
 #include <queue>
 #include <string>
 
+#include "storage/page/b_plus_tree_compressed_entries.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 12
+#define INTERNAL_PAGE_HEADER_SIZE (16 + sizeof(KeyType))
 #define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
@@ -28,10 +29,29 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
+ * Like leaves, the internal pages of a level are linked left to right. A page
+ * with a right page also has a high key that its keys are less than, and that
+ * the keys of the right page are not less than.
+ *
+ * Header format (size in byte, 16 bytes plus the size of a key in total):
+ *  ------------------------------------------------------------------------
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | RightPageId (4) | HighKey |
+ *  ------------------------------------------------------------------------
+ *
  * Internal page format (keys are stored in increasing order):
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * For key types with SeparateKeys, the keys are stored contiguously instead,
+ * followed by the page ids at a fixed offset:
+ *  --------------------------------------------------------------------------
+ * | HEADER | KEY(1) | ... | KEY(n) | ... | PAGE_ID(1) | ... | PAGE_ID(n) |
+ *  --------------------------------------------------------------------------
+ *
+ * For key types with CompressKeys, the entries are stored in the slotted,
+ * prefix-compressed format of CompressedEntries, and the page is full when
+ * its bytes run out rather than when it reaches max size.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -75,6 +95,68 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void SetValueAt(int index, const ValueType &value);
 
+  auto GetRightPageId() const -> page_id_t { return right_page_id_; }
+  void SetRightPageId(page_id_t right_page_id) { right_page_id_ = right_page_id; }
+  /** Only valid if the page has a right page. */
+  auto HighKey() const -> KeyType { return high_key_; }
+  void SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
+  /**
+   * @return the index of the child whose subtree may contain key, that is the
+   * last index whose key is not greater than key, or 0
+   */
+  auto ChildIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /**
+   * Insert key and value at index, shifting the entries from index on to the right
+   */
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+
+  /**
+   * Remove the entry at index, shifting the entries after it to the left
+   */
+  void RemoveAt(int index);
+
+  /**
+   * Move the entries from index from to the end of this page onto the end of
+   * recipient
+   */
+  void MoveTailTo(BPlusTreeInternalPage *recipient, int from);
+
+  /** @return true if inserting any entry leaves the page within its capacity */
+  auto IsInsertSafe() const -> bool;
+  /** @return true if removing any entry leaves the page at least half full */
+  auto IsRemoveSafe() const -> bool;
+  /** @return true if the page is over its capacity and must be split */
+  auto IsOverflow() const -> bool;
+  /** @return true if the page is less than half full */
+  auto IsUnderflow() const -> bool;
+  /** @return true if an entry at either end can move to a sibling, leaving the page at least half full */
+  auto CanLend() const -> bool;
+  /** @return the index the page is split at, so that both halves are about as full */
+  auto SplitIndex() const -> int;
+  /** @return true if the entries of other fit into this page */
+  auto CanMergeWith(const BPlusTreeInternalPage *other) const -> bool;
+  /** @return true if the key at index can be replaced by key, leaving the page within its capacity */
+  auto CanSetKeyAt(int index, const KeyType &key) const -> bool;
+
+  /** @return the max size of a page initialized with max_size */
+  static auto EffectiveMaxSize(int max_size) -> int;
+
+  /**
+   * Fill the empty page with the first of n sorted entries, as many as fit.
+   * @return the number of entries the page took, at least one
+   */
+  auto LoadEntries(const MappingType *entries, int n) -> int;
+
+  /**
+   * @return about how much of a page's capacity an entry with key takes when it follows prev in a page that is built,
+   * see LoadCapacity
+   */
+  static auto LoadUnits(const KeyType &prev, const KeyType &key) -> size_t;
+  /** @return the capacity of a page with max_size in the units of LoadUnits */
+  static auto LoadCapacity(int max_size) -> size_t;
+
   /**
    * @brief For test only, return a string representing all keys in
    * this internal page, formatted as "(key1,key2,key3,...)"
@@ -102,6 +184,40 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
+  static constexpr bool SEPARATE_KEYS = SeparateKeys<KeyType>::value;
+  static constexpr bool COMPRESS_KEYS = CompressKeys<KeyType>::value;
+  using Entries = CompressedEntries<KeyType, ValueType, BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE>;
+
+  auto Compressed() -> Entries * { return reinterpret_cast<Entries *>(array_); }
+  auto Compressed() const -> const Entries * { return reinterpret_cast<const Entries *>(array_); }
+
+  auto KeySlot(int index) -> KeyType & {
+    if constexpr (SEPARATE_KEYS) {
+      return reinterpret_cast<KeyType *>(array_)[index];
+    } else {
+      return array_[index].first;
+    }
+  }
+  auto KeySlot(int index) const -> const KeyType & {
+    return const_cast<BPlusTreeInternalPage *>(this)->KeySlot(index);
+  }
+  auto ValueSlot(int index) -> ValueType & {
+    if constexpr (SEPARATE_KEYS) {
+      return reinterpret_cast<ValueType *>(reinterpret_cast<KeyType *>(array_) + INTERNAL_PAGE_SIZE)[index];
+    } else {
+      return array_[index].second;
+    }
+  }
+  auto ValueSlot(int index) const -> const ValueType & {
+    return const_cast<BPlusTreeInternalPage *>(this)->ValueSlot(index);
+  }
+
+  /** Copy n entries of source starting at source_index to dest_index of dest, the ranges may overlap. */
+  static void MoveEntries(BPlusTreeInternalPage *dest, int dest_index, BPlusTreeInternalPage *source,
+                          int source_index, int n);
+
+  page_id_t right_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -14,30 +14,49 @@
 #include <utility>
 #include <vector>
 
+#include "storage/page/b_plus_tree_compressed_entries.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
+#define LEAF_PAGE_HEADER_SIZE (16 + sizeof(KeyType))
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Every key appears once in a leaf. In a non-unique tree, the value of a
+ * key with more than one RID is a reference to a posting list instead: a RID
+ * whose page id is the first page of the list and whose slot number is
+ * PostingList::REFERENCE_SLOT. The list holds the RIDs of the key, sorted and
+ * delta-encoded, in a chain of BPlusTreePostingPage.
+ *
+ * Leaves are linked left to right by their next page id. A leaf with a next
+ * page also has a high key: its own keys are less than it, and the keys of the
+ * next page are not.
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ * For key types with SeparateKeys, the keys are stored contiguously instead,
+ * followed by the values at a fixed offset:
+ *  ----------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | ... | RID(1) | ... | RID(n)
+ *  ----------------------------------------------------------------------
+ *
+ * For key types with CompressKeys, the entries are stored in the slotted,
+ * prefix-compressed format of CompressedEntries, and the page is full when
+ * its bytes run out rather than when it reaches max size.
+ *
+ *  Header format (size in byte, 16 bytes plus the size of a key in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
- * |  NextPageId (4)
+ * |  NextPageId (4) | HighKey (sizeof(KeyType))
  *  -----------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
@@ -57,9 +76,67 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  /** Only valid if the page has a next page. */
+  auto HighKey() const -> KeyType { return high_key_; }
+  void SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
-  auto PairAt(int index) const -> const MappingType &;
+  void SetValueAt(int index, const ValueType &value);
+  auto PairAt(int index) const -> MappingType;
+
+  /**
+   * @return the index of the first key that is not less than key, or GetSize()
+   * if every key is less
+   */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /**
+   * Insert key and value at index, shifting the entries from index on to the right
+   */
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+
+  /**
+   * Remove the entry at index, shifting the entries after it to the left
+   */
+  void RemoveAt(int index);
+
+  /**
+   * Move the entries from index from to the end of this page onto the end of
+   * recipient
+   */
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int from);
+
+  /** @return true if inserting any entry leaves the page within its capacity */
+  auto IsInsertSafe() const -> bool;
+  /** @return true if removing any entry leaves the page at least half full */
+  auto IsRemoveSafe() const -> bool;
+  /** @return true if the page is over its capacity and must be split */
+  auto IsOverflow() const -> bool;
+  /** @return true if the page is less than half full */
+  auto IsUnderflow() const -> bool;
+  /** @return true if an entry at either end can move to a sibling, leaving the page at least half full */
+  auto CanLend() const -> bool;
+  /** @return the index the page is split at, so that both halves are about as full */
+  auto SplitIndex() const -> int;
+  /** @return true if the entries of other fit into this page */
+  auto CanMergeWith(const BPlusTreeLeafPage *other) const -> bool;
+
+  /** @return the max size of a page initialized with max_size */
+  static auto EffectiveMaxSize(int max_size) -> int;
+
+  /**
+   * Fill the empty page with the first of n sorted entries, as many as fit.
+   * @return the number of entries the page took, at least one
+   */
+  auto LoadEntries(const MappingType *entries, int n) -> int;
+
+  /**
+   * @return about how much of a page's capacity an entry with key takes when it follows prev in a page that is built,
+   * see LoadCapacity
+   */
+  static auto LoadUnits(const KeyType &prev, const KeyType &key) -> size_t;
+  /** @return the capacity of a page with max_size in the units of LoadUnits */
+  static auto LoadCapacity(int max_size) -> size_t;
 
   /**
    * @brief for test only return a string representing all keys in
@@ -87,7 +164,38 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   }
 
  private:
+  static constexpr bool SEPARATE_KEYS = SeparateKeys<KeyType>::value;
+  static constexpr bool COMPRESS_KEYS = CompressKeys<KeyType>::value;
+  using Entries = CompressedEntries<KeyType, ValueType, BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE>;
+
+  auto Compressed() -> Entries * { return reinterpret_cast<Entries *>(array_); }
+  auto Compressed() const -> const Entries * { return reinterpret_cast<const Entries *>(array_); }
+
+  auto KeySlot(int index) -> KeyType & {
+    if constexpr (SEPARATE_KEYS) {
+      return reinterpret_cast<KeyType *>(array_)[index];
+    } else {
+      return array_[index].first;
+    }
+  }
+  auto KeySlot(int index) const -> const KeyType & { return const_cast<BPlusTreeLeafPage *>(this)->KeySlot(index); }
+  auto ValueSlot(int index) -> ValueType & {
+    if constexpr (SEPARATE_KEYS) {
+      return reinterpret_cast<ValueType *>(reinterpret_cast<KeyType *>(array_) + LEAF_PAGE_SIZE)[index];
+    } else {
+      return array_[index].second;
+    }
+  }
+  auto ValueSlot(int index) const -> const ValueType & {
+    return const_cast<BPlusTreeLeafPage *>(this)->ValueSlot(index);
+  }
+
+  /** Copy n entries of source starting at source_index to dest_index of dest, the ranges may overlap. */
+  static void MoveEntries(BPlusTreeLeafPage *dest, int dest_index, BPlusTreeLeafPage *source, int source_index,
+                          int n);
+
   page_id_t next_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -10,13 +10,18 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "storage/index/packed_integer_key.h"
 
 namespace bustub {
 
@@ -24,6 +29,53 @@ namespace bustub {
 
 #define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
 
+/**
+ * Whether B+ tree pages store the keys of KeyType in their own array, ahead of the values, instead of next to them.
+ *
+ * Keeping the keys contiguous packs more of them into each cache line a search touches, and lets packed integer keys
+ * be compared a vector at a time. Packed integer keys use it; generic keys keep key/value pairs.
+ */
+template <typename KeyType>
+struct SeparateKeys : std::false_type {};
+
+template <>
+struct SeparateKeys<PackedIntegerKey> : std::true_type {};
+
+/**
+ * Whether B+ tree pages store the keys of KeyType prefix-compressed and variable-length (see CompressedEntries).
+ *
+ * Only keys that are compared by their bytes qualify. Nodes then fill by bytes rather than by entries, so short and
+ * common-prefix keys give a higher fanout.
+ */
+template <typename KeyType>
+struct CompressKeys : std::false_type {};
+
+template <size_t KeySize>
+struct CompressKeys<NormalizedKey<KeySize>> : std::true_type {};
+
+/**
+ * @return a key that is greater than left and not greater than right, used as the separator between two nodes whose
+ * keys are up to left and from right. Keys that compare by their bytes use the shortest such prefix of right.
+ */
+template <typename KeyType>
+auto ShortestSeparator(const KeyType &left, const KeyType &right) -> KeyType {
+  return right;
+}
+
+template <size_t KeySize>
+auto ShortestSeparator(const NormalizedKey<KeySize> &left, const NormalizedKey<KeySize> &right)
+    -> NormalizedKey<KeySize> {
+  size_t common = 0;
+  while (common < KeySize && left.data_[common] == right.data_[common]) {
+    common++;
+  }
+  // right is greater than left at its first different byte, so the bytes up to it are enough
+  NormalizedKey<KeySize> separator;
+  memset(separator.data_, 0, KeySize);
+  memcpy(separator.data_, right.data_, std::min(common + 1, KeySize));
+  return separator;
+}
+
 // define page type enum
 enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
 
@@ -48,6 +100,13 @@ class BPlusTreePage {
   auto IsLeafPage() const -> bool;
   void SetPageType(IndexPageType page_type);
 
+  /**
+   * A page that a merge or a root change took out of the tree stays until no one has it pinned. Searches that still
+   * reach it see it as deleted and start over.
+   */
+  auto IsDeleted() const -> bool;
+  void SetDeleted();
+
   auto GetSize() const -> int;
   void SetSize(int size);
   void IncreaseSize(int amount);
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 40
+#define POSTING_PAGE_DATA_SIZE (BUSTUB_PAGE_SIZE - POSTING_PAGE_HEADER_SIZE)
+
+/**
+ * A page of the posting list of a key in a non-unique B+ tree: the RIDs of the key, sorted and delta-encoded.
+ *
+ * The list is a chain of pages, each holding a range of the RIDs. A page stores its first RID whole, then the
+ * difference of every other RID to the one before it as a varint, so RIDs of neighbouring tuples take a byte or two.
+ * The first page of the chain also keeps the last page and the number of RIDs of the whole list.
+ *
+ * Header format (size in byte, 40 bytes in total):
+ *  ---------------------------------------------------------------------------
+ * | NextPageId (4) | TailPageId (4) | TotalSize (4) | Size (4) | Bytes (4) |
+ *  ---------------------------------------------------------------------------
+ *  ----------------------------------------------------
+ * | Reserved (4) | FirstRid (8) | LastRid (8) | DELTAS |
+ *  ----------------------------------------------------
+ */
+class BPlusTreePostingPage {
+ public:
+  BPlusTreePostingPage() = delete;
+  BPlusTreePostingPage(const BPlusTreePostingPage &other) = delete;
+  ~BPlusTreePostingPage() = delete;
+
+  /** Make the page an empty list of its own. */
+  void Init();
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /** Only kept up to date on the first page of a chain. */
+  auto GetTailPageId() const -> page_id_t { return tail_page_id_; }
+  void SetTailPageId(page_id_t tail_page_id) { tail_page_id_ = tail_page_id; }
+  auto GetTotalSize() const -> uint32_t { return total_size_; }
+  void SetTotalSize(uint32_t total_size) { total_size_ = total_size; }
+
+  /** @return the number of RIDs on this page */
+  auto GetSize() const -> uint32_t { return size_; }
+  auto FirstRid() const -> RID { return RID(static_cast<int64_t>(first_rid_)); }
+  auto LastRid() const -> RID { return RID(static_cast<int64_t>(last_rid_)); }
+
+  /** Append the RIDs of the page to rids. */
+  void Decode(std::vector<RID> *rids) const;
+
+  /**
+   * Replace the RIDs of the page by the n sorted RIDs at rids.
+   * @return false, leaving the page as it was, if they do not fit
+   */
+  auto Encode(const RID *rids, size_t n) -> bool;
+
+  /**
+   * Add rid after the RIDs of the page, which are all less than it.
+   * @return false if it does not fit
+   */
+  auto Append(const RID &rid) -> bool;
+
+  /** @return the bytes that n sorted RIDs at rids take on a page, not counting the header */
+  static auto EncodedBytes(const RID *rids, size_t n) -> size_t;
+
+  /** @return RIDs as numbers in the order of the posting lists */
+  static auto Order(const RID &rid) -> uint64_t { return static_cast<uint64_t>(rid.Get()); }
+
+ private:
+  page_id_t next_page_id_;
+  page_id_t tail_page_id_;
+  uint32_t total_size_;
+  uint32_t size_;
+  uint32_t bytes_;
+  uint32_t reserved_;
+  uint64_t first_rid_;
+  uint64_t last_rid_;
+  uint8_t data_[POSTING_PAGE_DATA_SIZE];
+};
+
+static_assert(sizeof(BPlusTreePostingPage) == BUSTUB_PAGE_SIZE);
+
+}  // namespace bustub
@@ -33,6 +33,8 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ * Pairs that do not fit into a bucket and that no split can separate go to overflow pages, which are bucket pages
+ * chained to it through their next page ids.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -40,6 +42,11 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * Initialize a new bucket page: empty, with no next overflow page.
+   */
+  void Init();
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
@@ -132,12 +139,28 @@ class HashTableBucketPage {
    */
   auto IsEmpty() -> bool;
 
+  /**
+   * Empty the bucket, forgetting its tombstones too, so that it can be refilled from scratch after a split.
+   */
+  void Clear();
+
+  /**
+   * @return the page id of the next overflow page of the bucket, INVALID_PAGE_ID if there is none
+   */
+  auto GetNextPageId() const -> page_id_t;
+
+  /**
+   * @param next_page_id the page id of the next overflow page of the bucket
+   */
+  void SetNextPageId(page_id_t next_page_id);
+
   /**
    * Prints the bucket's occupancy information
    */
   void PrintBucket();
 
  private:
+  page_id_t next_page_id_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
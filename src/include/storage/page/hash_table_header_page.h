@@ -26,15 +26,25 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
+ * Header format (size in byte, 32 bytes in total with padding), followed by the block page ids:
  * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
+ * | LSN (4) | Size (8) | PageId(4) | NextBlockIndex(8)
  * -------------------------------------------------------------
  */
 class HashTableHeaderPage {
  public:
+  /** The number of block page ids that fit after the fixed fields. */
+  static constexpr size_t MAX_BLOCKS = (BUSTUB_PAGE_SIZE - 4 * sizeof(size_t)) / sizeof(page_id_t);
+
+  /**
+   * Initializes an empty header page.
+   *
+   * @param page_id the page id of this page
+   */
+  void Init(page_id_t page_id);
+
   /**
-   * @return the number of buckets in the hash table;
+   * @return the number of slots in the hash table
    */
   auto GetSize() const -> size_t;
 
@@ -82,20 +92,20 @@ class HashTableHeaderPage {
    * @param index the index of the block
    * @return the page_id for the block.
    */
-  auto GetBlockPageId(size_t index) -> page_id_t;
+  auto GetBlockPageId(size_t index) const -> page_id_t;
 
   /**
    * @return the number of blocks currently stored in the header page
    */
-  auto NumBlocks() -> size_t;
+  auto NumBlocks() const -> size_t;
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
   // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  page_id_t block_page_ids_[1];
 };
 
 }  // namespace bustub
@@ -35,10 +35,10 @@
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hash index bucket page.
- * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
- * of search, insertion, removal, and helper methods.
+ * The computation is the same as the above BLOCK_ARRAY_SIZE, minus the page id of the next overflow page, but blocks
+ * and buckets have different implementations of search, insertion, removal, and helper methods.
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (BUSTUB_PAGE_SIZE - sizeof(page_id_t)) / (4 * sizeof(MappingType) + 1))
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
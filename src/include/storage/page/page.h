@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -20,6 +21,14 @@
 
 namespace bustub {
 
+/**
+ * A swip is an in-memory reference to a page. While the page is swizzled (see BufferPoolManager::SwizzlePage), the
+ * swip also points at the frame holding it, so that the frame can be reached without the page table. The word holds
+ * the page id in its upper half and the frame index plus one in its lower half, zero means the swip points nowhere.
+ * A swip is only followed after checking that the frame is still swizzled and holds that page.
+ */
+using Swip = std::atomic<uint64_t>;
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
@@ -30,14 +39,11 @@ class Page {
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() {
-    data_ = new char[BUSTUB_PAGE_SIZE];
-    ResetMemory();
-  }
+  /** Constructor. The page has no data until the buffer pool manager gives it a frame of its arena. */
+  Page() = default;
 
-  /** Default destructor. */
-  ~Page() { delete[] data_; }
+  /** Destructor. The data belongs to the arena. */
+  ~Page() { delete[] swips_.load(); }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -60,9 +66,37 @@ class Page {
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page write latch if nobody holds it. @return true if the latch was acquired */
+  inline auto TryWLatch() -> bool { return rwlatch_.TryWLock(); }
+
+  /** Acquire the page read latch if no writer holds it. @return true if the latch was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** @return true while the page is swizzled, it then stays in its frame until it is unswizzled */
+  inline auto IsSwizzled() -> bool { return swizzled_.load(std::memory_order_acquire); }
+
+  /**
+   * Get the swip of a page this page refers to, such as the child of an index page. The swips of a frame live in
+   * memory only, mapped by page id, and are left alone when the frame is reused: a stale swip fails validation.
+   * @param page_id the page referred to
+   * @return the swip for page_id, shared with the other page ids that map to it
+   */
+  inline auto GetSwip(page_id_t page_id) -> Swip * {
+    Swip *swips = swips_.load(std::memory_order_acquire);
+    if (swips == nullptr) {
+      auto *fresh = new Swip[NUM_SWIPS]();
+      if (swips_.compare_exchange_strong(swips, fresh)) {
+        swips = fresh;
+      } else {
+        delete[] fresh;
+      }
+    }
+    return &swips[static_cast<uint32_t>(page_id) % NUM_SWIPS];
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -73,6 +107,7 @@ class Page {
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
 
+  static constexpr size_t NUM_SWIPS = 256;
   static constexpr size_t SIZE_PAGE_HEADER = 8;
   static constexpr size_t OFFSET_PAGE_START = 0;
   static constexpr size_t OFFSET_LSN = 4;
@@ -81,10 +116,10 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
-  // we store it as a ptr.
-  char *data_;
+  /** The actual data that is stored within a page, a frame of the buffer pool's FrameArena. */
+  // Keeping the data out of line leaves the Page objects as a dense array of frame metadata, and ASAN builds still
+  // detect page overflow through the guard gaps of the arena.
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
@@ -93,6 +128,10 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** True while the page is swizzled. Set after page_id_ and cleared with the page latch held in write mode. */
+  std::atomic<bool> swizzled_{false};
+  /** The swips of the pages this page refers to, allocated on first use. */
+  std::atomic<Swip *> swips_{nullptr};
 };
 
 }  // namespace bustub
@@ -5,6 +5,8 @@
 namespace bustub {
 
 class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
 
 class BasicPageGuard {
  public:
@@ -59,6 +61,17 @@ class BasicPageGuard {
    */
   ~BasicPageGuard();
 
+  /**
+   * @brief Latch the pinned page for reading, turning this guard into a ReadPageGuard
+   *
+   * The page stays pinned in between, so a caller can release the latch of the page it found this one on before
+   * waiting for this one's latch, without the page being deleted meanwhile. This guard is empty afterwards.
+   */
+  auto UpgradeRead() -> ReadPageGuard;
+
+  /** @brief Like UpgradeRead, for writing */
+  auto UpgradeWrite() -> WritePageGuard;
+
   auto IsEmpty() -> bool { return page_ == nullptr; }
 
   auto PageId() -> page_id_t { return page_->GetPageId(); }
@@ -146,7 +159,12 @@ class ReadPageGuard {
     return guard_.As<T>();
   }
 
+  /** @return the swip of a page the latched page refers to, see Page::GetSwip */
+  auto GetSwip(page_id_t page_id) -> Swip * { return guard_.page_->GetSwip(page_id); }
+
  private:
+  friend class BasicPageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
@@ -216,6 +234,8 @@ class WritePageGuard {
   }
 
  private:
+  friend class BasicPageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
@@ -16,8 +16,10 @@
 #include <mutex>  // NOLINT
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/segment.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
@@ -31,6 +33,12 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * The pages of the table come from a segment of its own, so that the page chain is laid out in extents of adjacent
+ * pages on disk instead of being interleaved with the pages of other tables and indexes.
+ *
+ * Table iterators that walk the page chain sequentially read ahead: each time one moves to the next page, the
+ * following read-ahead-depth pages of the chain are prefetched into the buffer pool as scan pages.
  */
 class TableHeap {
   friend class TableIterator;
@@ -64,9 +72,10 @@ class TableHeap {
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type how the page is accessed, table iterators pass AccessType::Scan
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` instead
@@ -82,9 +91,18 @@ class TableHeap {
   /** @return the iterator of this table, use this for project 4 except updates */
   auto MakeEagerIterator() -> TableIterator;
 
+  /** @return the segment the pages of this table are allocated from */
+  inline auto GetSegment() -> Segment * { return &segment_; }
+
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @brief Set how many pages sequential scans prefetch ahead of the current page, 0 disables read-ahead. */
+  inline void SetReadAheadDepth(size_t depth) { read_ahead_depth_ = depth; }
+
+  /** @return how many pages sequential scans prefetch ahead of the current page */
+  inline auto GetReadAheadDepth() const -> size_t { return read_ahead_depth_; }
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -104,11 +122,22 @@ class TableHeap {
   /** Used for binder tests */
   explicit TableHeap(bool create_table_heap = false);
 
+  /**
+   * Prefetch the pages following the page_index-th page of the chain, up to the read-ahead depth.
+   * @param page_id the page the iterator just moved to, read-ahead only happens if it is the page_index-th page
+   * @param page_index position of the page in the chain
+   * @param[in,out] prefetched_until position of the last page already prefetched by the iterator
+   */
+  void ReadAhead(page_id_t page_id, size_t page_index, size_t *prefetched_until);
+
   BufferPoolManager *bpm_;
+  Segment segment_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  std::vector<page_id_t> page_ids_;         /* the page chain in order, protected by latch_ */
+  size_t read_ahead_depth_{TABLE_HEAP_READ_AHEAD};
 };
 
 }  // namespace bustub
@@ -55,6 +55,10 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  // Position of the current page in the table's page chain, and of the last page prefetched by this iterator.
+  size_t page_index_{0};
+  size_t prefetched_until_{0};
 };
 
 }  // namespace bustub
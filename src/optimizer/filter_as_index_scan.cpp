@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** A conjunct of the form `column op constant`. */
+struct ColumnComparison {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  Value value_;
+};
+
+/** Collects the `column op constant` conjuncts of predicate, ignoring everything else. */
+void CollectColumnComparisons(const AbstractExpressionRef &predicate, std::vector<ColumnComparison> *comparisons) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(predicate.get()); logic != nullptr) {
+    if (logic->logic_type_ == LogicType::And) {
+      CollectColumnComparisons(logic->GetChildAt(0), comparisons);
+      CollectColumnComparisons(logic->GetChildAt(1), comparisons);
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate.get());
+  if (comparison == nullptr || comparison->comp_type_ == ComparisonType::NotEqual) {
+    return;
+  }
+  auto comp_type = comparison->comp_type_;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr && constant == nullptr) {
+    // `constant op column` is `column op' constant` with the operator mirrored
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0 || constant->val_.IsNull()) {
+    return;
+  }
+  comparisons->push_back({column->GetColIdx(), comp_type, constant->val_});
+}
+
+/** @return true if value can be stored in a key column without conversion or truncation */
+auto FitsKeyColumn(const Value &value, const Column &column) -> bool {
+  if (value.GetTypeId() != column.GetType()) {
+    return false;
+  }
+  // the length of a VARCHAR value counts its terminator
+  return column.GetType() != TypeId::VARCHAR || value.GetLength() <= column.GetVariableLength() + 1;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // Filter over a plain seq scan, or a seq scan that already carries the filter
+  const SeqScanPlanNode *seq_scan = nullptr;
+  AbstractExpressionRef predicate;
+  if (optimized_plan->GetType() == PlanType::Filter) {
+    BUSTUB_ASSERT(optimized_plan->children_.size() == 1, "must have exactly one children");
+    const auto &child_plan = *optimized_plan->children_[0];
+    if (child_plan.GetType() == PlanType::SeqScan) {
+      seq_scan = dynamic_cast<const SeqScanPlanNode *>(&child_plan);
+      predicate = dynamic_cast<const FilterPlanNode &>(*optimized_plan).GetPredicate();
+      if (seq_scan->filter_predicate_ != nullptr) {
+        return optimized_plan;
+      }
+    }
+  } else if (optimized_plan->GetType() == PlanType::SeqScan) {
+    seq_scan = dynamic_cast<const SeqScanPlanNode *>(optimized_plan.get());
+    predicate = seq_scan->filter_predicate_;
+  }
+  if (seq_scan == nullptr || predicate == nullptr) {
+    return optimized_plan;
+  }
+
+  std::vector<ColumnComparison> comparisons;
+  CollectColumnComparisons(predicate, &comparisons);
+  if (comparisons.empty()) {
+    return optimized_plan;
+  }
+
+  // For every index, bound the scan with equalities on a prefix of the key columns, then with the tightest range on
+  // the column after it. The bounds are inclusive, the full predicate stays as the residual filter. A hash index only
+  // serves equalities on all its key columns, and wins over a B+ tree bounded as tightly.
+  const auto *table_info = catalog_.GetTable(seq_scan->GetTableOid());
+  const IndexInfo *best_index = nullptr;
+  std::vector<Value> best_lower;
+  std::vector<Value> best_upper;
+  for (const auto *index : catalog_.GetTableIndexes(table_info->name_)) {
+    const auto &key_attrs = index->index_->GetKeyAttrs();
+    const auto &key_columns = index->key_schema_.GetColumns();
+    std::vector<Value> lower;
+    std::vector<Value> upper;
+    size_t equal_columns = 0;
+    for (size_t i = 0; i < key_attrs.size(); i++) {
+      std::optional<Value> equal;
+      std::optional<Value> low;
+      std::optional<Value> high;
+      for (const auto &comparison : comparisons) {
+        if (comparison.col_idx_ != key_attrs[i] || !FitsKeyColumn(comparison.value_, key_columns[i])) {
+          continue;
+        }
+        const auto &value = comparison.value_;
+        switch (comparison.comp_type_) {
+          case ComparisonType::Equal:
+            equal = value;
+            break;
+          case ComparisonType::GreaterThan:
+          case ComparisonType::GreaterThanOrEqual:
+            if (!low.has_value() || value.CompareGreaterThan(*low) == CmpBool::CmpTrue) {
+              low = value;
+            }
+            break;
+          case ComparisonType::LessThan:
+          case ComparisonType::LessThanOrEqual:
+            if (!high.has_value() || value.CompareLessThan(*high) == CmpBool::CmpTrue) {
+              high = value;
+            }
+            break;
+          default:
+            break;
+        }
+      }
+      if (equal.has_value()) {
+        lower.push_back(*equal);
+        upper.push_back(*equal);
+        equal_columns++;
+        continue;
+      }
+      if (low.has_value()) {
+        lower.push_back(*low);
+      }
+      if (high.has_value()) {
+        upper.push_back(*high);
+      }
+      break;
+    }
+    bool is_hash = index->index_type_ == IndexType::HashTableIndex;
+    if (is_hash && equal_columns < key_attrs.size()) {
+      continue;
+    }
+    size_t bound_columns = std::max(lower.size(), upper.size());
+    size_t best_bound_columns = std::max(best_lower.size(), best_upper.size());
+    if (bound_columns > best_bound_columns || (is_hash && bound_columns == best_bound_columns)) {
+      best_index = index;
+      best_lower = std::move(lower);
+      best_upper = std::move(upper);
+    }
+  }
+  if (best_index == nullptr) {
+    return optimized_plan;
+  }
+  return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, best_index->index_oid_, predicate,
+                                             std::move(best_lower), std::move(best_upper));
+}
+
+}  // namespace bustub
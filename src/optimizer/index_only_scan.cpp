@@ -0,0 +1,78 @@
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return true if expr reads no column outside of columns */
+auto ReadsOnly(const AbstractExpressionRef &expr, const std::unordered_set<uint32_t> &columns) -> bool {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr.get()); column != nullptr) {
+    return columns.count(column->GetColIdx()) > 0;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    if (!ReadsOnly(child, columns)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // The columns the parent of the scan reads, other parents pass the tuples on and are left alone.
+  std::vector<AbstractExpressionRef> exprs;
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    exprs = dynamic_cast<const ProjectionPlanNode &>(*optimized_plan).GetExpressions();
+  } else if (optimized_plan->GetType() == PlanType::Aggregation) {
+    const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+    exprs = agg_plan.GetGroupBys();
+    exprs.insert(exprs.end(), agg_plan.GetAggregates().begin(), agg_plan.GetAggregates().end());
+  } else {
+    return optimized_plan;
+  }
+
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "must have exactly one children");
+  const auto &child_plan = optimized_plan->children_[0];
+  if (child_plan->GetType() != PlanType::IndexScan) {
+    return optimized_plan;
+  }
+  const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+  if (index_scan.filter_predicate_ != nullptr) {
+    exprs.push_back(index_scan.filter_predicate_);
+  }
+
+  // only a B+ tree hands out its entries
+  const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+  if (index_info->index_type_ != IndexType::BPlusTreeIndex) {
+    return optimized_plan;
+  }
+  const auto &entry_attrs = index_info->index_->GetEntryAttrs();
+  std::unordered_set<uint32_t> columns(entry_attrs.begin(), entry_attrs.end());
+  for (const auto &expr : exprs) {
+    if (!ReadsOnly(expr, columns)) {
+      return optimized_plan;
+    }
+  }
+  return optimized_plan->CloneWithChildren({std::make_shared<IndexOnlyScanPlanNode>(index_scan)});
+}
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -28,17 +29,35 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
   }
   auto optimized_plan = plan->CloneWithChildren(std::move(children));
 
+  // A limit over an index scan stops the scan after that many tuples, unless the scan still has to filter them or
+  // to reorder them for a mixed order. A projection in between does not change the number of tuples.
+  if (optimized_plan->GetType() == PlanType::Limit) {
+    const auto &limit_plan = dynamic_cast<const LimitPlanNode &>(*optimized_plan);
+    const auto &child_plan = optimized_plan->children_[0];
+    const auto &scan_plan =
+        child_plan->GetType() == PlanType::Projection ? child_plan->children_[0] : optimized_plan->children_[0];
+    if (scan_plan->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*scan_plan);
+      if (index_scan.filter_predicate_ == nullptr && !index_scan.limit_.has_value() && !index_scan.IsMixedOrder() &&
+          catalog_.GetIndex(index_scan.index_oid_)->index_type_ == IndexType::BPlusTreeIndex) {
+        AbstractPlanNodeRef limited_scan = std::make_shared<IndexScanPlanNode>(
+            index_scan.output_schema_, index_scan.index_oid_, nullptr, index_scan.lower_bound_,
+            index_scan.upper_bound_, index_scan.key_order_, limit_plan.GetLimit());
+        if (child_plan != scan_plan) {
+          limited_scan = child_plan->CloneWithChildren({std::move(limited_scan)});
+        }
+        return optimized_plan->CloneWithChildren({std::move(limited_scan)});
+      }
+    }
+  }
+
   if (optimized_plan->GetType() == PlanType::Sort) {
     const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
     const auto &order_bys = sort_plan.GetOrderBy();
 
     std::vector<uint32_t> order_by_column_ids;
+    std::vector<OrderByType> key_order;
     for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
-        return optimized_plan;
-      }
-
       // Order expression is a column value expression
       const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
       if (column_value_expr == nullptr) {
@@ -46,34 +65,79 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       }
 
       order_by_column_ids.push_back(column_value_expr->GetColIdx());
+      key_order.push_back(order_type == OrderByType::DESC ? OrderByType::DESC : OrderByType::ASC);
+    }
+    // Scanning forward already gives the ascending order.
+    if (std::none_of(key_order.begin(), key_order.end(),
+                     [](OrderByType type) { return type == OrderByType::DESC; })) {
+      key_order.clear();
     }
 
     // Has exactly one child
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
     const auto &child_plan = optimized_plan->children_[0];
 
-    if (child_plan->GetType() == PlanType::SeqScan) {
-      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+    // Look through a projection of columns, ordering by the columns of the scan they come from.
+    const ProjectionPlanNode *projection = nullptr;
+    auto scan_plan = child_plan;
+    if (child_plan->GetType() == PlanType::Projection) {
+      projection = dynamic_cast<const ProjectionPlanNode *>(child_plan.get());
+      scan_plan = projection->GetChildAt(0);
+      for (auto &column_id : order_by_column_ids) {
+        const auto *column_value_expr =
+            dynamic_cast<ColumnValueExpression *>(projection->GetExpressions()[column_id].get());
+        if (column_value_expr == nullptr) {
+          return optimized_plan;
+        }
+        column_id = column_value_expr->GetColIdx();
+      }
+    }
+
+    // check index key schema == order by columns, of an index that keeps its keys in order
+    auto matches = [&](const TableInfo *table_info, const IndexInfo *index) {
+      const auto &columns = index->key_schema_.GetColumns();
+      if (index->index_type_ != IndexType::BPlusTreeIndex || columns.size() != order_by_column_ids.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].GetName() != table_info->schema_.GetColumn(order_by_column_ids[i]).GetName()) {
+          return false;
+        }
+      }
+      return true;
+    };
+    auto with_scan = [&](AbstractPlanNodeRef index_scan) -> AbstractPlanNodeRef {
+      if (projection == nullptr) {
+        return index_scan;
+      }
+      return projection->CloneWithChildren({std::move(index_scan)});
+    };
+
+    if (scan_plan->GetType() == PlanType::SeqScan) {
+      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*scan_plan);
       const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
-        const auto &columns = index->key_schema_.GetColumns();
-        // check index key schema == order by columns
-        bool valid = true;
-        if (columns.size() == order_by_column_ids.size()) {
-          for (size_t i = 0; i < columns.size(); i++) {
-            if (columns[i].GetName() != table_info->schema_.GetColumn(order_by_column_ids[i]).GetName()) {
-              valid = false;
-              break;
-            }
-          }
-          if (valid) {
-            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
-          }
+        if (matches(table_info, index)) {
+          return with_scan(std::make_shared<IndexScanPlanNode>(scan_plan->output_schema_, index->index_oid_,
+                                                               seq_scan.filter_predicate_, std::vector<Value>{},
+                                                               std::vector<Value>{}, key_order));
         }
       }
     }
+
+    // A range scan of a filter turned into an index scan is sorted the same way.
+    if (scan_plan->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*scan_plan);
+      const auto *index = catalog_.GetIndex(index_scan.index_oid_);
+      const auto *table_info = catalog_.GetTable(index->table_name_);
+      if (index_scan.key_order_.empty() && !index_scan.limit_.has_value() && matches(table_info, index)) {
+        return with_scan(std::make_shared<IndexScanPlanNode>(scan_plan->output_schema_, index_scan.index_oid_,
+                                                             index_scan.filter_predicate_, index_scan.lower_bound_,
+                                                             index_scan.upper_bound_, key_order));
+      }
+    }
   }
 
   return optimized_plan;
@@ -11,7 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -20,23 +22,30 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+static auto TestBit(const std::vector<uint64_t> &bitmap, size_t index) -> bool {
+  return index / 64 < bitmap.size() && (bitmap[index / 64] >> (index % 64) & 1) != 0;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DiskSchedulerBackend backend, bool direct_io)
+    : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
+  log_name_ = GetSidecarFileName(".log");
+  fsm_name_ = GetSidecarFileName(".fsm");
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -49,28 +58,47 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  scheduler_ = std::make_unique<DiskScheduler>(db_file, backend, direct_io);
+  buffer_used = nullptr;
+  int64_t db_size = GetFileSize(file_name_);
+  LoadFreeSpaceMap(db_size > 0 ? static_cast<size_t>(db_size) / BUSTUB_PAGE_SIZE : 0);
+}
+
+auto DiskManager::GetSidecarFileName(const std::string &extension) const -> std::string {
+  std::string::size_type n = file_name_.rfind('.');
+  if (n == std::string::npos) {
+    return "";
+  }
+  return file_name_.substr(0, n) + extension;
+}
+
+void DiskManager::LoadFreeSpaceMap(size_t db_pages) {
+  // Without a database file, a map of the same name is left over from an earlier database and is ignored.
+  if (db_pages == 0) {
+    return;
+  }
+  int64_t fsm_size = GetFileSize(fsm_name_);
+  if (fsm_size > 0) {
+    std::ifstream fsm_io(fsm_name_, std::ios::binary);
+    fsm_.resize(static_cast<size_t>(fsm_size) / sizeof(uint64_t));
+    fsm_io.read(reinterpret_cast<char *>(fsm_.data()), static_cast<std::streamsize>(fsm_.size() * sizeof(uint64_t)));
+    if (!fsm_io) {
+      LOG_DEBUG("I/O error while reading free-space map");
+      fsm_.clear();
     }
   }
-  buffer_used = nullptr;
+  for (size_t page = fsm_.size() * 64; page < db_pages; ++page) {
+    SetAllocated(static_cast<page_id_t>(page), true);
+  }
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
-  }
+  SyncFreeSpaceMap();
+  // waits for the outstanding page I/O
+  scheduler_.reset();
   log_io_.close();
 }
 
@@ -78,48 +106,210 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  if (scheduler_ == nullptr) {
+    LOG_DEBUG("db file is not open");
+    return;
+  }
+  if (!WritePagesAsync(page_id, {page_data}).get()) {
     LOG_DEBUG("I/O error while writing");
+  }
+}
+
+/**
+ * Write a run of adjacent pages as a single I/O
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  if (scheduler_ == nullptr) {
+    LOG_DEBUG("db file is not open");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  if (!WritePagesAsync(first_page_id, pages).get()) {
+    LOG_DEBUG("I/O error while writing");
+  }
 }
 
 /**
- * Read the contents of the specified page into the given memory area
+ * Read the contents of the specified page into the given memory area, a page past the end of the file reads as zeros
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+  if (scheduler_ == nullptr) {
+    LOG_DEBUG("db file is not open");
+    return;
+  }
+  if (!ReadPageAsync(page_id, page_data).get()) {
+    LOG_DEBUG("I/O error while reading");
+  }
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  if (scheduler_ != nullptr) {
+    return scheduler_->ReadPage(page_id, page_data);
+  }
+  // in-memory disk managers override ReadPage, which completes immediately
+  std::promise<bool> done;
+  ReadPage(page_id, page_data);
+  done.set_value(true);
+  return done.get_future();
+}
+
+auto DiskManager::WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages)
+    -> std::future<bool> {
+  if (scheduler_ != nullptr) {
+    num_writes_ += 1;
+    return scheduler_->WritePages(first_page_id, pages);
+  }
+  std::promise<bool> done;
+  WritePages(first_page_id, pages);
+  done.set_value(true);
+  return done.get_future();
+}
+
+auto DiskManager::AllocatePage(size_t stride, size_t residue) -> page_id_t {
+  BUSTUB_ASSERT(residue < stride, "residue must be less than stride");
+  std::scoped_lock lock(fsm_latch_);
+  if (hint_stride_ != stride) {
+    hint_stride_ = stride;
+    next_free_.resize(stride);
+    for (size_t r = 0; r < stride; ++r) {
+      next_free_[r] = static_cast<page_id_t>(r);
+    }
+  }
+  page_id_t page_id = next_free_[residue];
+  while (TestBit(fsm_, page_id)) {
+    page_id += static_cast<page_id_t>(stride);
+  }
+  InvalidateFreeSpaceMap();
+  SetAllocated(page_id, true);
+  next_free_[residue] = page_id + static_cast<page_id_t>(stride);
+  return page_id;
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock lock(fsm_latch_);
+  FreePage(page_id);
+}
+
+auto DiskManager::AllocateExtent(size_t num_pages) -> page_id_t {
+  BUSTUB_ASSERT(num_pages > 0, "an extent holds at least one page");
+  std::scoped_lock lock(fsm_latch_);
+  size_t first = 0;
+  size_t page = 0;
+  while (page < first + num_pages) {
+    if (TestBit(fsm_, page)) {
+      first = (page / num_pages + 1) * num_pages;
+      page = first;
+    } else {
+      ++page;
+    }
+  }
+  // Taking pages only ever keeps the allocation hints valid.
+  InvalidateFreeSpaceMap();
+  for (page = first; page < first + num_pages; ++page) {
+    SetAllocated(static_cast<page_id_t>(page), true);
+  }
+  return static_cast<page_id_t>(first);
+}
+
+void DiskManager::DeallocateExtent(page_id_t first_page_id, size_t num_pages) {
+  std::scoped_lock lock(fsm_latch_);
+  for (size_t i = 0; i < num_pages; ++i) {
+    FreePage(first_page_id + static_cast<page_id_t>(i));
+  }
+}
+
+auto DiskManager::IsAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock lock(fsm_latch_);
+  return TestBit(fsm_, page_id);
+}
+
+auto DiskManager::GetNumPages() -> size_t {
+  std::scoped_lock lock(fsm_latch_);
+  return CountPages();
+}
+
+void DiskManager::SyncFreeSpaceMap() {
+  std::scoped_lock lock(fsm_latch_);
+  WriteFreeSpaceMap();
+}
+
+auto DiskManager::Shrink() -> size_t {
+  std::scoped_lock lock(fsm_latch_);
+  size_t num_pages = CountPages();
+  if (fsm_.size() > (num_pages + 63) / 64) {
+    fsm_.resize((num_pages + 63) / 64);
+    fsm_dirty_ = true;
+  }
+  size_t released = 0;
+  int64_t db_size = GetFileSize(file_name_);
+  if (scheduler_ != nullptr && db_size > 0) {
+    auto db_pages = (static_cast<size_t>(db_size) + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE;
+    if (db_pages > num_pages && scheduler_->Truncate(num_pages)) {
+      released = db_pages - num_pages;
+    }
+  }
+  // The map has to describe the truncated file before any page past its new end is allocated again.
+  WriteFreeSpaceMap();
+  return released;
+}
+
+void DiskManager::FreePage(page_id_t page_id) {
+  if (!TestBit(fsm_, page_id)) {
+    return;
+  }
+  SetAllocated(page_id, false);
+  if (hint_stride_ > 0) {
+    page_id_t &hint = next_free_[static_cast<size_t>(page_id) % hint_stride_];
+    hint = std::min(hint, page_id);
+  }
+}
+
+void DiskManager::SetAllocated(page_id_t page_id, bool allocated) {
+  auto index = static_cast<size_t>(page_id);
+  if (index / 64 >= fsm_.size()) {
+    if (!allocated) {
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    fsm_.resize(index / 64 + 1, 0);
+  }
+  uint64_t bit = uint64_t{1} << (index % 64);
+  fsm_[index / 64] = allocated ? fsm_[index / 64] | bit : fsm_[index / 64] & ~bit;
+  fsm_dirty_ = true;
+}
+
+void DiskManager::WriteFreeSpaceMap() {
+  if (fsm_name_.empty() || !fsm_dirty_) {
+    return;
+  }
+  std::ofstream fsm_io(fsm_name_, std::ios::binary | std::ios::trunc);
+  fsm_io.write(reinterpret_cast<const char *>(fsm_.data()),
+               static_cast<std::streamsize>(fsm_.size() * sizeof(uint64_t)));
+  fsm_io.flush();
+  fsm_on_disk_ = true;
+  if (!fsm_io) {
+    LOG_DEBUG("I/O error while writing free-space map");
+    return;
+  }
+  fsm_dirty_ = false;
+}
+
+void DiskManager::InvalidateFreeSpaceMap() {
+  if (fsm_name_.empty() || !fsm_on_disk_) {
+    return;
+  }
+  // Freeing pages needs not do this: a stale map then only leaks the freed pages.
+  std::remove(fsm_name_.c_str());
+  fsm_on_disk_ = false;
+  // The next sync has to write the map back even if nothing else changes.
+  fsm_dirty_ = true;
+}
+
+auto DiskManager::CountPages() -> size_t {
+  for (size_t i = fsm_.size(); i > 0; --i) {
+    if (fsm_[i - 1] != 0) {
+      return (i - 1) * 64 + 64 - static_cast<size_t>(__builtin_clzll(fsm_[i - 1]));
     }
   }
+  return 0;
 }
 
 /**
@@ -202,10 +392,10 @@ auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-auto DiskManager::GetFileSize(const std::string &file_name) -> int {
+auto DiskManager::GetFileSize(const std::string &file_name) -> int64_t {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
@@ -39,6 +39,18 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Write a run of adjacent pages
+ */
+void DiskManagerMemory::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  size_t offset = static_cast<size_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += 1;
+  for (const char *page_data : pages) {
+    memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
+    offset += BUSTUB_PAGE_SIZE;
+  }
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
@@ -0,0 +1,453 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BUSTUB_HAS_IO_URING
+#endif
+
+namespace bustub {
+
+/** A request on its way through the scheduler. */
+struct DiskScheduler::PendingIO {
+  PendingIO() = default;
+  PendingIO(const PendingIO &) = delete;
+  auto operator=(const PendingIO &) -> PendingIO & = delete;
+  ~PendingIO() { std::free(bounce_); }  // NOLINT
+
+  DiskRequest request_;
+  /** The memory the I/O is performed on, either the request's buffers or the bounce buffer. */
+  std::vector<iovec> iov_;
+  /** Total number of bytes to transfer. */
+  size_t size_{0};
+  /** Page-aligned copy of the request's buffers, only used with O_DIRECT. */
+  char *bounce_{nullptr};
+};
+
+#ifdef BUSTUB_HAS_IO_URING
+
+/** Number of submission queue entries, which is also the maximum number of requests submitted to the kernel. */
+static constexpr unsigned IO_URING_ENTRIES = 128;
+
+/**
+ * A minimal io_uring instance driven through the raw system calls, so that no library is needed. The submission side
+ * is only used by the submitting thread and the completion side only by the reaping thread.
+ */
+struct DiskScheduler::IoUring {
+  IoUring() = default;
+  IoUring(const IoUring &) = delete;
+  auto operator=(const IoUring &) -> IoUring & = delete;
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+
+  /** Set up the rings. Returns false if the kernel does not allow io_uring. */
+  auto Init(unsigned entries) -> bool {
+    io_uring_params params{};
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0) {
+      return false;
+    }
+    entries_ = params.sq_entries;
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_
+                           : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  /** Queue one entry in the submission ring. The caller guarantees there is room for it. */
+  void Push(uint8_t opcode, int fd, const std::vector<iovec> *iov, uint64_t offset, void *user_data) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    if (iov != nullptr) {
+      sqe->addr = reinterpret_cast<uint64_t>(iov->data());
+      sqe->len = static_cast<uint32_t>(iov->size());
+    }
+    sqe->off = offset;
+    sqe->user_data = reinterpret_cast<uint64_t>(user_data);
+    sq_array_[index] = index;
+    // Publish the entry before the kernel can see the new tail.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  /** Hand to_submit queued entries to the kernel, and optionally wait for at least one completion. */
+  void Enter(unsigned to_submit, bool wait) {
+    unsigned min_complete = wait ? 1 : 0;
+    unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+    while (syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0) < 0) {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        LOG_WARN("io_uring_enter failed: %s", strerror(errno));
+        return;
+      }
+    }
+  }
+
+  int ring_fd_{-1};
+  /** Number of entries of the submission ring. */
+  unsigned entries_{0};
+  /** Entries pushed and not reaped yet, never more than entries_. Protected by the scheduler latch. */
+  unsigned in_flight_{0};
+  /** Signalled when entries are reaped. Waited on with the scheduler latch. */
+  std::condition_variable slot_free_;
+
+  void *sq_ring_{MAP_FAILED};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{MAP_FAILED};
+  size_t cq_ring_size_{0};
+  void *sqes_{MAP_FAILED};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#else
+
+struct DiskScheduler::IoUring {};
+
+#endif
+
+DiskScheduler::DiskScheduler(const std::string &db_file, DiskSchedulerBackend backend, bool direct_io,
+                             size_t num_workers)
+    : backend_(backend) {
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io) {
+    fd_ = open(db_file.c_str(), flags | O_DIRECT, 0666);
+    if (fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("file system does not support O_DIRECT, using buffered I/O");
+    }
+    direct_io_ = fd_ >= 0;
+  }
+#endif
+  if (fd_ < 0) {
+    fd_ = open(db_file.c_str(), flags, 0666);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+
+  if (backend_ == DiskSchedulerBackend::IoUring) {
+#ifdef BUSTUB_HAS_IO_URING
+    ring_ = std::make_unique<IoUring>();
+    if (!ring_->Init(IO_URING_ENTRIES)) {
+      LOG_WARN("io_uring is not available, using the thread pool");
+      ring_.reset();
+    }
+#endif
+    if (ring_ == nullptr) {
+      backend_ = DiskSchedulerBackend::ThreadPool;
+    }
+  }
+
+  if (backend_ == DiskSchedulerBackend::IoUring) {
+    threads_.emplace_back(&DiskScheduler::SubmitLoop, this);
+    threads_.emplace_back(&DiskScheduler::ReapLoop, this);
+  } else {
+    for (size_t i = 0; i < std::max<size_t>(num_workers, 1); ++i) {
+      threads_.emplace_back(&DiskScheduler::WorkerLoop, this);
+    }
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock lock(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  ring_.reset();
+  close(fd_);
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  BUSTUB_ASSERT(!r.data_.empty(), "request should cover at least one page");
+  {
+    std::scoped_lock lock(latch_);
+    queue_.emplace_back(std::move(r));
+  }
+  cv_.notify_one();
+}
+
+auto DiskScheduler::ReadPage(page_id_t page_id, char *page_data) -> std::future<bool> {
+  DiskRequest r{false, page_id, {page_data}, {}};
+  auto future = r.callback_.get_future();
+  Schedule(std::move(r));
+  return future;
+}
+
+auto DiskScheduler::WritePage(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  return WritePages(page_id, {page_data});
+}
+
+auto DiskScheduler::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages)
+    -> std::future<bool> {
+  DiskRequest r{true, first_page_id, {}, {}};
+  for (const char *page_data : pages) {
+    r.data_.push_back(const_cast<char *>(page_data));  // NOLINT: write requests never modify the buffers
+  }
+  auto future = r.callback_.get_future();
+  Schedule(std::move(r));
+  return future;
+}
+
+auto DiskScheduler::Truncate(size_t num_pages) -> bool {
+  return ftruncate(fd_, static_cast<off_t>(num_pages) * BUSTUB_PAGE_SIZE) == 0;
+}
+
+auto DiskScheduler::Prepare(DiskRequest r) -> std::unique_ptr<PendingIO> {
+  auto io = std::make_unique<PendingIO>();
+  io->request_ = std::move(r);
+  const auto &data = io->request_.data_;
+  io->size_ = data.size() * BUSTUB_PAGE_SIZE;
+  bool aligned = std::all_of(data.begin(), data.end(), [](char *page_data) {
+    return reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE == 0;
+  });
+  if (direct_io_ && !aligned) {
+    io->bounce_ = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, io->size_));
+    if (io->request_.is_write_) {
+      for (size_t i = 0; i < data.size(); ++i) {
+        memcpy(io->bounce_ + i * BUSTUB_PAGE_SIZE, data[i], BUSTUB_PAGE_SIZE);
+      }
+    }
+    io->iov_.push_back({io->bounce_, io->size_});
+  } else {
+    for (char *page_data : data) {
+      io->iov_.push_back({page_data, BUSTUB_PAGE_SIZE});
+    }
+  }
+  return io;
+}
+
+auto DiskScheduler::Transfer(PendingIO &io, size_t done) -> bool {
+  const off_t offset = static_cast<off_t>(io.request_.page_id_) * BUSTUB_PAGE_SIZE;
+  while (done < io.size_) {
+    // Skip what has been transferred already.
+    std::vector<iovec> iov;
+    size_t skip = done;
+    for (const auto &vec : io.iov_) {
+      if (skip >= vec.iov_len) {
+        skip -= vec.iov_len;
+        continue;
+      }
+      iov.push_back({static_cast<char *>(vec.iov_base) + skip, vec.iov_len - skip});
+      skip = 0;
+    }
+    int count = static_cast<int>(std::min<size_t>(iov.size(), IOV_MAX));
+    ssize_t n = io.request_.is_write_ ? pwritev(fd_, iov.data(), count, offset + static_cast<off_t>(done))
+                                      : preadv(fd_, iov.data(), count, offset + static_cast<off_t>(done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error on page %d: %s", io.request_.page_id_, strerror(errno));
+      return false;
+    }
+    if (n == 0) {
+      if (io.request_.is_write_) {
+        return false;
+      }
+      // The file ends before the requested pages, they read as zeros.
+      for (const auto &vec : iov) {
+        memset(vec.iov_base, 0, vec.iov_len);
+      }
+      return true;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+void DiskScheduler::Complete(std::unique_ptr<PendingIO> io, bool ok) {
+  if (ok && io->bounce_ != nullptr && !io->request_.is_write_) {
+    for (size_t i = 0; i < io->request_.data_.size(); ++i) {
+      memcpy(io->request_.data_[i], io->bounce_ + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE);
+    }
+  }
+  io->request_.callback_.set_value(ok);
+}
+
+auto DiskScheduler::PopRequest(DiskRequest *r) -> bool {
+  std::unique_lock lock(latch_);
+  cv_.wait(lock, [this] { return shutdown_ || !queue_.empty(); });
+  if (queue_.empty()) {
+    return false;
+  }
+  *r = std::move(queue_.front());
+  queue_.pop_front();
+  return true;
+}
+
+void DiskScheduler::WorkerLoop() {
+  DiskRequest r;
+  while (PopRequest(&r)) {
+    auto io = Prepare(std::move(r));
+    bool ok = Transfer(*io, 0);
+    Complete(std::move(io), ok);
+  }
+}
+
+#ifdef BUSTUB_HAS_IO_URING
+
+void DiskScheduler::SubmitLoop() {
+  while (true) {
+    // Take as many requests as there is room for in the ring, so that they are submitted with a single system call.
+    std::vector<DiskRequest> batch;
+    bool stop;
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait(lock, [this] { return shutdown_ || !queue_.empty(); });
+      ring_->slot_free_.wait(lock, [this] { return ring_->in_flight_ < ring_->entries_; });
+      while (!queue_.empty() && ring_->in_flight_ < ring_->entries_) {
+        batch.emplace_back(std::move(queue_.front()));
+        queue_.pop_front();
+        ring_->in_flight_++;
+      }
+      stop = shutdown_ && queue_.empty();
+      if (stop) {
+        // Reserve a slot for the entry telling the reaper to stop.
+        ring_->slot_free_.wait(lock, [this] { return ring_->in_flight_ < ring_->entries_; });
+        ring_->in_flight_++;
+      }
+    }
+
+    for (auto &r : batch) {
+      auto io = Prepare(std::move(r));
+      uint8_t opcode = io->request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      uint64_t offset = static_cast<uint64_t>(io->request_.page_id_) * BUSTUB_PAGE_SIZE;
+      ring_->Push(opcode, fd_, &io->iov_, offset, io.get());
+      io.release();  // NOLINT: owned by the ring until reaped
+    }
+    if (stop) {
+      ring_->Push(IORING_OP_NOP, -1, nullptr, 0, nullptr);
+    }
+    ring_->Enter(batch.size() + (stop ? 1 : 0), false);
+    if (stop) {
+      return;
+    }
+  }
+}
+
+void DiskScheduler::ReapLoop() {
+  bool stopping = false;
+  while (true) {
+    ring_->Enter(0, true);
+    unsigned head = *ring_->cq_head_;
+    unsigned tail = __atomic_load_n(ring_->cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned reaped = tail - head;
+    for (; head != tail; ++head) {
+      const io_uring_cqe &cqe = ring_->cqes_[head & *ring_->cq_mask_];
+      int res = cqe.res;
+      std::unique_ptr<PendingIO> io(reinterpret_cast<PendingIO *>(cqe.user_data));
+      if (io == nullptr) {
+        stopping = true;
+        continue;
+      }
+      // Short transfers (end of file, or the kernel splitting the request) and errors are finished synchronously.
+      bool ok = res >= 0 && static_cast<size_t>(res) == io->size_;
+      if (!ok) {
+        ok = Transfer(*io, res >= 0 ? static_cast<size_t>(res) : 0);
+      }
+      Complete(std::move(io), ok);
+    }
+    __atomic_store_n(ring_->cq_head_, head, __ATOMIC_RELEASE);
+
+    std::scoped_lock lock(latch_);
+    ring_->in_flight_ -= reaped;
+    ring_->slot_free_.notify_all();
+    if (stopping && ring_->in_flight_ == 0) {
+      return;
+    }
+  }
+}
+
+#else
+
+void DiskScheduler::SubmitLoop() {}
+
+void DiskScheduler::ReapLoop() {}
+
+#endif
+
+}  // namespace bustub
@@ -1,22 +1,28 @@
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/posting_list.h"
 
 namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size, bool unique)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
+      segment_(buffer_pool_manager, SEGMENT_EXTENT_SIZE, buffer_pool_manager->GetGroup("index")),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
+      header_page_id_(header_page_id),
+      unique_(unique) {
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
@@ -28,96 +34,146 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPool
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
 
+/*
+ * Descend from the root, latching one page at a time. The next page is pinned
+ * (or, if it is swizzled, latched) before the latch on the current one is
+ * released, so it cannot be deleted in between; if it was taken out of the
+ * tree by then, the search starts over. A
+ * page that split after its parent pointed to it no longer holds the key, and
+ * the search follows its right link instead.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::LeafBinarySearch(const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *page,
-                                      const KeyType &key) -> int {
-  if (page->GetSize() == 0) {
-    return 0;
-  }
-  int left = 0;
-  int right = page->GetSize() - 1;
-  int pos = page->GetSize();
-  while (left <= right) {
-    int mid = (left + right) / 2;
-    int cmp = comparator_(page->KeyAt(mid), key);
-    if (cmp < 0) {
-      left = mid + 1;
-    } else {
-      pos = mid;
-      right = mid - 1;
+template <typename Guard>
+auto BPLUSTREE_TYPE::FindLeaf(const KeyType *key, std::vector<page_id_t> *path) -> std::optional<Guard> {
+  while (true) {
+    if (path != nullptr) {
+      path->clear();
+    }
+    ReadPageGuard guard = FetchHeaderRead();
+    page_id_t root_page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    Descend(&guard, root_page_id);
+    while (true) {
+      auto page = guard.As<BPlusTreePage>();
+      if (page->IsDeleted()) {
+        break;
+      }
+      page_id_t next_page_id;
+      if (key != nullptr && IsBeyond(page, *key)) {
+        next_page_id = RightPageId(page);
+      } else if (!page->IsLeafPage()) {
+        auto internal_page = guard.As<InternalPage>();
+        next_page_id = internal_page->ValueAt(key != nullptr ? internal_page->ChildIndex(*key, comparator_) : 0);
+        if (path != nullptr) {
+          path->push_back(guard.PageId());
+        }
+      } else if constexpr (std::is_same_v<Guard, ReadPageGuard>) {
+        return guard;
+      } else {
+        // Only the leaf is write latched. It may split or be deleted while it is not latched, so check it again.
+        BasicPageGuard leaf_guard = bpm_->FetchPageBasic(guard.PageId());
+        guard.Drop();
+        WritePageGuard write_guard = leaf_guard.UpgradeWrite();
+        auto leaf_page = write_guard.template As<BPlusTreePage>();
+        if (leaf_page->IsDeleted()) {
+          break;
+        }
+        if (key == nullptr || !IsBeyond(leaf_page, *key)) {
+          return write_guard;
+        }
+        BasicPageGuard next_guard = bpm_->FetchPageBasic(RightPageId(leaf_page));
+        write_guard.Drop();
+        guard = next_guard.UpgradeRead();
+        continue;
+      }
+      Descend(&guard, next_page_id);
     }
   }
-  return pos;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InternalBinarySearch(const BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *page,
-                                          const KeyType &key) -> int {
-  if (page->GetSize() <= 1) {
-    return 0;
+auto BPLUSTREE_TYPE::FetchHeaderRead() -> ReadPageGuard {
+  ReadPageGuard guard = bpm_->TryFetchSwizzledRead(&header_swip_, header_page_id_);
+  if (guard.IsEmpty()) {
+    guard = bpm_->FetchPageRead(header_page_id_);
+    bpm_->SwizzlePage(&header_swip_, header_page_id_);
   }
-  int left = 1;
-  int right = page->GetSize() - 1;
-  int pos = 0;
-  while (left <= right) {
-    int mid = (left + right) / 2;
-    int cmp = comparator_(page->KeyAt(mid), key);
-    if (cmp <= 0) {
-      pos = mid;
-      left = mid + 1;
-    } else {
-      right = mid - 1;
-    }
+  return guard;
+}
+
+/*
+ * The swizzled page is latched before the latch on the current one is
+ * released, but only if that does not have to wait, so this cannot deadlock
+ * with writers that latch a page and then the one above it. Otherwise the next
+ * page is pinned and latched like in FindLeaf, and swizzled if it is internal.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Descend(ReadPageGuard *guard, page_id_t next_page_id) {
+  Swip *swip = guard->GetSwip(next_page_id);
+  ReadPageGuard next_guard = bpm_->TryFetchSwizzledRead(swip, next_page_id);
+  if (!next_guard.IsEmpty()) {
+    *guard = std::move(next_guard);
+    return;
   }
-  return pos;
+  BasicPageGuard pinned_guard = bpm_->FetchPageBasic(next_page_id);
+  guard->Drop();
+  *guard = pinned_guard.UpgradeRead();
+  auto page = guard->As<BPlusTreePage>();
+  if (!page->IsLeafPage() && !page->IsDeleted()) {
+    bpm_->SwizzlePage(swip, next_page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsBeyond(const BPlusTreePage *page, const KeyType &key) const -> bool {
+  if (RightPageId(page) == INVALID_PAGE_ID) {
+    return false;
+  }
+  return comparator_(key, HighKey(page)) >= 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::HighKey(const BPlusTreePage *page) -> KeyType {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->HighKey()
+                            : reinterpret_cast<const InternalPage *>(page)->HighKey();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RightPageId(const BPlusTreePage *page) -> page_id_t {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->GetNextPageId()
+                            : reinterpret_cast<const InternalPage *>(page)->GetRightPageId();
 }
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values associated with input key, the only one in a unique tree
  * This method is used for point query
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, [[maybe_unused]] Transaction *txn)
     -> bool {
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = guard.As<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+  OperationGuard op(this);
+  std::optional<ReadPageGuard> guard = FindLeaf<ReadPageGuard>(&key);
+  if (!guard.has_value()) {
     return false;
   }
-  page_id_t cur_page_id = header_page->root_page_id_;
-  ReadPageGuard root_guard = bpm_->FetchPageRead(cur_page_id);
-  guard = std::move(root_guard);
-  while (cur_page_id != INVALID_PAGE_ID) {
-    // Fetch page
-    if (guard.IsEmpty()) {
-      break;
-    }
-    auto cur_page = guard.As<BPlusTreePage>();
-    // Search key
-    if (cur_page->IsLeafPage()) {
-      auto leaf_page = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-      int pos = LeafBinarySearch(leaf_page, key);
-      if (pos < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(pos), key) == 0) {
-        result->emplace_back(leaf_page->ValueAt(pos));
-        return true;
-      }
-      cur_page_id = INVALID_PAGE_ID;
-    } else {
-      auto page = guard.As<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-      int pos = InternalBinarySearch(page, key);
-      cur_page_id = page->ValueAt(pos);
-    }
-    // Latch coupling
-    if (cur_page_id != INVALID_PAGE_ID) {
-      ReadPageGuard child_guard = bpm_->FetchPageRead(cur_page_id);
-      guard = std::move(child_guard);
-    }
+  auto leaf_page = guard->As<LeafPage>();
+  int pos = leaf_page->KeyIndex(key, comparator_);
+  if (pos == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(pos), key) != 0) {
+    return false;
   }
-  return false;
+  ValueType value = leaf_page->ValueAt(pos);
+  if (PostingList::IsReference(value)) {
+    PostingList::Read(bpm_, PostingList::HeadPageId(value), result);
+  } else {
+    result->emplace_back(value);
+  }
+  return true;
 }
 
 /*****************************************************************************
@@ -127,135 +183,378 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: in a unique tree, if user try to insert duplicate keys return
+ * false; in a non-unique tree, if user try to insert a key & value pair that
+ * is already there return false; otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
-  WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
-  auto header_page = guard.AsMut<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
-    // New root page
-    page_id_t root_page_id;
-    BasicPageGuard guard = bpm_->NewPageGuarded(&root_page_id);
-    header_page->root_page_id_ = root_page_id;
-    auto root_page = guard.AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-    root_page->Init(leaf_max_size_);
+  OperationGuard op(this);
+  ReclaimPages();
+  std::vector<page_id_t> path;
+  std::optional<WritePageGuard> leaf_guard = FindLeaf<WritePageGuard>(&key, &path);
+  while (!leaf_guard.has_value()) {
+    {
+      WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
+      auto header_page = guard.AsMut<BPlusTreeHeaderPage>();
+      if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+        // New root page
+        page_id_t root_page_id;
+        BasicPageGuard root_guard = segment_.NewPageGuarded(&root_page_id);
+        root_guard.AsMut<LeafPage>()->Init(leaf_max_size_);
+        header_page->root_page_id_ = root_page_id;
+      }
+    }
+    leaf_guard = FindLeaf<WritePageGuard>(&key, &path);
   }
-  // Declaration of context instance.
-  Context ctx;
-  ctx.root_page_id_ = header_page->root_page_id_;
-  ctx.header_page_ = std::move(guard);
 
-  // Find place to insert
-  page_id_t cur_page_id = ctx.root_page_id_;
-  bool root_flag = true;
-  while (cur_page_id != INVALID_PAGE_ID) {
-    WritePageGuard guard = bpm_->FetchPageWrite(cur_page_id);
-    if (guard.IsEmpty()) {
-      return false;
-    }
-    auto page = guard.As<BPlusTreePage>();
-    if (page->IsLeafPage()) {
-      // Insert
-      auto leaf_page = guard.AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-      char *src = reinterpret_cast<char *>(leaf_page) + LEAF_PAGE_HEADER_SIZE +
-                  static_cast<int>(sizeof(MappingType)) * leaf_page->GetSize();
-      int pos = LeafBinarySearch(leaf_page, key);
-      if (pos < leaf_page->GetSize() && comparator_(key, leaf_page->KeyAt(pos)) == 0) {
-        return false;
+  auto leaf_page = leaf_guard->AsMut<LeafPage>();
+  int pos = leaf_page->KeyIndex(key, comparator_);
+  if (pos < leaf_page->GetSize() && comparator_(key, leaf_page->KeyAt(pos)) == 0) {
+    return !unique_ && InsertDuplicate(leaf_page, pos, value);
+  }
+  leaf_page->InsertAt(pos, key, value);
+  if (!leaf_page->IsOverflow()) {
+    return true;
+  }
+
+  // Split: the new leaf takes the upper half and the right link, and is reachable through the old leaf until its
+  // separator is in the parent.
+  page_id_t new_page_id;
+  BasicPageGuard new_guard = segment_.NewPageGuarded(&new_page_id);
+  auto new_leaf = new_guard.AsMut<LeafPage>();
+  new_leaf->Init(leaf_max_size_);
+  leaf_page->MoveTailTo(new_leaf, leaf_page->SplitIndex());
+  KeyType separator = ShortestSeparator(leaf_page->KeyAt(leaf_page->GetSize() - 1), new_leaf->KeyAt(0));
+  new_leaf->SetNextPageId(leaf_page->GetNextPageId());
+  new_leaf->SetHighKey(leaf_page->HighKey());
+  leaf_page->SetNextPageId(new_page_id);
+  leaf_page->SetHighKey(separator);
+  page_id_t leaf_page_id = leaf_guard->PageId();
+  new_guard.Drop();
+  leaf_guard = std::nullopt;
+  InsertIntoParent(&path, 0, leaf_page_id, separator, new_page_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(std::vector<page_id_t> *path, int level, page_id_t left_page_id,
+                                      const KeyType &separator, page_id_t right_page_id) {
+  KeyType sep = separator;
+  while (true) {
+    if (path->empty()) {
+      // The split page was the root, unless a split of the root is still adding the level above.
+      WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
+      auto header_page = guard.AsMut<BPlusTreeHeaderPage>();
+      if (header_page->root_page_id_ == left_page_id) {
+        page_id_t root_page_id;
+        BasicPageGuard root_guard = segment_.NewPageGuarded(&root_page_id);
+        auto root_page = root_guard.AsMut<InternalPage>();
+        root_page->Init(internal_max_size_);
+        root_page->SetValueAt(0, left_page_id);
+        root_page->InsertAt(1, sep, right_page_id);
+        header_page->root_page_id_ = root_page_id;
+        return;
       }
-      if (pos < leaf_page->GetSize()) {
-        src = reinterpret_cast<char *>(leaf_page) + LEAF_PAGE_HEADER_SIZE + static_cast<int>(sizeof(MappingType)) * pos;
-        memmove(src + sizeof(MappingType), src, sizeof(MappingType) * (leaf_page->GetSize() - pos));
+      guard.Drop();
+      std::this_thread::yield();
+      *path = PathTo(sep, level);
+      continue;
+    }
+
+    WritePageGuard guard = bpm_->FetchPageWrite(path->back());
+    path->pop_back();
+    while (!guard.As<BPlusTreePage>()->IsDeleted() && IsBeyond(guard.As<BPlusTreePage>(), sep)) {
+      BasicPageGuard next_guard = bpm_->FetchPageBasic(RightPageId(guard.As<BPlusTreePage>()));
+      guard.Drop();
+      guard = next_guard.UpgradeWrite();
+    }
+    if (guard.As<BPlusTreePage>()->IsDeleted()) {
+      // the parent was merged away, find the page that took its entries
+      guard.Drop();
+      *path = PathTo(sep, level);
+      continue;
+    }
+    auto parent_page = guard.AsMut<InternalPage>();
+    int pos = parent_page->ChildIndex(sep, comparator_);
+    bool linked;
+    {
+      // The new page goes right after the page that links to it. If that page split again and that split is not in
+      // the parent yet, wait for it.
+      ReadPageGuard child_guard = bpm_->FetchPageRead(parent_page->ValueAt(pos));
+      linked = RightPageId(child_guard.As<BPlusTreePage>()) == right_page_id;
+    }
+    if (!linked) {
+      guard.Drop();
+      std::this_thread::yield();
+      *path = PathTo(sep, level);
+      continue;
+    }
+    parent_page->InsertAt(pos + 1, sep, right_page_id);
+    if (!parent_page->IsOverflow()) {
+      return;
+    }
+
+    // The new page takes the upper half including its first key, which moves up to the parent.
+    page_id_t new_page_id;
+    BasicPageGuard new_guard = segment_.NewPageGuarded(&new_page_id);
+    auto new_page = new_guard.AsMut<InternalPage>();
+    new_page->Init(internal_max_size_);
+    new_page->SetSize(0);
+    parent_page->MoveTailTo(new_page, parent_page->SplitIndex());
+    sep = new_page->KeyAt(0);
+    new_page->SetRightPageId(parent_page->GetRightPageId());
+    new_page->SetHighKey(parent_page->HighKey());
+    parent_page->SetRightPageId(new_page_id);
+    parent_page->SetHighKey(sep);
+    left_page_id = guard.PageId();
+    right_page_id = new_page_id;
+    level++;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::PathTo(const KeyType &key, int level) -> std::vector<page_id_t> {
+  std::vector<page_id_t> path;
+  FindLeaf<ReadPageGuard>(&key, &path);
+  // the path holds one page per level from the root down to level 1
+  size_t keep = path.size() > static_cast<size_t>(level) ? path.size() - level : 0;
+  path.erase(path.begin() + keep, path.end());
+  return path;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsInsertSafe(const BPlusTreePage *page) -> bool {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->IsInsertSafe()
+                            : reinterpret_cast<const InternalPage *>(page)->IsInsertSafe();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsRemoveSafe(const BPlusTreePage *page) -> bool {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->IsRemoveSafe()
+                            : reinterpret_cast<const InternalPage *>(page)->IsRemoveSafe();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsOverflow(const BPlusTreePage *page) -> bool {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->IsOverflow()
+                            : reinterpret_cast<const InternalPage *>(page)->IsOverflow();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsUnderflow(const BPlusTreePage *page) -> bool {
+  return page->IsLeafPage() ? reinterpret_cast<const LeafPage *>(page)->IsUnderflow()
+                            : reinterpret_cast<const InternalPage *>(page)->IsUnderflow();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertDuplicate(LeafPage *leaf_page, int pos, const ValueType &value) -> bool {
+  ValueType existing = leaf_page->ValueAt(pos);
+  if (PostingList::IsReference(existing)) {
+    return PostingList::Insert(bpm_, PostingList::HeadPageId(existing), value);
+  }
+  if (existing == value) {
+    return false;
+  }
+  // The second value of a key moves both into a posting list.
+  std::vector<RID> rids{existing, value};
+  if (BPlusTreePostingPage::Order(value) < BPlusTreePostingPage::Order(existing)) {
+    std::swap(rids[0], rids[1]);
+  }
+  leaf_page->SetValueAt(pos, PostingList::MakeReference(PostingList::Create(bpm_, rids)));
+  return true;
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+namespace {
+
+/**
+ * Split entries of the given units (entry counts, or bytes for pages that fill by bytes) into nodes of about target
+ * units each, and at least min_size units each unless there is only one node. Nodes also hold between min_entries
+ * and max_entries entries when there are enough. @return the number of entries of each node, left to right
+ */
+auto SplitEvenly(const std::vector<size_t> &units, size_t target, size_t min_size, size_t min_entries,
+                 size_t max_entries) -> std::vector<int> {
+  size_t total = 0;
+  for (size_t unit : units) {
+    total += unit;
+  }
+  size_t min_nodes = std::max<size_t>(1, (units.size() + max_entries - 1) / max_entries);
+  size_t nodes = std::max(min_nodes, (total + target - 1) / target);
+  while (nodes > min_nodes && (total / nodes < min_size || units.size() / nodes < min_entries)) {
+    nodes--;
+  }
+  // cut where the running sum passes the next multiple of total / nodes
+  std::vector<int> sizes;
+  size_t sum = 0;
+  size_t begin = 0;
+  for (size_t i = 0; i < units.size(); i++) {
+    sum += units[i];
+    if (sizes.size() + 1 < nodes && sum * nodes >= total * (sizes.size() + 1) && i + 1 - begin >= min_entries) {
+      sizes.push_back(static_cast<int>(i + 1 - begin));
+      begin = i + 1;
+    }
+  }
+  sizes.push_back(static_cast<int>(units.size() - begin));
+  return sizes;
+}
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SortEntries(std::vector<MappingType> *entries) {
+  auto less = [this](const MappingType &lhs, const MappingType &rhs) { return comparator_(lhs.first, rhs.first) < 0; };
+  size_t runs = std::min<size_t>(std::thread::hardware_concurrency(), entries->size() / BULK_LOAD_SORT_RUN);
+  if (runs <= 1) {
+    std::stable_sort(entries->begin(), entries->end(), less);
+    return;
+  }
+
+  // Sort runs on their own threads, then merge neighbouring runs until one is left. Both steps keep equal keys in
+  // their input order.
+  std::vector<size_t> bounds;
+  for (size_t i = 0; i <= runs; i++) {
+    bounds.push_back(entries->size() * i / runs);
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < runs; i++) {
+    threads.emplace_back([&, i] {
+      std::stable_sort(entries->begin() + bounds[i], entries->begin() + bounds[i + 1], less);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  while (bounds.size() > 2) {
+    std::vector<size_t> merged_bounds;
+    threads.clear();
+    for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      merged_bounds.push_back(bounds[i]);
+      if (i + 2 < bounds.size()) {
+        threads.emplace_back([&, i] {
+          std::inplace_merge(entries->begin() + bounds[i], entries->begin() + bounds[i + 1],
+                             entries->begin() + bounds[i + 2], less);
+        });
       }
-      *(reinterpret_cast<MappingType *>(src)) = {key, value};
-      leaf_page->IncreaseSize(1);
-    } else {
-      // Search
-      auto page = guard.As<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-      int pos = InternalBinarySearch(page, key);
-      cur_page_id = page->ValueAt(pos);
     }
-    if (page->GetSize() < page->GetMaxSize()) {
-      if (root_flag) {
-        ctx.header_page_ = std::nullopt;
-      } else {
-        ctx.write_set_.clear();
+    merged_bounds.push_back(bounds.back());
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    bounds = std::move(merged_bounds);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoad(std::vector<MappingType> *entries, double fill_factor) {
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+  if (header_guard.As<BPlusTreeHeaderPage>()->root_page_id_ != INVALID_PAGE_ID) {
+    header_guard.Drop();
+    for (const auto &[key, value] : *entries) {
+      Insert(key, value);
+    }
+    return;
+  }
+  SortEntries(entries);
+  // Of equal keys, a unique tree keeps the first entry, and a non-unique tree puts their values into a posting list.
+  size_t num_keys = 0;
+  for (size_t begin = 0, end; begin < entries->size(); begin = end) {
+    end = begin + 1;
+    while (end < entries->size() && comparator_((*entries)[end].first, (*entries)[begin].first) == 0) {
+      end++;
+    }
+    (*entries)[num_keys] = (*entries)[begin];
+    if (!unique_ && end - begin > 1) {
+      std::vector<RID> rids;
+      for (size_t i = begin; i < end; i++) {
+        rids.push_back((*entries)[i].second);
+      }
+      std::sort(rids.begin(), rids.end(), [](const RID &lhs, const RID &rhs) {
+        return BPlusTreePostingPage::Order(lhs) < BPlusTreePostingPage::Order(rhs);
+      });
+      rids.erase(std::unique(rids.begin(), rids.end()), rids.end());
+      if (rids.size() > 1) {
+        (*entries)[num_keys].second = PostingList::MakeReference(PostingList::Create(bpm_, rids));
       }
     }
-    root_flag = false;
-    ctx.write_set_.emplace_front(std::move(guard));
-    if (page->IsLeafPage()) {
-      break;
+    num_keys++;
+  }
+  entries->resize(num_keys);
+  if (entries->empty()) {
+    return;
+  }
+
+  // Pack the leaves left to right. Pages are allocated in key order, so they are written back sequentially.
+  // Pages are sized in the units of LoadUnits, which count entries, or estimate bytes for pages that fill by bytes.
+  auto target_size = [fill_factor](size_t capacity) {
+    return std::clamp<size_t>(static_cast<size_t>(static_cast<double>(capacity) * fill_factor), 1, capacity);
+  };
+  std::vector<size_t> units;
+  for (size_t i = 0; i < entries->size(); i++) {
+    units.push_back(LeafPage::LoadUnits((*entries)[i > 0 ? i - 1 : 0].first, (*entries)[i].first));
+  }
+  size_t leaf_capacity = LeafPage::LoadCapacity(leaf_max_size_);
+  auto sizes = SplitEvenly(units, target_size(leaf_capacity), leaf_capacity / 2, 1,
+                           LeafPage::EffectiveMaxSize(leaf_max_size_));
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  BasicPageGuard prev_guard;
+  size_t next_entry = 0;
+  size_t planned_end = 0;
+  for (size_t node = 0; next_entry < entries->size(); node++) {
+    // the entries a page could not take after all go to the next page
+    planned_end = node + 1 < sizes.size() ? planned_end + sizes[node] : entries->size();
+    page_id_t page_id;
+    BasicPageGuard guard = segment_.NewPageGuarded(&page_id);
+    auto leaf_page = guard.AsMut<LeafPage>();
+    leaf_page->Init(leaf_max_size_);
+    // the separator from the previous leaf only needs to tell its last key from this leaf's first key
+    KeyType separator = next_entry == 0
+                            ? (*entries)[0].first
+                            : ShortestSeparator((*entries)[next_entry - 1].first, (*entries)[next_entry].first);
+    next_entry += leaf_page->LoadEntries(entries->data() + next_entry, static_cast<int>(planned_end - next_entry));
+    if (!prev_guard.IsEmpty()) {
+      prev_guard.AsMut<LeafPage>()->SetNextPageId(page_id);
+      prev_guard.AsMut<LeafPage>()->SetHighKey(separator);
     }
+    level.emplace_back(separator, page_id);
+    prev_guard = std::move(guard);
   }
+  prev_guard.Drop();
 
-  // Check if break rules
-  size_t idx = 0;
-  for (auto &guard : ctx.write_set_) {
-    // Check
-    auto page = guard.As<BPlusTreePage>();
-    auto cur_page_id = guard.PageId();
-    if (page->GetSize() <= page->GetMaxSize()) {
-      break;
+  // Build the internal levels on top of each other, until a level has a single node.
+  size_t internal_capacity = InternalPage::LoadCapacity(internal_max_size_);
+  while (level.size() > 1) {
+    units.clear();
+    for (size_t i = 0; i < level.size(); i++) {
+      units.push_back(InternalPage::LoadUnits(level[i > 0 ? i - 1 : 0].first, level[i].first));
     }
-    // Split
-    auto m_page = guard.AsMut<BPlusTreePage>();
-    int m = m_page->GetSize();
-    page_id_t new_page_id;
-    auto new_page_guard = bpm_->NewPageGuarded(&new_page_id);
-    auto new_page = new_page_guard.AsMut<BPlusTreePage>();
-    KeyType *mid_key;
-    if (m_page->IsLeafPage()) {
-      reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(new_page)->Init(leaf_max_size_);
-      page_id_t n_page_id =
-          reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(m_page)->GetNextPageId();
-      reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(new_page)->SetNextPageId(n_page_id);
-      reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(m_page)->SetNextPageId(new_page_id);
-      new_page->SetSize((m + 1) / 2);
-      char *src = reinterpret_cast<char *>(m_page) + LEAF_PAGE_HEADER_SIZE + (m / 2) * sizeof(MappingType);
-      memmove(reinterpret_cast<char *>(new_page) + LEAF_PAGE_HEADER_SIZE, src, (m + 1) / 2 * sizeof(MappingType));
-      mid_key = reinterpret_cast<KeyType *>(src);
-      m_page->SetSize(m / 2);
-    } else {
-      reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(new_page)->Init(internal_max_size_);
-      new_page->SetSize((m + 1) / 2);
-      char *src = reinterpret_cast<char *>(m_page) + INTERNAL_PAGE_HEADER_SIZE +
-                  (m / 2) * sizeof(std::pair<KeyType, page_id_t>);
-      memmove(reinterpret_cast<char *>(new_page) + INTERNAL_PAGE_HEADER_SIZE, src,
-              (m + 1) / 2 * sizeof(std::pair<KeyType, page_id_t>));
-      mid_key = reinterpret_cast<KeyType *>(src);
-      m_page->SetSize(m / 2);
-    }
-    if (ctx.IsRootPage(guard.PageId())) {
-      // New root page
-      page_id_t root_page_id;
-      BasicPageGuard guard = bpm_->NewPageGuarded(&root_page_id);
-      header_page->root_page_id_ = root_page_id;
-      auto root_page = guard.AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-      root_page->Init(internal_max_size_);
-      root_page->SetSize(2);
-      root_page->SetKeyAt(1, *mid_key);
-      root_page->SetValueAt(0, cur_page_id);
-      root_page->SetValueAt(1, new_page_id);
-    } else {
-      auto &par_guard = ctx.write_set_[idx + 1];
-      auto par_page = par_guard.AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-      int pos = InternalBinarySearch(par_page, *mid_key) + 1;
-      if (pos < par_page->GetSize()) {
-        size_t pair_size = sizeof(std::pair<KeyType, page_id_t>);
-        char *src = reinterpret_cast<char *>(par_page) + INTERNAL_PAGE_HEADER_SIZE + pos * pair_size;
-        memmove(src + pair_size, src, pair_size * (par_page->GetSize() - pos));
+    sizes = SplitEvenly(units, std::max<size_t>(2, target_size(internal_capacity)),
+                        std::max<size_t>(2, internal_capacity / 2), 2,
+                        InternalPage::EffectiveMaxSize(internal_max_size_));
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    size_t next_child = 0;
+    prev_guard.Drop();
+    planned_end = 0;
+    for (size_t node = 0; next_child < level.size(); node++) {
+      planned_end = node + 1 < sizes.size() ? planned_end + sizes[node] : level.size();
+      page_id_t page_id;
+      BasicPageGuard guard = segment_.NewPageGuarded(&page_id);
+      auto internal_page = guard.AsMut<InternalPage>();
+      internal_page->Init(internal_max_size_);
+      // the first key of a node moves up to its parent
+      parents.emplace_back(level[next_child].first, page_id);
+      if (!prev_guard.IsEmpty()) {
+        prev_guard.AsMut<InternalPage>()->SetRightPageId(page_id);
+        prev_guard.AsMut<InternalPage>()->SetHighKey(level[next_child].first);
       }
-      par_page->IncreaseSize(1);
-      par_page->SetKeyAt(pos, *mid_key);
-      par_page->SetValueAt(pos - 1, cur_page_id);
-      par_page->SetValueAt(pos, new_page_id);
+      next_child += internal_page->LoadEntries(level.data() + next_child, static_cast<int>(planned_end - next_child));
+      prev_guard = std::move(guard);
     }
-    idx++;
+    level = std::move(parents);
   }
-  return true;
+  header_guard.AsMut<BPlusTreeHeaderPage>()->root_page_id_ = level[0].second;
 }
 
 /*****************************************************************************
@@ -270,6 +569,58 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
+  RemoveEntry(key, nullptr, txn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *txn) {
+  RemoveEntry(key, &value, txn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *txn) {
+  {
+    OperationGuard op(this);
+    // Optimistic pass: most deletes leave the leaf at least half full, so only the leaf is write-latched.
+    if (!RemoveFromLeaf(key, value, false)) {
+      RemoveWithRebalance(key, value);
+    }
+  }
+  ReclaimPages();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, const ValueType *value, bool allow_underflow) -> bool {
+  std::vector<page_id_t> path;
+  std::optional<WritePageGuard> leaf_guard = FindLeaf<WritePageGuard>(&key, &path);
+  if (!leaf_guard.has_value()) {
+    return true;
+  }
+  auto leaf_page = leaf_guard->AsMut<LeafPage>();
+  int pos = leaf_page->KeyIndex(key, comparator_);
+  if (pos == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(pos), key) != 0) {
+    return true;
+  }
+  if (!RemoveFromEntry(leaf_page, pos, value)) {
+    return true;
+  }
+  bool is_root = path.empty() && leaf_page->GetNextPageId() == INVALID_PAGE_ID;
+  if (!allow_underflow && !is_root && !leaf_page->IsRemoveSafe()) {
+    return false;
+  }
+  RemoveEntryAt(leaf_page, pos);
+  return true;
+}
+
+/*
+ * Remove key with the leaf's siblings and parents write latched from the header
+ * down, to redistribute or merge the pages that underflow. Pages only lend to or
+ * merge with their left sibling when it links to them, not while a split of the
+ * left sibling is still adding its separator to the parent; then the page stays
+ * less than half full, as it does when the merged pages would not fit into one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveWithRebalance(const KeyType &key, const ValueType *value) {
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto header_page = guard.AsMut<BPlusTreeHeaderPage>();
   if (header_page->root_page_id_ == INVALID_PAGE_ID) {
@@ -289,24 +640,32 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
       return;
     }
     auto page = guard.As<BPlusTreePage>();
+    if (IsBeyond(page, key)) {
+      // A split has not reached the parent yet, so the key's page cannot be rebalanced through it. Leave the leaf
+      // less than half full instead.
+      ctx.write_set_.clear();
+      ctx.header_page_ = std::nullopt;
+      guard.Drop();
+      RemoveFromLeaf(key, value, true);
+      return;
+    }
     if (page->IsLeafPage()) {
-      auto leaf_page = guard.AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-      int pos = LeafBinarySearch(leaf_page, key);
-      if (pos < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(pos), key) == 0) {
-        char *src =
-            reinterpret_cast<char *>(leaf_page) + LEAF_PAGE_HEADER_SIZE + static_cast<int>(sizeof(MappingType)) * pos;
-        memmove(src, src + sizeof(MappingType), sizeof(MappingType) * (leaf_page->GetSize() - pos - 1));
-      } else {
+      auto leaf_page = guard.AsMut<LeafPage>();
+      int pos = leaf_page->KeyIndex(key, comparator_);
+      if (pos == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(pos), key) != 0) {
+        return;
+      }
+      if (!RemoveFromEntry(leaf_page, pos, value)) {
         return;
       }
-      leaf_page->IncreaseSize(-1);
+      RemoveEntryAt(leaf_page, pos);
     } else {
       // Search
-      auto page = guard.As<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-      int pos = InternalBinarySearch(page, key);
+      auto page = guard.As<InternalPage>();
+      int pos = page->ChildIndex(key, comparator_);
       cur_page_id = page->ValueAt(pos);
     }
-    if (page->GetSize() > page->GetMinSize()) {
+    if (IsRemoveSafe(page)) {
       if (root_flag) {
         ctx.header_page_ = std::nullopt;
       } else {
@@ -326,7 +685,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     // Check
     auto page = guard.As<BPlusTreePage>();
     auto cur_page_id = guard.PageId();
-    if (page->GetSize() >= page->GetMinSize()) {
+    if (!IsUnderflow(page)) {
       break;
     }
 
@@ -334,173 +693,201 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     if (!ctx.IsRootPage(guard.PageId())) {
       // Find brother page
       auto &par_guard = ctx.write_set_[idx + 1];
-      auto par_page = par_guard.AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
+      auto par_page = par_guard.AsMut<InternalPage>();
       int i = 0;
       for (; i < par_page->GetSize(); i++) {
         if (par_page->ValueAt(i) == cur_page_id) {
           break;
         }
       }
+      // A parent left with one child, after its own merge did not fit, has no sibling to lend or merge with.
+      if (par_page->GetSize() == 1) {
+        break;
+      }
 
       if (page->IsLeafPage()) {
-        auto cur_page = guard.AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
+        auto cur_page = guard.AsMut<LeafPage>();
         // Distribute
         if (i != 0) {
           WritePageGuard guard = bpm_->FetchPageWrite(par_page->ValueAt(i - 1));
-          auto bro_page = guard.AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-          if (bro_page->GetSize() > bro_page->GetMinSize()) {
-            par_page->SetKeyAt(i, bro_page->KeyAt(bro_page->GetSize() - 1));
-            char *src = reinterpret_cast<char *>(cur_page) + LEAF_PAGE_HEADER_SIZE;
-            memmove(src + sizeof(MappingType), src, cur_page->GetSize() * sizeof(MappingType));
-            char *b_src = reinterpret_cast<char *>(bro_page) + LEAF_PAGE_HEADER_SIZE +
-                          (bro_page->GetSize() - 1) * sizeof(MappingType);
-            memmove(src, b_src, sizeof(MappingType));
-            bro_page->IncreaseSize(-1);
-            cur_page->IncreaseSize(1);
-            break;
-          }
-        }
-        if ((i + 1) != par_page->GetSize()) {
-          WritePageGuard guard = bpm_->FetchPageWrite(par_page->ValueAt(i + 1));
-          auto bro_page = guard.AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-          if (bro_page->GetSize() > bro_page->GetMinSize()) {
-            par_page->SetKeyAt(i + 1, bro_page->KeyAt(1));
-            char *src =
-                reinterpret_cast<char *>(cur_page) + LEAF_PAGE_HEADER_SIZE + cur_page->GetSize() * sizeof(MappingType);
-            char *b_src = reinterpret_cast<char *>(bro_page) + LEAF_PAGE_HEADER_SIZE;
-            memmove(src, b_src, sizeof(MappingType));
-            memmove(b_src, b_src + sizeof(MappingType), (bro_page->GetSize() - 1) * sizeof(MappingType));
-            bro_page->IncreaseSize(-1);
-            cur_page->IncreaseSize(1);
-            break;
+          auto bro_page = guard.AsMut<LeafPage>();
+          if (bro_page->GetNextPageId() == cur_page_id && bro_page->CanLend()) {
+            int last = bro_page->GetSize() - 1;
+            KeyType separator = ShortestSeparator(bro_page->KeyAt(last - 1), bro_page->KeyAt(last));
+            if (par_page->CanSetKeyAt(i, separator)) {
+              cur_page->InsertAt(0, bro_page->KeyAt(last), bro_page->ValueAt(last));
+              par_page->SetKeyAt(i, separator);
+              bro_page->RemoveAt(last);
+              bro_page->SetHighKey(separator);
+              break;
+            }
           }
         }
         // Merge
         page_id_t front_page_id;
         page_id_t back_page_id;
-        BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *front_page;
-        BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *back_page;
-        size_t pair_size = sizeof(std::pair<KeyType, page_id_t>);
+        LeafPage *front_page;
+        LeafPage *back_page;
+        // Writers that found the sibling safe hold only its latch, so keep it latched while merging.
+        WritePageGuard bro_guard;
         if (i != 0) {
           front_page_id = par_page->ValueAt(i - 1);
           back_page_id = cur_page_id;
           back_page = cur_page;
-          front_page =
-              bpm_->FetchPageWrite(front_page_id).AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-          char *dst = reinterpret_cast<char *>(par_page) + INTERNAL_PAGE_HEADER_SIZE + i * pair_size;
-          memmove(dst, dst + pair_size, (par_page->GetSize() - i - 1) * pair_size);
-          par_page->IncreaseSize(-1);
+          bro_guard = bpm_->FetchPageWrite(front_page_id);
+          front_page = bro_guard.AsMut<LeafPage>();
         } else {
           front_page_id = cur_page_id;
           back_page_id = par_page->ValueAt(1);
           front_page = cur_page;
-          back_page = bpm_->FetchPageWrite(back_page_id).AsMut<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-          char *dst = reinterpret_cast<char *>(par_page) + INTERNAL_PAGE_HEADER_SIZE;
-          memmove(dst, dst + pair_size, (par_page->GetSize() - 1) * pair_size);
-          par_page->SetValueAt(0, front_page_id);
-          par_page->IncreaseSize(-1);
+          bro_guard = bpm_->FetchPageWrite(back_page_id);
+          back_page = bro_guard.AsMut<LeafPage>();
         }
-        char *dst =
-            reinterpret_cast<char *>(front_page) + LEAF_PAGE_HEADER_SIZE + front_page->GetSize() * sizeof(MappingType);
-        char *src = reinterpret_cast<char *>(back_page) + LEAF_PAGE_HEADER_SIZE;
-        memmove(dst, src, back_page->GetSize() * sizeof(MappingType));
-        front_page->IncreaseSize(back_page->GetSize());
+        // Pages that fill by bytes may not fit into each other, and then stay less than half full.
+        if (front_page->GetNextPageId() != back_page_id || !front_page->CanMergeWith(back_page)) {
+          break;
+        }
+        par_page->RemoveAt(i != 0 ? i : 1);
+        back_page->MoveTailTo(front_page, 0);
         front_page->SetNextPageId(back_page->GetNextPageId());
+        front_page->SetHighKey(back_page->HighKey());
+        back_page->SetDeleted();
         if (back_page_id == cur_page_id) {
           guard.Drop();
+        } else {
+          bro_guard.Drop();
         }
-        bpm_->UnpinPage(back_page_id, true);
-        BUSTUB_ASSERT(bpm_->DeletePage(back_page_id), "Page cannot be deleted.");
+        RetirePage(back_page_id);
       } else {
-        auto cur_page = guard.AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
+        auto cur_page = guard.AsMut<InternalPage>();
         // Distribute
         if (i != 0) {
           WritePageGuard guard = bpm_->FetchPageWrite(par_page->ValueAt(i - 1));
-          auto bro_page = guard.AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-          if (bro_page->GetSize() > bro_page->GetMinSize()) {
-            char *src = reinterpret_cast<char *>(cur_page) + INTERNAL_PAGE_HEADER_SIZE;
-            memmove(src + sizeof(std::pair<KeyType, page_id_t>), src,
-                    cur_page->GetSize() * sizeof(std::pair<KeyType, page_id_t>));
+          auto bro_page = guard.AsMut<InternalPage>();
+          int last = bro_page->GetSize() - 1;
+          if (bro_page->GetRightPageId() == cur_page_id && bro_page->CanLend() &&
+              par_page->CanSetKeyAt(i, bro_page->KeyAt(last))) {
+            cur_page->InsertAt(0, bro_page->KeyAt(last), bro_page->ValueAt(last));
             cur_page->SetKeyAt(1, par_page->KeyAt(i));
-            par_page->SetKeyAt(i, bro_page->KeyAt(bro_page->GetSize() - 1));
-            char *b_src = reinterpret_cast<char *>(bro_page) + INTERNAL_PAGE_HEADER_SIZE +
-                          (bro_page->GetSize() - 1) * sizeof(std::pair<KeyType, page_id_t>);
-            memmove(src, b_src, sizeof(std::pair<KeyType, page_id_t>));
-            bro_page->IncreaseSize(-1);
-            cur_page->IncreaseSize(1);
-            break;
-          }
-        }
-        if ((i + 1) != par_page->GetSize()) {
-          WritePageGuard guard = bpm_->FetchPageWrite(par_page->ValueAt(i + 1));
-          auto bro_page = guard.AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-          if (bro_page->GetSize() > bro_page->GetMinSize()) {
-            char *src = reinterpret_cast<char *>(cur_page) + INTERNAL_PAGE_HEADER_SIZE +
-                        cur_page->GetSize() * sizeof(std::pair<KeyType, page_id_t>);
-            char *b_src = reinterpret_cast<char *>(bro_page) + INTERNAL_PAGE_HEADER_SIZE;
-            memmove(src, b_src, sizeof(std::pair<KeyType, page_id_t>));
-            cur_page->IncreaseSize(1);
-            cur_page->SetKeyAt(cur_page->GetSize() - 1, par_page->KeyAt(i + 1));
-            par_page->SetKeyAt(i + 1, bro_page->KeyAt(1));
-            memmove(b_src, b_src + sizeof(std::pair<KeyType, page_id_t>),
-                    (bro_page->GetSize() - 1) * sizeof(std::pair<KeyType, page_id_t>));
-            bro_page->IncreaseSize(-1);
+            par_page->SetKeyAt(i, bro_page->KeyAt(last));
+            bro_page->SetHighKey(bro_page->KeyAt(last));
+            bro_page->RemoveAt(last);
             break;
           }
         }
         // Merge
         page_id_t front_page_id;
         page_id_t back_page_id;
-        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *front_page;
-        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *back_page;
+        InternalPage *front_page;
+        InternalPage *back_page;
+        WritePageGuard bro_guard;
         if (i != 0) {
           front_page_id = par_page->ValueAt(i - 1);
           back_page_id = cur_page_id;
           back_page = cur_page;
-          front_page =
-              bpm_->FetchPageWrite(front_page_id).AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-          back_page->SetKeyAt(0, par_page->KeyAt(i));
-          char *dst = reinterpret_cast<char *>(par_page) + INTERNAL_PAGE_HEADER_SIZE +
-                      i * sizeof(std::pair<KeyType, page_id_t>);
-          memmove(dst, dst + sizeof(std::pair<KeyType, page_id_t>),
-                  (par_page->GetSize() - i - 1) * sizeof(std::pair<KeyType, page_id_t>));
-          par_page->IncreaseSize(-1);
+          bro_guard = bpm_->FetchPageWrite(front_page_id);
+          front_page = bro_guard.AsMut<InternalPage>();
         } else {
           front_page_id = cur_page_id;
           back_page_id = par_page->ValueAt(1);
           front_page = cur_page;
-          back_page =
-              bpm_->FetchPageWrite(back_page_id).AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-          back_page->SetKeyAt(0, par_page->KeyAt(1));
-          char *dst = reinterpret_cast<char *>(par_page) + INTERNAL_PAGE_HEADER_SIZE;
-          memmove(dst, dst + sizeof(std::pair<KeyType, page_id_t>),
-                  (par_page->GetSize() - 1) * sizeof(std::pair<KeyType, page_id_t>));
-          par_page->SetValueAt(0, front_page_id);
-          par_page->IncreaseSize(-1);
+          bro_guard = bpm_->FetchPageWrite(back_page_id);
+          back_page = bro_guard.AsMut<InternalPage>();
+        }
+        if (front_page->GetRightPageId() != back_page_id) {
+          break;
         }
-        char *dst = reinterpret_cast<char *>(front_page) + INTERNAL_PAGE_HEADER_SIZE +
-                    front_page->GetSize() * sizeof(std::pair<KeyType, page_id_t>);
-        char *src = reinterpret_cast<char *>(back_page) + INTERNAL_PAGE_HEADER_SIZE;
-        memmove(dst, src, back_page->GetSize() * sizeof(std::pair<KeyType, page_id_t>));
-        front_page->IncreaseSize(back_page->GetSize());
+        back_page->SetKeyAt(0, par_page->KeyAt(i != 0 ? i : 1));
+        if (!front_page->CanMergeWith(back_page)) {
+          break;
+        }
+        par_page->RemoveAt(i != 0 ? i : 1);
+        back_page->MoveTailTo(front_page, 0);
+        front_page->SetRightPageId(back_page->GetRightPageId());
+        front_page->SetHighKey(back_page->HighKey());
+        back_page->SetDeleted();
         if (back_page_id == cur_page_id) {
           guard.Drop();
+        } else {
+          bro_guard.Drop();
         }
-        bpm_->UnpinPage(back_page_id, true);
-        BUSTUB_ASSERT(bpm_->DeletePage(back_page_id), "Page cannot be deleted.");
+        RetirePage(back_page_id);
       }
     } else {
-      if (!page->IsLeafPage() && page->GetSize() == 1) {
-        header_page->root_page_id_ = guard.As<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>()->ValueAt(0);
+      // A root that split keeps its only child until the new root above it is in place.
+      if (!page->IsLeafPage() && page->GetSize() == 1 && RightPageId(page) == INVALID_PAGE_ID) {
+        header_page->root_page_id_ = guard.As<InternalPage>()->ValueAt(0);
+        guard.AsMut<BPlusTreePage>()->SetDeleted();
         guard.Drop();
-        bpm_->UnpinPage(cur_page_id, true);
-        BUSTUB_ASSERT(bpm_->DeletePage(cur_page_id), "Page cannot be deleted.");
+        RetirePage(cur_page_id);
       }
     }
     idx++;
   }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveFromEntry(LeafPage *leaf_page, int pos, const ValueType *value) -> bool {
+  if (value == nullptr) {
+    return true;
+  }
+  ValueType existing = leaf_page->ValueAt(pos);
+  if (!PostingList::IsReference(existing)) {
+    return existing == *value;
+  }
+  page_id_t head_page_id = PostingList::HeadPageId(existing);
+  if (PostingList::Remove(bpm_, head_page_id, *value) && PostingList::Size(bpm_, head_page_id) == 1) {
+    // The last value moves back into the leaf.
+    std::vector<RID> rids;
+    PostingList::Read(bpm_, head_page_id, &rids);
+    PostingList::Drop(bpm_, head_page_id);
+    leaf_page->SetValueAt(pos, rids[0]);
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntryAt(LeafPage *leaf_page, int pos) {
+  ValueType existing = leaf_page->ValueAt(pos);
+  if (PostingList::IsReference(existing)) {
+    PostingList::Drop(bpm_, PostingList::HeadPageId(existing));
+  }
+  leaf_page->RemoveAt(pos);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RetirePage(page_id_t page_id) {
+  std::scoped_lock lock(retired_latch_);
+  // The page is unlinked already, so the operations that can still reach it started in this epoch or before.
+  retired_pages_.emplace_back(epoch_.load(), page_id);
+  num_retired_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReclaimPages() {
+  if (num_retired_.load() == 0) {
+    return;
+  }
+  std::scoped_lock lock(retired_latch_);
+  // Once no operation of the previous epoch is left, every running operation started in the current one. The caller
+  // may be one of them: it cannot reach the pages deleted here, which were retired two epochs ago. When no operation
+  // is running, advancing twice frees every retired page.
+  uint64_t epoch = epoch_.load();
+  for (int i = 0; i < 2; i++) {
+    if ((epoch != 0 && active_ops_[(epoch - 1) % NUM_EPOCH_SLOTS].load() != 0) ||
+        !epoch_.compare_exchange_strong(epoch, epoch + 1)) {
+      break;
+    }
+    epoch++;
+  }
+  // Pages that are still pinned stay retired until a later call.
+  auto deleted = std::remove_if(retired_pages_.begin(), retired_pages_.end(), [&](const auto &retired) {
+    return retired.first + 2 <= epoch && segment_.DeletePage(retired.second);
+  });
+  retired_pages_.erase(deleted, retired_pages_.end());
+  num_retired_ = retired_pages_.size();
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -511,80 +898,108 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  // find the leftmost leaf page
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = guard.As<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+  OperationGuard op(this);
+  std::optional<ReadPageGuard> guard = FindLeaf<ReadPageGuard>(nullptr);
+  if (!guard.has_value()) {
     return INDEXITERATOR_TYPE();
   }
-  page_id_t cur_page_id = header_page->root_page_id_;
-  ReadPageGuard root_guard = bpm_->FetchPageRead(cur_page_id);
-  guard = std::move(root_guard);
-  while (cur_page_id != INVALID_PAGE_ID) {
-    // Fetch page
-    if (guard.IsEmpty()) {
-      return INDEXITERATOR_TYPE();
-    }
-    auto cur_page = guard.As<BPlusTreePage>();
-    if (cur_page->IsLeafPage()) {
-      break;
-    }
-    auto page = guard.As<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-    cur_page_id = page->ValueAt(0);
-    // Latch coupling
-    if (cur_page_id != INVALID_PAGE_ID) {
-      ReadPageGuard child_guard = bpm_->FetchPageRead(cur_page_id);
-      guard = std::move(child_guard);
-    }
-  }
-
-  // construct index iterator
-  return INDEXITERATOR_TYPE(cur_page_id, 0, bpm_);
+  // construct index iterator, which keeps the leaf latched
+  return INDEXITERATOR_TYPE(this, bpm_, std::move(*guard), 0);
 }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
  * first, then construct index iterator
- * @return : index iterator
+ * @return : index iterator positioned at the first key that is not less than
+ * the input key
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = guard.As<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+  OperationGuard op(this);
+  std::optional<ReadPageGuard> guard = FindLeaf<ReadPageGuard>(&key);
+  if (!guard.has_value()) {
     return INDEXITERATOR_TYPE();
   }
-  page_id_t cur_page_id = header_page->root_page_id_;
-  ReadPageGuard root_guard = bpm_->FetchPageRead(cur_page_id);
-  guard = std::move(root_guard);
-  int idx = -1;
-  while (cur_page_id != INVALID_PAGE_ID) {
-    // Fetch page
-    if (guard.IsEmpty()) {
+  // If every key of this leaf is smaller, the iterator moves on to the next leaf.
+  int idx = guard->As<LeafPage>()->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(this, bpm_, std::move(*guard), idx);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE {
+  return RBegin([](const KeyType & /* key */) { return true; });
+}
+
+/*
+ * Descend like FindLeaf, but into the last child whose separator satisfies
+ * pred, and right while the high key does. If the leaf holds no key that
+ * satisfies pred, all such keys are less than the separator that led to it,
+ * so search again for keys less than that. Leaves are never latched right to
+ * left, so the iterator moves to the previous leaf the same way.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const std::function<bool(const KeyType &)> &pred) -> INDEXITERATOR_TYPE {
+  OperationGuard op(this);
+  std::optional<KeyType> fence;
+  auto matches = [&](const KeyType &key) { return pred(key) && (!fence.has_value() || comparator_(key, *fence) < 0); };
+  while (true) {
+    ReadPageGuard guard = FetchHeaderRead();
+    page_id_t root_page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
       return INDEXITERATOR_TYPE();
     }
-    auto cur_page = guard.As<BPlusTreePage>();
-    if (cur_page->IsLeafPage()) {
-      auto leaf_page = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-      int pos = LeafBinarySearch(leaf_page, key);
-      if (pos < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(pos), key) == 0) {
-        idx = pos;
+    Descend(&guard, root_page_id);
+    // the keys of the current page are not less than low
+    std::optional<KeyType> low;
+    while (true) {
+      auto page = guard.As<BPlusTreePage>();
+      if (page->IsDeleted()) {
+        break;
       }
-      break;
-    }
-    auto page = guard.As<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-    int pos = InternalBinarySearch(page, key);
-    cur_page_id = page->ValueAt(pos);
-    // Latch coupling
-    if (cur_page_id != INVALID_PAGE_ID) {
-      ReadPageGuard child_guard = bpm_->FetchPageRead(cur_page_id);
-      guard = std::move(child_guard);
+      page_id_t next_page_id;
+      if (RightPageId(page) != INVALID_PAGE_ID && matches(HighKey(page))) {
+        low = HighKey(page);
+        next_page_id = RightPageId(page);
+      } else if (!page->IsLeafPage()) {
+        auto internal_page = guard.As<InternalPage>();
+        int left = 1;
+        int right = internal_page->GetSize();
+        while (left < right) {
+          int mid = (left + right) / 2;
+          if (matches(internal_page->KeyAt(mid))) {
+            left = mid + 1;
+          } else {
+            right = mid;
+          }
+        }
+        if (left > 1) {
+          low = internal_page->KeyAt(left - 1);
+        }
+        next_page_id = internal_page->ValueAt(left - 1);
+      } else {
+        auto leaf_page = guard.As<LeafPage>();
+        int left = 0;
+        int right = leaf_page->GetSize();
+        while (left < right) {
+          int mid = (left + right) / 2;
+          if (matches(leaf_page->KeyAt(mid))) {
+            left = mid + 1;
+          } else {
+            right = mid;
+          }
+        }
+        if (left > 0) {
+          return INDEXITERATOR_TYPE(this, bpm_, std::move(guard), left - 1, true);
+        }
+        if (!low.has_value()) {
+          return INDEXITERATOR_TYPE();
+        }
+        fence = low;
+        break;
+      }
+      Descend(&guard, next_page_id);
     }
   }
-  if (idx == -1 || cur_page_id == INVALID_PAGE_ID) {
-    return INDEXITERATOR_TYPE();
-  }
-  return INDEXITERATOR_TYPE(cur_page_id, idx, bpm_);
 }
 
 /*
@@ -600,7 +1015,7 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE();
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  ReadPageGuard guard = FetchHeaderRead();
   auto header_page = guard.As<BPlusTreeHeaderPage>();
   return header_page->root_page_id_;
 }
@@ -862,4 +1277,14 @@ template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<PackedIntegerKey, RID, PackedIntegerComparator>;
+
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
@@ -11,24 +11,29 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include "type/value_factory.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
-    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
+    : BPlusTreeIndexBase(std::move(metadata)),
+      comparator_(IsCovering() && !GetMetadata()->IsUnique() ? GetEntrySchema() : GetKeySchema()),
+      key_comparator_(GetKeySchema()) {
   page_id_t header_page_id;
   buffer_pool_manager->NewPage(&header_page_id);
-  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
-                                                                              buffer_pool_manager, comparator_);
+  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+      GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_, LEAF_PAGE_SIZE - 1,
+      INTERNAL_PAGE_SIZE - 1, GetMetadata()->IsUnique());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetEntrySchema());
 
   return container_->Insert(index_key, rid, transaction);
 }
@@ -37,20 +42,135 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetEntrySchema());
 
-  container_->Remove(index_key, transaction);
+  // a non-unique index removes only the entry of this tuple
+  if (GetMetadata()->IsUnique()) {
+    container_->Remove(index_key, transaction);
+  } else {
+    container_->Remove(index_key, rid, transaction);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
-  KeyType index_key;
-  index_key.SetFromKey(key);
+  KeyType index_key = ProbeKey(key);
 
+  if (IsCovering() && !GetMetadata()->IsUnique()) {
+    // the entries of the key are ordered by their included columns, which the probe sorts before
+    for (auto iter = container_->Begin(index_key); !iter.IsEnd() && key_comparator_((*iter).first, index_key) == 0;
+         ++iter) {
+      result->push_back((*iter).second);
+    }
+    return;
+  }
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ProbeKey(const Tuple &key) -> KeyType {
+  KeyType index_key;
+  if (!IsCovering()) {
+    index_key.SetFromKey(key, *GetKeySchema());
+    return index_key;
+  }
+  std::vector<Value> values;
+  for (uint32_t i = 0; i < GetEntrySchema()->GetColumnCount(); i++) {
+    values.push_back(i < GetKeySchema()->GetColumnCount()
+                         ? key.GetValue(GetKeySchema(), i)
+                         : ValueFactory::GetNullValueByType(GetEntrySchema()->GetColumn(i).GetType()));
+  }
+  index_key.SetFromKey(Tuple(values, GetEntrySchema()), *GetEntrySchema());
+  return index_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(std::vector<MappingType> *entries) {
+  container_->BulkLoad(entries);
+}
+
+namespace {
+
+/** Adapts an IndexIterator to the cursor interface. */
+INDEX_TEMPLATE_ARGUMENTS
+class IteratorCursor : public BPlusTreeIndexCursor {
+ public:
+  IteratorCursor(INDEXITERATOR_TYPE iter, Schema *entry_schema) : iter_(std::move(iter)), entry_schema_(entry_schema) {}
+
+  auto IsEnd() -> bool override { return iter_.IsEnd(); }
+
+  auto GetRID() -> RID override { return (*iter_).second; }
+
+  void GetEntry(std::vector<Value> *values) override {
+    values->clear();
+    const auto &key = (*iter_).first;
+    for (uint32_t i = 0; i < entry_schema_->GetColumnCount(); i++) {
+      values->push_back(key.ToValue(entry_schema_, i));
+    }
+  }
+
+  void Next() override { ++iter_; }
+
+  auto NextBatch(std::vector<RID> *rids, size_t max_size) -> size_t override {
+    rids->clear();
+    iter_.NextBatch(&batch_, max_size);
+    for (const auto &entry : batch_) {
+      rids->push_back(entry.second);
+    }
+    return rids->size();
+  }
+
+ private:
+  INDEXITERATOR_TYPE iter_;
+  Schema *entry_schema_;
+  std::vector<MappingType> batch_;
+};
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::Scan() -> std::unique_ptr<BPlusTreeIndexCursor> {
+  return std::make_unique<IteratorCursor<KeyType, ValueType, KeyComparator>>(container_->Begin(), GetEntrySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::Scan(const Tuple &key) -> std::unique_ptr<BPlusTreeIndexCursor> {
+  return std::make_unique<IteratorCursor<KeyType, ValueType, KeyComparator>>(container_->Begin(ProbeKey(key)),
+                                                                            GetEntrySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ReverseScan() -> std::unique_ptr<BPlusTreeIndexCursor> {
+  return std::make_unique<IteratorCursor<KeyType, ValueType, KeyComparator>>(container_->RBegin(), GetEntrySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ReverseScan(const std::vector<Value> &bound) -> std::unique_ptr<BPlusTreeIndexCursor> {
+  // A bound on a prefix of the columns has no key to compare with, so compare the columns decoded from the keys.
+  auto *entry_schema = GetEntrySchema();
+  auto not_greater = [&](const KeyType &key) {
+    for (uint32_t i = 0; i < bound.size(); i++) {
+      Value value = key.ToValue(entry_schema, i);
+      if (value.IsNull() || bound[i].IsNull()) {
+        if (value.IsNull() != bound[i].IsNull()) {
+          return value.IsNull();
+        }
+        continue;
+      }
+      if (value.CompareLessThan(bound[i]) == CmpBool::CmpTrue) {
+        return true;
+      }
+      if (value.CompareGreaterThan(bound[i]) == CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  };
+  return std::make_unique<IteratorCursor<KeyType, ValueType, KeyComparator>>(container_->RBegin(not_greater),
+                                                                            entry_schema);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
@@ -65,5 +185,10 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<PackedIntegerKey, RID, PackedIntegerComparator>;
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
@@ -1,6 +1,8 @@
 #include <vector>
 
 #include "storage/index/extendible_hash_table_index.h"
+#include "storage/index/normalized_key.h"
+#include "storage/index/packed_integer_key.h"
 
 namespace bustub {
 /*
@@ -12,13 +14,13 @@ HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &
                                                 const HashFunction<KeyType> &hash_fn)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn, GetMetadata()->IsUnique()) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   return container_.Insert(transaction, index_key, rid);
 }
@@ -27,7 +29,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -36,14 +38,20 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(transaction, index_key, result);
 }
+
 template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExtendibleHashTableIndex<PackedIntegerKey, RID, PackedIntegerComparator>;
+template class ExtendibleHashTableIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class ExtendibleHashTableIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExtendibleHashTableIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExtendibleHashTableIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
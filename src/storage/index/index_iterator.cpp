@@ -1,9 +1,12 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
+#include "storage/index/posting_list.h"
 
 namespace bustub {
 
@@ -15,8 +18,18 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(page_id_t cur_page_id, int idx, BufferPoolManager *bpm)
-    : cur_page_id_(cur_page_id), idx_(idx), bpm_(bpm) {}
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                                  ReadPageGuard guard, int idx, bool reverse)
+    : tree_(tree), cur_page_id_(guard.PageId()), idx_(idx), bpm_(bpm), guard_(std::move(guard)), reverse_(reverse) {
+  leaf_ = guard_.As<LeafPage>();
+  if (reverse_) {
+    EnterEntry();
+  } else if (idx_ >= leaf_->GetSize()) {
+    NextLeaf();
+  } else {
+    EnterEntry();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
@@ -25,27 +38,153 @@ INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool { return cur_page_id_ == INVALID_PAGE_ID; }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
-  BasicPageGuard guard = bpm_->FetchPageBasic(cur_page_id_);
-  auto leaf_page = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-  return leaf_page->PairAt(idx_);
+auto INDEXITERATOR_TYPE::operator*() -> MappingType {
+  if (posting_values_.empty()) {
+    return leaf_->PairAt(idx_);
+  }
+  return {leaf_->KeyAt(idx_), posting_values_[posting_idx_]};
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  BasicPageGuard guard = bpm_->FetchPageBasic(cur_page_id_);
-  auto leaf_page = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-  idx_++;
-  if (idx_ >= leaf_page->GetSize()) {
-    cur_page_id_ = leaf_page->GetNextPageId();
-    idx_ = 0;
-    if (cur_page_id_ == INVALID_PAGE_ID) {
-      bpm_ = nullptr;
+  if (reverse_) {
+    if (posting_idx_ > 0) {
+      posting_idx_--;
+    } else {
+      PrevEntry();
+    }
+    return *this;
+  }
+  if (!posting_values_.empty()) {
+    if (++posting_idx_ < posting_values_.size()) {
+      return *this;
+    }
+    if (posting_next_page_id_ != INVALID_PAGE_ID) {
+      posting_values_.clear();
+      posting_idx_ = 0;
+      posting_next_page_id_ = PostingList::ReadPage(bpm_, posting_next_page_id_, &posting_values_);
+      return *this;
     }
   }
+  NextEntry();
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::NextBatch(std::vector<MappingType> *batch, size_t max_size) -> size_t {
+  batch->clear();
+  if (reverse_) {
+    for (; !IsEnd() && batch->size() < max_size; ++(*this)) {
+      batch->push_back(**this);
+    }
+    return batch->size();
+  }
+  while (!IsEnd() && batch->size() < max_size) {
+    if (!posting_values_.empty()) {
+      size_t count = std::min(posting_values_.size() - posting_idx_, max_size - batch->size());
+      KeyType key = leaf_->KeyAt(idx_);
+      for (size_t i = 0; i < count; i++) {
+        batch->emplace_back(key, posting_values_[posting_idx_ + i]);
+      }
+      posting_idx_ += count - 1;
+      ++(*this);
+      continue;
+    }
+    // copy entries with inline values up to the next posting list
+    int count = std::min<int>(leaf_->GetSize() - idx_, max_size - batch->size());
+    int i = 0;
+    for (; i < count; i++) {
+      MappingType pair = leaf_->PairAt(idx_ + i);
+      if (PostingList::IsReference(pair.second)) {
+        break;
+      }
+      batch->push_back(pair);
+    }
+    idx_ += i;
+    if (idx_ >= leaf_->GetSize()) {
+      NextLeaf();
+    } else {
+      EnterEntry();
+    }
+  }
+  return batch->size();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::NextLeaf() {
+  page_id_t next_page_id = leaf_->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    *this = IndexIterator();
+    return;
+  }
+  ReadPageGuard next_guard = bpm_->TryFetchPageRead(next_page_id);
+  if (next_guard.IsEmpty()) {
+    // A writer merging the next leaf may be waiting for this one, so back off and search again.
+    KeyType last_key = leaf_->KeyAt(leaf_->GetSize() - 1);
+    auto *tree = tree_;
+    *this = IndexIterator();
+    *this = tree->Begin(last_key);
+    if (!IsEnd() && tree->comparator_(leaf_->KeyAt(idx_), last_key) == 0) {
+      NextEntry();
+    }
+    return;
+  }
+  guard_ = std::move(next_guard);
+  leaf_ = guard_.As<LeafPage>();
+  cur_page_id_ = next_page_id;
+  idx_ = 0;
+  if (leaf_->GetSize() == 0) {
+    NextLeaf();
+  } else {
+    EnterEntry();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::NextEntry() {
+  idx_++;
+  if (idx_ >= leaf_->GetSize()) {
+    NextLeaf();
+  } else {
+    EnterEntry();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrevLeaf() {
+  KeyType first_key = leaf_->KeyAt(0);
+  auto *tree = tree_;
+  // let go of the leaf first, the search latches from the root down
+  *this = IndexIterator();
+  *this = tree->RBegin([&](const KeyType &key) { return tree->comparator_(key, first_key) < 0; });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrevEntry() {
+  if (idx_ == 0) {
+    PrevLeaf();
+  } else {
+    idx_--;
+    EnterEntry();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::EnterEntry() {
+  posting_values_.clear();
+  posting_idx_ = 0;
+  posting_next_page_id_ = INVALID_PAGE_ID;
+  ValueType value = leaf_->ValueAt(idx_);
+  if (PostingList::IsReference(value)) {
+    if (reverse_) {
+      PostingList::Read(bpm_, PostingList::HeadPageId(value), &posting_values_);
+      posting_idx_ = posting_values_.size() - 1;
+    } else {
+      posting_next_page_id_ = PostingList::ReadPage(bpm_, PostingList::HeadPageId(value), &posting_values_);
+    }
+  }
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
@@ -56,4 +195,14 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<PackedIntegerKey, RID, PackedIntegerComparator>;
+
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
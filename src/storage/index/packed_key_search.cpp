@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// packed_key_search.cpp
+//
+// Identification: src/storage/index/packed_key_search.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/packed_key_search.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Binary search stops once this many keys are left, and the window is compared a vector at a time. */
+constexpr size_t SEARCH_WINDOW = 16;
+
+using CountInWindow = auto (*)(const uint64_t *keys, size_t n, uint64_t key) -> size_t;
+
+auto CountInWindowScalar(const uint64_t *keys, size_t n, uint64_t key) -> size_t {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += keys[i] < key ? 1 : 0;
+  }
+  return count;
+}
+
+#if defined(__x86_64__)
+// The vector comparisons are signed, so keys and needle get their sign bit flipped to compare them unsigned.
+
+__attribute__((target("avx2"))) auto CountInWindowAvx2(const uint64_t *keys, size_t n, uint64_t key) -> size_t {
+  const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key)), flip);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i lanes = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), flip);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, lanes))));
+  }
+  return count + CountInWindowScalar(keys + i, n - i, key);
+}
+
+__attribute__((target("sse4.2"))) auto CountInWindowSse42(const uint64_t *keys, size_t n, uint64_t key) -> size_t {
+  const __m128i flip = _mm_set1_epi64x(INT64_MIN);
+  const __m128i needle = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(key)), flip);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i lanes = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), flip);
+    count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, lanes))));
+  }
+  return count + CountInWindowScalar(keys + i, n - i, key);
+}
+#endif
+
+auto SelectCountInWindow() -> CountInWindow {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return CountInWindowAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return CountInWindowSse42;
+  }
+#endif
+  return CountInWindowScalar;
+}
+
+const CountInWindow COUNT_IN_WINDOW = SelectCountInWindow();
+
+}  // namespace
+
+auto CountKeysLess(const uint64_t *keys, size_t n, uint64_t key) -> size_t {
+  // Keys before base are less than key, keys from base + n on are not.
+  size_t base = 0;
+  while (n > SEARCH_WINDOW) {
+    size_t half = n / 2;
+    if (keys[base + half] < key) {
+      base += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return base + COUNT_IN_WINDOW(keys + base, n, key);
+}
+
+auto CountKeysLessScalar(const uint64_t *keys, size_t n, uint64_t key) -> size_t {
+  size_t left = 0;
+  size_t right = n;
+  while (left < right) {
+    size_t mid = (left + right) / 2;
+    if (keys[mid] < key) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+}  // namespace bustub
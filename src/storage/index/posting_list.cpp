@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.cpp
+//
+// Identification: src/storage/index/posting_list.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/posting_list.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+auto RidLess(const RID &lhs, const RID &rhs) -> bool {
+  return BPlusTreePostingPage::Order(lhs) < BPlusTreePostingPage::Order(rhs);
+}
+
+}  // namespace
+
+auto PostingList::Create(BufferPoolManager *bpm, const std::vector<RID> &rids) -> page_id_t {
+  page_id_t head_page_id;
+  BasicPageGuard head_guard = bpm->NewPageGuarded(&head_page_id);
+  auto head = head_guard.AsMut<BPlusTreePostingPage>();
+  head->Init();
+  head->SetTailPageId(head_page_id);
+  head->SetTotalSize(rids.size());
+
+  BasicPageGuard tail_guard;
+  auto tail = head;
+  for (const auto &rid : rids) {
+    if (tail->Append(rid)) {
+      continue;
+    }
+    page_id_t page_id;
+    BasicPageGuard guard = bpm->NewPageGuarded(&page_id);
+    auto page = guard.AsMut<BPlusTreePostingPage>();
+    page->Init();
+    page->Append(rid);
+    tail->SetNextPageId(page_id);
+    head->SetTailPageId(page_id);
+    tail_guard = std::move(guard);
+    tail = page;
+  }
+  return head_page_id;
+}
+
+auto PostingList::Insert(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool {
+  WritePageGuard head_guard = bpm->FetchPageWrite(head_page_id);
+  auto head = head_guard.AsMut<BPlusTreePostingPage>();
+
+  // New tuples usually get RIDs past the end of the list, so try to append to the last page first.
+  {
+    WritePageGuard tail_guard;
+    auto tail = head;
+    if (head->GetTailPageId() != head_page_id) {
+      tail_guard = bpm->FetchPageWrite(head->GetTailPageId());
+      tail = tail_guard.AsMut<BPlusTreePostingPage>();
+    }
+    if (RidLess(tail->LastRid(), rid)) {
+      if (!tail->Append(rid)) {
+        page_id_t page_id;
+        BasicPageGuard guard = bpm->NewPageGuarded(&page_id);
+        auto page = guard.AsMut<BPlusTreePostingPage>();
+        page->Init();
+        page->Append(rid);
+        tail->SetNextPageId(page_id);
+        head->SetTailPageId(page_id);
+      }
+      head->SetTotalSize(head->GetTotalSize() + 1);
+      return true;
+    }
+  }
+
+  // Otherwise insert into the first page whose RIDs go up to rid.
+  WritePageGuard guard;
+  auto page = head;
+  page_id_t page_id = head_page_id;
+  while (RidLess(page->LastRid(), rid)) {
+    page_id = page->GetNextPageId();
+    guard = bpm->FetchPageWrite(page_id);
+    page = guard.AsMut<BPlusTreePostingPage>();
+  }
+  std::vector<RID> rids;
+  page->Decode(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it != rids.end() && *it == rid) {
+    return false;
+  }
+  rids.insert(it, rid);
+  if (!page->Encode(rids.data(), rids.size())) {
+    // The page is full, split it in two. Each half takes fewer bytes than the full page did.
+    size_t half = rids.size() / 2;
+    page_id_t new_page_id;
+    BasicPageGuard new_guard = bpm->NewPageGuarded(&new_page_id);
+    auto new_page = new_guard.AsMut<BPlusTreePostingPage>();
+    new_page->Init();
+    [[maybe_unused]] bool fits = new_page->Encode(rids.data() + half, rids.size() - half);
+    fits = fits && page->Encode(rids.data(), half);
+    BUSTUB_ASSERT(fits, "Half a page must fit.");
+    new_page->SetNextPageId(page->GetNextPageId());
+    page->SetNextPageId(new_page_id);
+    if (head->GetTailPageId() == page_id) {
+      head->SetTailPageId(new_page_id);
+    }
+  }
+  head->SetTotalSize(head->GetTotalSize() + 1);
+  return true;
+}
+
+auto PostingList::Remove(BufferPoolManager *bpm, page_id_t head_page_id, const RID &rid) -> bool {
+  WritePageGuard head_guard = bpm->FetchPageWrite(head_page_id);
+  auto head = head_guard.AsMut<BPlusTreePostingPage>();
+
+  // Find the first page whose RIDs go up to rid, keeping the page before it latched to unlink it if it empties.
+  WritePageGuard prev_guard;
+  WritePageGuard guard;
+  BPlusTreePostingPage *prev = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  auto page = head;
+  page_id_t page_id = head_page_id;
+  while (RidLess(page->LastRid(), rid)) {
+    page_id_t next_page_id = page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+    prev_guard = std::move(guard);
+    prev = page;
+    prev_page_id = page_id;
+    guard = bpm->FetchPageWrite(next_page_id);
+    page = guard.AsMut<BPlusTreePostingPage>();
+    page_id = next_page_id;
+  }
+  std::vector<RID> rids;
+  page->Decode(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it == rids.end() || !(*it == rid)) {
+    return false;
+  }
+  rids.erase(it);
+  head->SetTotalSize(head->GetTotalSize() - 1);
+  if (!rids.empty() || (page == head && head->GetNextPageId() == INVALID_PAGE_ID)) {
+    // Removing a RID never makes the deltas longer than the ones it replaces.
+    page->Encode(rids.data(), rids.size());
+    return true;
+  }
+
+  page_id_t delete_page_id = page_id;
+  if (page == head) {
+    // The leaf refers to the first page, so it takes over the RIDs of the second one.
+    page_id_t next_page_id = head->GetNextPageId();
+    ReadPageGuard next_guard = bpm->FetchPageRead(next_page_id);
+    auto next = next_guard.As<BPlusTreePostingPage>();
+    next->Decode(&rids);
+    head->Encode(rids.data(), rids.size());
+    head->SetNextPageId(next->GetNextPageId());
+    if (head->GetTailPageId() == next_page_id) {
+      head->SetTailPageId(head_page_id);
+    }
+    delete_page_id = next_page_id;
+  } else {
+    prev->SetNextPageId(page->GetNextPageId());
+    if (head->GetTailPageId() == page_id) {
+      head->SetTailPageId(prev_page_id);
+    }
+    guard.Drop();
+  }
+  bpm->DeletePage(delete_page_id);
+  return true;
+}
+
+auto PostingList::Size(BufferPoolManager *bpm, page_id_t head_page_id) -> size_t {
+  ReadPageGuard guard = bpm->FetchPageRead(head_page_id);
+  return guard.As<BPlusTreePostingPage>()->GetTotalSize();
+}
+
+void PostingList::Read(BufferPoolManager *bpm, page_id_t head_page_id, std::vector<RID> *rids) {
+  for (page_id_t page_id = head_page_id; page_id != INVALID_PAGE_ID;) {
+    page_id = ReadPage(bpm, page_id, rids);
+  }
+}
+
+auto PostingList::ReadPage(BufferPoolManager *bpm, page_id_t page_id, std::vector<RID> *rids) -> page_id_t {
+  ReadPageGuard guard = bpm->FetchPageRead(page_id);
+  auto page = guard.As<BPlusTreePostingPage>();
+  page->Decode(rids);
+  return page->GetNextPageId();
+}
+
+void PostingList::Drop(BufferPoolManager *bpm, page_id_t head_page_id) {
+  for (page_id_t page_id = head_page_id; page_id != INVALID_PAGE_ID;) {
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    page_id_t next_page_id = guard.As<BPlusTreePostingPage>()->GetNextPageId();
+    guard.Drop();
+    bpm->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
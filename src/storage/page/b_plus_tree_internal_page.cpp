@@ -9,10 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <type_traits>
 
 #include "common/exception.h"
+#include "storage/index/packed_key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -25,12 +29,18 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) {
+  static_assert(sizeof(BPlusTreeInternalPage) == INTERNAL_PAGE_HEADER_SIZE);
   SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetRightPageId(INVALID_PAGE_ID);
   SetSize(1);
-  if (static_cast<uint64_t>(max_size) >= INTERNAL_PAGE_SIZE) {
-    max_size = INTERNAL_PAGE_SIZE - 1;
+  if constexpr (COMPRESS_KEYS) {
+    // the first entry only has a child, give it an empty key
+    KeyType invalid_key;
+    memset(invalid_key.data_, 0, sizeof(KeyType));
+    Compressed()->Reset();
+    Compressed()->Insert(0, invalid_key, ValueType{}, 0);
   }
-  SetMaxSize(max_size);
+  SetMaxSize(EffectiveMaxSize(max_size));
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -41,7 +51,10 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   if (index < 0 || index >= GetSize()) {
     throw ExecutionException("The input index is invalid");
   }
-  return array_[index].first;
+  if constexpr (COMPRESS_KEYS) {
+    return Compressed()->KeyAt(index);
+  }
+  return KeySlot(index);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -49,7 +62,13 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
   // if (index == 0) {
   //   throw ExecutionException("The input index is invalid");
   // }
-  array_[index].first = key;
+  if constexpr (COMPRESS_KEYS) {
+    ValueType value = Compressed()->ValueAt(index);
+    Compressed()->Remove(index, GetSize());
+    Compressed()->Insert(index, key, value, GetSize() - 1);
+    return;
+  }
+  KeySlot(index) = key;
 }
 
 /*
@@ -61,7 +80,10 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   if (index < 0 || index >= GetSize()) {
     throw ExecutionException("The input index is invalid");
   }
-  return array_[index].second;
+  if constexpr (COMPRESS_KEYS) {
+    return Compressed()->ValueAt(index);
+  }
+  return ValueSlot(index);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -69,7 +91,231 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &valu
   if (index < 0 || index >= GetSize()) {
     throw ExecutionException("The input index is invalid");
   }
-  array_[index].second = value;
+  if constexpr (COMPRESS_KEYS) {
+    Compressed()->SetValueAt(index, value);
+    return;
+  }
+  ValueSlot(index) = value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ChildIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  if (GetSize() <= 1) {
+    return 0;
+  }
+  if constexpr (std::is_same_v<KeyType, PackedIntegerKey>) {
+    // packed keys are plain integers, so the key array can be searched with vector compares
+    static_assert(sizeof(PackedIntegerKey) == sizeof(uint64_t));
+    return static_cast<int>(CountKeysLessEqual(&KeySlot(1).data_, GetSize() - 1, key.data_));
+  }
+  if constexpr (COMPRESS_KEYS) {
+    // compressed keys compare like their bytes, which is the order of the comparator
+    return Compressed()->UpperBound(key, 1, GetSize()) - 1;
+  }
+  // the first key is invalid, so search for the first key greater than key among the others
+  int left = 1;
+  int right = GetSize();
+  while (left < right) {
+    int mid = (left + right) / 2;
+    if (comparator(KeySlot(mid), key) <= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  if constexpr (COMPRESS_KEYS) {
+    Compressed()->Insert(index, key, value, GetSize());
+    IncreaseSize(1);
+    return;
+  }
+  MoveEntries(this, index + 1, this, index, GetSize() - index);
+  KeySlot(index) = key;
+  ValueSlot(index) = value;
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
+  if constexpr (COMPRESS_KEYS) {
+    Compressed()->Remove(index, GetSize());
+    IncreaseSize(-1);
+    return;
+  }
+  MoveEntries(this, index, this, index + 1, GetSize() - index - 1);
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveTailTo(BPlusTreeInternalPage *recipient, int from) {
+  if constexpr (COMPRESS_KEYS) {
+    // Both pages are rebuilt, so that each gets the prefix of its new range of keys.
+    auto entries = recipient->Compressed()->Decode(0, recipient->GetSize());
+    auto tail = Compressed()->Decode(from, GetSize());
+    entries.insert(entries.end(), tail.begin(), tail.end());
+    recipient->Compressed()->Rebuild(entries);
+    recipient->SetSize(static_cast<int>(entries.size()));
+    Compressed()->Rebuild(Compressed()->Decode(0, from));
+    SetSize(from);
+    return;
+  }
+  MoveEntries(recipient, recipient->GetSize(), this, from, GetSize() - from);
+  recipient->IncreaseSize(GetSize() - from);
+  SetSize(from);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsInsertSafe() const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    return GetSize() < GetMaxSize() &&
+           Compressed()->UsedBytes(GetSize()) + Entries::SLOT_SIZE + sizeof(KeyType) <= Entries::BUDGET;
+  }
+  return GetSize() < GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsRemoveSafe() const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    return GetSize() > 2 &&
+           Compressed()->UsedBytes(GetSize()) >= Entries::BUDGET / 2 + Entries::SLOT_SIZE + sizeof(KeyType);
+  }
+  return GetSize() > GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsOverflow() const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    return GetSize() > GetMaxSize() || Compressed()->UsedBytes(GetSize()) > Entries::BUDGET;
+  }
+  return GetSize() > GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    return GetSize() < 2 || Compressed()->UsedBytes(GetSize()) < Entries::BUDGET / 2;
+  }
+  return GetSize() < GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanLend() const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    return IsRemoveSafe();
+  }
+  return GetSize() > GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::SplitIndex() const -> int {
+  if constexpr (COMPRESS_KEYS) {
+    // split where half of the bytes are used, keeping at least two children on each side
+    size_t half = Compressed()->UsedBytes(GetSize()) / 2;
+    size_t used = 0;
+    int index = 0;
+    while (index < GetSize() - 2 && used < half) {
+      used += Compressed()->EntryBytes(index++);
+    }
+    return std::max(index, 2);
+  }
+  return GetSize() / 2;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeWith(const BPlusTreeInternalPage *other) const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    auto entries = Compressed()->Decode(0, GetSize());
+    auto other_entries = other->Compressed()->Decode(0, other->GetSize());
+    entries.insert(entries.end(), other_entries.begin(), other_entries.end());
+    return static_cast<int>(entries.size()) <= GetMaxSize() && Entries::RebuiltBytes(entries) <= Entries::BUDGET;
+  }
+  // pages only borrow from their left sibling, so the right one may be too full to take in
+  return GetSize() + other->GetSize() <= GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const -> bool {
+  if constexpr (COMPRESS_KEYS) {
+    return Compressed()->UsedBytes(GetSize()) - Compressed()->EntryBytes(index) + Compressed()->InsertBytes(key) <=
+           Entries::BUDGET;
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LoadEntries(const MappingType *entries, int n) -> int {
+  n = std::min(n, GetMaxSize());
+  if constexpr (COMPRESS_KEYS) {
+    // the most entries that fit into the budget once compressed
+    int left = 1;
+    int right = n;
+    while (left < right) {
+      int mid = (left + right + 1) / 2;
+      if (Entries::RebuiltBytes(entries, mid) <= Entries::BUDGET) {
+        left = mid;
+      } else {
+        right = mid - 1;
+      }
+    }
+    Compressed()->Rebuild(entries, left);
+    SetSize(left);
+    return left;
+  }
+  SetSize(n);
+  for (int i = 0; i < n; i++) {
+    KeySlot(i) = entries[i].first;
+    ValueSlot(i) = entries[i].second;
+  }
+  return n;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::EffectiveMaxSize(int max_size) -> int {
+  if (static_cast<uint64_t>(max_size) >= INTERNAL_PAGE_SIZE) {
+    max_size = INTERNAL_PAGE_SIZE - 1;
+  }
+  if constexpr (COMPRESS_KEYS) {
+    // a page that may be as large as the fixed-size layout allows is only limited by its bytes
+    if (static_cast<uint64_t>(max_size) == INTERNAL_PAGE_SIZE - 1) {
+      max_size = Entries::MAX_ENTRIES;
+    }
+  }
+  return max_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LoadUnits(const KeyType &prev, const KeyType &key) -> size_t {
+  if constexpr (COMPRESS_KEYS) {
+    return Entries::EstimateBytes(prev, key);
+  }
+  return 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LoadCapacity(int max_size) -> size_t {
+  if constexpr (COMPRESS_KEYS) {
+    return Entries::BUDGET;
+  }
+  return max_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveEntries(BPlusTreeInternalPage *dest, int dest_index,
+                                                 BPlusTreeInternalPage *source, int source_index, int n) {
+  if (n <= 0) {
+    return;
+  }
+  if constexpr (SEPARATE_KEYS) {
+    memmove(static_cast<void *>(&dest->KeySlot(dest_index)), &source->KeySlot(source_index), n * sizeof(KeyType));
+    memmove(static_cast<void *>(&dest->ValueSlot(dest_index)), &source->ValueSlot(source_index),
+            n * sizeof(ValueType));
+  } else {
+    memmove(static_cast<void *>(&dest->array_[dest_index]), &source->array_[source_index], n * sizeof(MappingType));
+  }
 }
 
 // valuetype for internalNode should be page id_t
@@ -78,4 +324,9 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<PackedIntegerKey, page_id_t, PackedIntegerComparator>;
+template class BPlusTreeInternalPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
 }  // namespace bustub
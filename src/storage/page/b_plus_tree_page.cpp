@@ -20,6 +20,9 @@ namespace bustub {
 auto BPlusTreePage::IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
 void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
+auto BPlusTreePage::IsDeleted() const -> bool { return page_type_ == IndexPageType::INVALID_INDEX_PAGE; }
+void BPlusTreePage::SetDeleted() { page_type_ = IndexPageType::INVALID_INDEX_PAGE; }
+
 /*
  * Helper methods to get/set size (number of key/value pairs stored in that
  * page)
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+namespace {
+
+auto VarintBytes(uint64_t value) -> size_t {
+  size_t bytes = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    bytes++;
+  }
+  return bytes;
+}
+
+auto PutVarint(uint8_t *out, uint64_t value) -> size_t {
+  size_t bytes = 0;
+  while (value >= 0x80) {
+    out[bytes++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[bytes++] = static_cast<uint8_t>(value);
+  return bytes;
+}
+
+auto GetVarint(const uint8_t *in, uint64_t *value) -> size_t {
+  size_t bytes = 0;
+  int shift = 0;
+  *value = 0;
+  while ((in[bytes] & 0x80) != 0) {
+    *value |= static_cast<uint64_t>(in[bytes++] & 0x7F) << shift;
+    shift += 7;
+  }
+  *value |= static_cast<uint64_t>(in[bytes++]) << shift;
+  return bytes;
+}
+
+}  // namespace
+
+void BPlusTreePostingPage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  tail_page_id_ = INVALID_PAGE_ID;
+  total_size_ = 0;
+  size_ = 0;
+  bytes_ = 0;
+  reserved_ = 0;
+  first_rid_ = 0;
+  last_rid_ = 0;
+}
+
+void BPlusTreePostingPage::Decode(std::vector<RID> *rids) const {
+  if (size_ == 0) {
+    return;
+  }
+  uint64_t value = first_rid_;
+  rids->emplace_back(static_cast<int64_t>(value));
+  size_t pos = 0;
+  for (uint32_t i = 1; i < size_; i++) {
+    uint64_t delta;
+    pos += GetVarint(data_ + pos, &delta);
+    value += delta;
+    rids->emplace_back(static_cast<int64_t>(value));
+  }
+}
+
+auto BPlusTreePostingPage::Encode(const RID *rids, size_t n) -> bool {
+  if (EncodedBytes(rids, n) > POSTING_PAGE_DATA_SIZE) {
+    return false;
+  }
+  size_ = n;
+  bytes_ = 0;
+  if (n == 0) {
+    return true;
+  }
+  first_rid_ = Order(rids[0]);
+  for (size_t i = 1; i < n; i++) {
+    bytes_ += PutVarint(data_ + bytes_, Order(rids[i]) - Order(rids[i - 1]));
+  }
+  last_rid_ = Order(rids[n - 1]);
+  return true;
+}
+
+auto BPlusTreePostingPage::Append(const RID &rid) -> bool {
+  if (size_ == 0) {
+    return Encode(&rid, 1);
+  }
+  uint64_t delta = Order(rid) - last_rid_;
+  if (bytes_ + VarintBytes(delta) > POSTING_PAGE_DATA_SIZE) {
+    return false;
+  }
+  bytes_ += PutVarint(data_ + bytes_, delta);
+  last_rid_ = Order(rid);
+  size_++;
+  return true;
+}
+
+auto BPlusTreePostingPage::EncodedBytes(const RID *rids, size_t n) -> size_t {
+  size_t bytes = 0;
+  for (size_t i = 1; i < n; i++) {
+    bytes += VarintBytes(Order(rids[i]) - Order(rids[i - 1]));
+  }
+  return bytes;
+}
+
+}  // namespace bustub
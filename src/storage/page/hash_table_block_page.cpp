@@ -17,30 +17,38 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const -> KeyType {
-  return {};
+  return array_[bucket_ind].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const -> ValueType {
-  return {};
+  return array_[bucket_ind].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  auto mask = static_cast<char>(1 << (bucket_ind % 8));
+  if ((occupied_[bucket_ind / 8].fetch_or(mask) & mask) != 0) {
+    return false;
+  }
+  array_[bucket_ind] = {key, value};
+  readable_[bucket_ind / 8].fetch_or(mask);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  readable_[bucket_ind / 8].fetch_and(static_cast<char>(~(1 << (bucket_ind % 8))));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const -> bool {
-  return false;
+  return (occupied_[bucket_ind / 8].load() & (1 << (bucket_ind % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const -> bool {
-  return false;
+  return (readable_[bucket_ind / 8].load() & (1 << (bucket_ind % 8))) != 0;
 }
 
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
@@ -11,71 +11,146 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <iterator>
+#include <optional>
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
 #include "storage/index/hash_comparator.h"
+#include "storage/index/normalized_key.h"
+#include "storage/index/packed_integer_key.h"
 #include "storage/table/tmp_tuple.h"
 
 namespace bustub {
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  Clear();
+  next_page_id_ = INVALID_PAGE_ID;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+  bool found = false;
+  // slots are taken in order, so no pair lies past the first slot that was never occupied
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (IsReadable(bucket_idx) && cmp(key, array_[bucket_idx].first) == 0) {
+      result->push_back(array_[bucket_idx].second);
+      found = true;
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  std::optional<uint32_t> free_idx;
+  uint32_t bucket_idx = 0;
+  for (; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (!IsReadable(bucket_idx)) {
+      if (!free_idx.has_value()) {
+        free_idx = bucket_idx;
+      }
+    } else if (array_[bucket_idx].second == value && cmp(key, array_[bucket_idx].first) == 0) {
+      return false;
+    }
+  }
+  if (!free_idx.has_value()) {
+    if (bucket_idx == BUCKET_ARRAY_SIZE) {
+      return false;
+    }
+    free_idx = bucket_idx;
+  }
+  array_[*free_idx] = MappingType(key, value);
+  SetOccupied(*free_idx);
+  SetReadable(*free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (IsReadable(bucket_idx) && array_[bucket_idx].second == value && cmp(key, array_[bucket_idx].first) == 0) {
+      RemoveAt(bucket_idx);
+      return true;
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  uint32_t count = 0;
+  for (auto byte : readable_) {
+    count += std::bitset<8>(static_cast<unsigned char>(byte)).count();
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  return std::all_of(std::begin(readable_), std::end(readable_), [](char byte) { return byte == 0; });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Clear() {
+  memset(occupied_, 0, sizeof(occupied_));
+  memset(readable_, 0, sizeof(readable_));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GetNextPageId() const -> page_id_t {
+  return next_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -108,6 +183,11 @@ template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class HashTableBucketPage<PackedIntegerKey, RID, PackedIntegerComparator>;
+template class HashTableBucketPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class HashTableBucketPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class HashTableBucketPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class HashTableBucketPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
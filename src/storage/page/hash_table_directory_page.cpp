@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <unordered_map>
 #include "common/logger.h"
+#include "common/macros.h"
 
 namespace bustub {
 auto HashTableDirectoryPage::GetPageId() const -> page_id_t { return page_id_; }
@@ -26,29 +27,63 @@ void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
 auto HashTableDirectoryPage::GetGlobalDepth() -> uint32_t { return global_depth_; }
 
-auto HashTableDirectoryPage::GetGlobalDepthMask() -> uint32_t { return 0; }
+auto HashTableDirectoryPage::GetGlobalDepthMask() -> uint32_t { return (1U << global_depth_) - 1; }
 
-void HashTableDirectoryPage::IncrGlobalDepth() {}
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  BUSTUB_ASSERT(Size() * 2 <= DIRECTORY_ARRAY_SIZE, "The directory is full.");
+  // the new upper half points to the same buckets as the lower half
+  uint32_t size = Size();
+  for (uint32_t bucket_idx = 0; bucket_idx < size; bucket_idx++) {
+    bucket_page_ids_[bucket_idx + size] = bucket_page_ids_[bucket_idx];
+    local_depths_[bucket_idx + size] = local_depths_[bucket_idx];
+  }
+  global_depth_++;
+}
 
 void HashTableDirectoryPage::DecrGlobalDepth() { global_depth_--; }
 
-auto HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) -> page_id_t { return 0; }
+auto HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) -> page_id_t { return bucket_page_ids_[bucket_idx]; }
 
-void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {}
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
 
-auto HashTableDirectoryPage::Size() -> uint32_t { return 0; }
+auto HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) -> uint32_t {
+  return bucket_idx ^ GetLocalHighBit(bucket_idx);
+}
 
-auto HashTableDirectoryPage::CanShrink() -> bool { return false; }
+auto HashTableDirectoryPage::Size() -> uint32_t { return 1U << global_depth_; }
 
-auto HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) -> uint32_t { return 0; }
+auto HashTableDirectoryPage::CanShrink() -> bool {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t bucket_idx = 0; bucket_idx < Size(); bucket_idx++) {
+    if (local_depths_[bucket_idx] == global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) -> uint32_t { return local_depths_[bucket_idx]; }
+
+auto HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) -> uint32_t {
+  return (1U << local_depths_[bucket_idx]) - 1;
+}
 
-void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) {}
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) {
+  local_depths_[bucket_idx] = local_depth;
+}
 
-void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) {}
+void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]++; }
 
-void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) {}
+void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]--; }
 
-auto HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) -> uint32_t { return 0; }
+auto HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) -> uint32_t {
+  uint32_t local_depth = local_depths_[bucket_idx];
+  return local_depth == 0 ? 0 : 1U << (local_depth - 1);
+}
 
 /**
  * VerifyIntegrity - Use this for debugging but **DO NOT CHANGE**
@@ -12,23 +12,38 @@
 
 #include "storage/page/hash_table_header_page.h"
 
+#include "common/macros.h"
+
 namespace bustub {
-auto HashTableHeaderPage::GetBlockPageId(size_t index) -> page_id_t { return 0; }
+void HashTableHeaderPage::Init(page_id_t page_id) {
+  lsn_ = 0;
+  size_ = 0;
+  page_id_ = page_id;
+  next_ind_ = 0;
+}
+
+auto HashTableHeaderPage::GetBlockPageId(size_t index) const -> page_id_t {
+  BUSTUB_ASSERT(index < next_ind_, "block index out of range");
+  return block_page_ids_[index];
+}
 
-auto HashTableHeaderPage::GetPageId() const -> page_id_t { return 0; }
+auto HashTableHeaderPage::GetPageId() const -> page_id_t { return page_id_; }
 
-void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) {}
+void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
 
-auto HashTableHeaderPage::GetLSN() const -> lsn_t { return 0; }
+auto HashTableHeaderPage::GetLSN() const -> lsn_t { return lsn_; }
 
-void HashTableHeaderPage::SetLSN(lsn_t lsn) {}
+void HashTableHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
-void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {}
+void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+  BUSTUB_ASSERT(next_ind_ < MAX_BLOCKS, "header page is full");
+  block_page_ids_[next_ind_++] = page_id;
+}
 
-auto HashTableHeaderPage::NumBlocks() -> size_t { return 0; }
+auto HashTableHeaderPage::NumBlocks() const -> size_t { return next_ind_; }
 
-void HashTableHeaderPage::SetSize(size_t size) {}
+void HashTableHeaderPage::SetSize(size_t size) { size_ = size; }
 
-auto HashTableHeaderPage::GetSize() const -> size_t { return 0; }
+auto HashTableHeaderPage::GetSize() const -> size_t { return size_; }
 
 }  // namespace bustub
@@ -6,8 +6,11 @@ namespace bustub {
 BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept { *this = std::move(that); }
 
 void BasicPageGuard::Drop() {
-  if (bpm_ != nullptr && page_ != nullptr) {
-    bpm_->UnpinPage(PageId(), is_dirty_);
+  if (page_ != nullptr) {
+    // A guard without a buffer pool manager was handed out for a swizzled page and holds no pin.
+    if (bpm_ != nullptr) {
+      bpm_->UnpinPage(PageId(), is_dirty_);
+    }
     bpm_ = nullptr;
     page_ = nullptr;
     is_dirty_ = false;
@@ -30,15 +33,33 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
 
 BasicPageGuard::~BasicPageGuard() { Drop(); }
 
+auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
+  if (page_ != nullptr) {
+    page_->RLatch();
+  }
+  ReadPageGuard guard;
+  guard.guard_ = std::move(*this);
+  return guard;
+}
+
+auto BasicPageGuard::UpgradeWrite() -> WritePageGuard {
+  if (page_ != nullptr) {
+    page_->WLatch();
+  }
+  WritePageGuard guard;
+  guard.guard_ = std::move(*this);
+  return guard;
+}
+
 ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept { guard_ = std::move(that.guard_); }
 
 auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & {
   if (&that == this) {
     return *this;
   }
-  if (guard_.page_ != nullptr) {
-    guard_.page_->RUnlatch();
-  }
+  // Unpin before unlatching, like Drop(): once the latch is released, a writer may delete the page, which fails while
+  // it is still pinned.
+  Drop();
   guard_ = std::move(that.guard_);
   return *this;
 }
@@ -59,9 +80,7 @@ auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard
   if (&that == this) {
     return *this;
   }
-  if (guard_.page_ != nullptr) {
-    guard_.page_->WUnlatch();
-  }
+  Drop();
   guard_ = std::move(that.guard_);
   return *this;
 }
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <algorithm>
 #include <mutex>  // NOLINT
 #include <utility>
 
@@ -26,17 +27,18 @@
 
 namespace bustub {
 
-TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
+TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm), segment_(bpm) {
   // Initialize the first table page.
-  auto guard = bpm->NewPageGuarded(&first_page_id_);
+  auto guard = segment_.NewPageGuarded(&first_page_id_);
   last_page_id_ = first_page_id_;
+  page_ids_.push_back(first_page_id_);
   auto first_page = guard.AsMut<TablePage>();
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->Init();
 }
 
-TableHeap::TableHeap(bool create_table_heap) : bpm_(nullptr) {}
+TableHeap::TableHeap(bool create_table_heap) : bpm_(nullptr), segment_(nullptr) {}
 
 auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr, Transaction *txn,
                             table_oid_t oid) -> std::optional<RID> {
@@ -52,7 +54,7 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
     BUSTUB_ENSURE(page->GetNumTuples() != 0, "tuple is too large, cannot insert");
 
     page_id_t next_page_id = INVALID_PAGE_ID;
-    auto npg = bpm_->NewPage(&next_page_id);
+    auto npg = segment_.NewPage(&next_page_id);
     BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
 
     page->SetNextPageId(next_page_id);
@@ -67,6 +69,7 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
     auto next_page_guard = WritePageGuard{bpm_, npg};
 
     last_page_id_ = next_page_id;
+    page_ids_.push_back(next_page_id);
     page_guard = std::move(next_page_guard);
   }
   auto last_page_id = last_page_id_;
@@ -93,8 +96,8 @@ void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
   page->UpdateTupleMeta(meta, rid);
 }
 
-auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
-  auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+auto TableHeap::GetTuple(RID rid, AccessType access_type) -> std::pair<TupleMeta, Tuple> {
+  auto page_guard = bpm_->FetchPageRead(rid.GetPageId(), access_type);
   auto page = page_guard.As<TablePage>();
   auto [meta, tuple] = page->GetTuple(rid);
   tuple.rid_ = rid;
@@ -117,6 +120,27 @@ auto TableHeap::MakeIterator() -> TableIterator {
   return {this, {first_page_id_, 0}, {last_page_id, page->GetNumTuples()}};
 }
 
+void TableHeap::ReadAhead(page_id_t page_id, size_t page_index, size_t *prefetched_until) {
+  if (read_ahead_depth_ == 0) {
+    return;
+  }
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::mutex> guard(latch_);
+    if (page_index >= page_ids_.size() || page_ids_[page_index] != page_id) {
+      return;
+    }
+    size_t end = std::min(page_index + read_ahead_depth_, page_ids_.size() - 1);
+    for (size_t i = std::max(*prefetched_until, page_index) + 1; i <= end; i++) {
+      page_ids.push_back(page_ids_[i]);
+    }
+    *prefetched_until = std::max(*prefetched_until, end);
+  }
+  for (auto next_page_id : page_ids) {
+    bpm_->PrefetchPage(next_page_id, AccessType::Scan);
+  }
+}
+
 auto TableHeap::MakeEagerIterator() -> TableIterator { return {this, {first_page_id_, 0}, {INVALID_PAGE_ID, 0}}; }
 
 void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
@@ -24,31 +24,29 @@ TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
     : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
   // If the rid doesn't correspond to a tuple (i.e., the table has just been initialized), then
   // we set rid_ to invalid.
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId(), AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   if (rid_.GetSlotNum() >= page->GetNumTuples()) {
     rid_ = RID{INVALID_PAGE_ID, 0};
   }
 }
 
-auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
+auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_, AccessType::Scan); }
 
 auto TableIterator::GetRID() -> RID { return rid_; }
 
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId(), AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   auto next_tuple_id = rid_.GetSlotNum() + 1;
+  bool moved_to_next_page = false;
 
-  if (stop_at_rid_.GetPageId() != INVALID_PAGE_ID) {
-    BUSTUB_ASSERT(
-        /* case 1: cursor before the page of the stop tuple */ rid_.GetPageId() < stop_at_rid_.GetPageId() ||
-            /* case 2: cursor at the page before the tuple */
-            (rid_.GetPageId() == stop_at_rid_.GetPageId() && next_tuple_id <= stop_at_rid_.GetSlotNum()),
-        "iterate out of bound");
-  }
+  // Freed page ids are reused, so the pages of the chain are not in id order: only the page of the stop tuple tells
+  // where the scan ends.
+  bool at_stop_page = stop_at_rid_.GetPageId() != INVALID_PAGE_ID && rid_.GetPageId() == stop_at_rid_.GetPageId();
+  BUSTUB_ASSERT(!at_stop_page || next_tuple_id <= stop_at_rid_.GetSlotNum(), "iterate out of bound");
 
   rid_ = RID{rid_.GetPageId(), next_tuple_id};
 
@@ -56,14 +54,26 @@ auto TableIterator::operator++() -> TableIterator & {
     rid_ = RID{INVALID_PAGE_ID, 0};
   } else if (next_tuple_id < page->GetNumTuples()) {
     // that's fine
+  } else if (at_stop_page) {
+    // the stop page is never left for the pages appended after it
+    rid_ = RID{INVALID_PAGE_ID, 0};
   } else {
     auto next_page_id = page->GetNextPageId();
     // if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
     rid_ = RID{next_page_id, 0};
+    if (next_page_id != INVALID_PAGE_ID) {
+      page_index_++;
+      moved_to_next_page = true;
+    }
   }
 
   page_guard.Drop();
 
+  // moving on to the next page of the chain: keep the pages after it on their way into the buffer pool
+  if (moved_to_next_page) {
+    table_heap_->ReadAhead(rid_.GetPageId(), page_index_, &prefetched_until_);
+  }
+
   return *this;
 }
 
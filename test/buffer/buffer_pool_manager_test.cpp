@@ -12,12 +12,26 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
 #include <limits>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "buffer/segment.h"
+#include "common/exception.h"
+#include "fmt/format.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -154,4 +168,673 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ShardedTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+  const size_t num_shards = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_shards);
+  EXPECT_EQ(num_shards, bpm->GetNumShards());
+
+  // Scenario: New pages are spread over the shards in round-robin order, so ids are still handed out densely.
+  page_id_t page_id_temp;
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", i);
+  }
+
+  // Scenario: Once every shard is fully pinned, we should not be able to create any new pages.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+
+  // Scenario: Unpinning a page frees a frame in its own shard only, and NewPage falls back to that shard.
+  EXPECT_EQ(true, bpm->UnpinPage(4, true));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(4 % num_shards, page_id_temp % num_shards);
+  EXPECT_EQ(nullptr, bpm->FetchPage(4));
+
+  // Scenario: Pages evicted from any shard can be fetched back with their content.
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+    if (i != 4) {
+      EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    }
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), fmt::format("page {}", i).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A disk manager whose reads block until they are released, so that a test can hold a cache miss in flight. */
+class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    std::unique_lock lock(mutex_);
+    reads_started_++;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return released_; });
+    lock.unlock();
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  void WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) override {
+    std::unique_lock lock(mutex_);
+    if (block_writes_) {
+      writes_started_++;
+      cv_.notify_all();
+      cv_.wait(lock, [this] { return released_; });
+    }
+    lock.unlock();
+    DiskManagerUnlimitedMemory::WritePages(first_page_id, pages);
+  }
+
+  void WaitForReads(int n) {
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this, n] { return reads_started_ >= n; });
+  }
+
+  /** Make writes block until Release() too, like reads always do. */
+  void BlockWrites() {
+    std::scoped_lock lock(mutex_);
+    block_writes_ = true;
+  }
+
+  void WaitForWrites(int n) {
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this, n] { return writes_started_ >= n; });
+  }
+
+  void Release() {
+    std::scoped_lock lock(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int reads_started_{0};
+  int writes_started_{0};
+  bool block_writes_{false};
+  bool released_{false};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, MissDoesNotBlockHitsTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 5;
+
+  auto disk_manager = std::make_unique<BlockingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: page 0 is written back and evicted, pages 1 and 2 stay resident.
+  page_id_t page_ids[3];
+  for (auto &page_id : page_ids) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: While a miss on page 0 is waiting for the disk, a second fetcher of page 0 waits for that read...
+  auto miss = std::async(std::launch::async, [&] { return bpm->FetchPage(page_ids[0]); });
+  disk_manager->WaitForReads(1);
+  auto same_miss = std::async(std::launch::async, [&] { return bpm->FetchPage(page_ids[0]); });
+  EXPECT_EQ(std::future_status::timeout, same_miss.wait_for(std::chrono::milliseconds(50)));
+
+  // ...but hits on resident pages are served right away.
+  auto *hit = bpm->FetchPage(page_ids[2]);
+  ASSERT_NE(nullptr, hit);
+  EXPECT_EQ(0, strcmp(hit->GetData(), "page 2"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[2], false));
+
+  // Scenario: Once the read completes, both fetchers get the same pinned page with the right content.
+  disk_manager->Release();
+  auto *page = miss.get();
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(page, same_miss.get());
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  EXPECT_EQ(2, page->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllDoesNotBlockHitsTest) {
+  const size_t buffer_pool_size = 2;
+  const size_t k = 5;
+
+  auto disk_manager = std::make_unique<BlockingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: page 0 is dirty, page 1 is clean.
+  page_id_t page_ids[2];
+  for (auto &page_id : page_ids) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(true, bpm->FlushPage(page_ids[1]));
+
+  // Scenario: while FlushAllPages() is writing page 0, a fetcher of page 0 waits for the write...
+  disk_manager->BlockWrites();
+  auto flush = std::async(std::launch::async, [&] { bpm->FlushAllPages(); });
+  disk_manager->WaitForWrites(1);
+  auto flushed = std::async(std::launch::async, [&] { return bpm->FetchPage(page_ids[0]); });
+  EXPECT_EQ(std::future_status::timeout, flushed.wait_for(std::chrono::milliseconds(50)));
+
+  // ...but the other pages of the shard are served right away.
+  auto *hit = bpm->FetchPage(page_ids[1]);
+  ASSERT_NE(nullptr, hit);
+  EXPECT_EQ(0, strcmp(hit->GetData(), "page 1"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], false));
+
+  disk_manager->Release();
+  flush.get();
+  auto *page = flushed.get();
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(false, page->IsDirty());
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlushTest) {
+  const size_t k = 5;
+  page_id_t page_id;
+
+  // Scenario: Without a flusher, reusing the frame of a dirty page writes it back on the foreground path.
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(1, disk_manager.get(), k);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(1, bpm->GetForegroundFlushCount());
+  EXPECT_EQ(0, bpm->GetBackgroundFlushCount());
+
+  // Scenario: With a flusher, the next victims of a pool full of dirty pages are cleaned in the background.
+  const size_t buffer_pool_size = 10;
+  const size_t flush_watermark = 4;
+  disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 1, flush_watermark);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetBackgroundFlushCount() < flush_watermark && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(flush_watermark, bpm->GetBackgroundFlushCount());
+
+  // Scenario: Misses now reuse the cleaned frames without writing anything on the foreground path.
+  for (size_t i = 0; i < flush_watermark; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundFlushCount());
+
+  // Scenario: The pages written back in the background can be read again.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(flush_watermark); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(fmt::format("page {}", i), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageReuseTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+  const size_t num_shards = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_shards);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: deleted page ids are handed out again by the shard owning them, before any new id.
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->DeletePage(6));
+  EXPECT_FALSE(disk_manager->IsAllocated(3));
+  // a stale copy of a deleted page read back in does not leak into the new page
+  bpm->PrefetchPage(3);
+  std::vector<page_id_t> reused(3);
+  for (auto &id : reused) {
+    auto *page = bpm->NewPage(&id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, page->GetData()[0]);
+    EXPECT_EQ(true, bpm->UnpinPage(id, false));
+  }
+  std::sort(reused.begin(), reused.end());
+  EXPECT_EQ((std::vector<page_id_t>{3, 6, 10}), reused);
+  EXPECT_EQ(11, disk_manager->GetNumPages());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, SegmentTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+  const size_t num_shards = 2;
+  const size_t extent_size = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_shards);
+  auto new_page = [](Segment *segment) {
+    page_id_t page_id;
+    auto *page = segment->NewPage(&page_id);
+    EXPECT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    return page_id;
+  };
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(0, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Scenario: pages of a segment are taken from aligned extents of adjacent ids, not interleaved with other objects.
+  Segment a(bpm.get(), extent_size);
+  Segment b(bpm.get(), extent_size);
+  std::vector<page_id_t> a_pages;
+  for (int i = 0; i < 3; ++i) {
+    a_pages.push_back(new_page(&a));
+  }
+  auto b_page = new_page(&b);
+  for (int i = 0; i < 2; ++i) {
+    a_pages.push_back(new_page(&a));
+  }
+  EXPECT_EQ((std::vector<page_id_t>{4, 5, 6, 7, 12}), a_pages);
+  EXPECT_EQ(8, b_page);
+  EXPECT_EQ((std::vector<page_id_t>{4, 12}), a.GetExtents());
+  for (auto id : a_pages) {
+    EXPECT_EQ(true, bpm->UnpinPage(id, true));
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(b_page, true));
+
+  // Scenario: a deleted page stays in its segment and is handed out again before the next unused page.
+  EXPECT_EQ(true, a.DeletePage(5));
+  EXPECT_EQ(true, disk_manager->IsAllocated(5));
+  EXPECT_EQ(5, new_page(&a));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+  EXPECT_EQ(5, a.GetNumPages());
+
+  // Scenario: the global allocation order skips the pages of segments.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // Scenario: dropping a segment frees its extents as a whole, and the next extent reuses the hole.
+  a.Drop();
+  EXPECT_EQ(0, a.GetNumPages());
+  for (page_id_t id = 4; id < 16; ++id) {
+    EXPECT_EQ(id >= 8 && id < 12, disk_manager->IsAllocated(id));
+  }
+  Segment c(bpm.get(), extent_size);
+  auto *page = c.NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(4, page_id);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // The page of b was not touched by any of this.
+  page = bpm->FetchPage(b_page);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp("page 8", page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(b_page, false));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, GroupReservationTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  const size_t extent_size = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  auto index_group = bpm->GetGroup("index");
+  EXPECT_EQ(0, bpm->GetGroup("default"));
+  EXPECT_EQ(1, index_group);
+  EXPECT_EQ(std::nullopt, bpm->FindGroup("heap"));
+  // Fills the pool with newer pages accessed k times, which would evict every older page.
+  auto flood = [&bpm]() {
+    page_id_t page_id;
+    for (int i = 0; i < 30; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  };
+
+  // Scenario: the pages of a segment are loaded into its group.
+  Segment index(bpm.get(), extent_size, index_group);
+  std::vector<page_id_t> index_pages;
+  for (size_t i = 0; i < extent_size; ++i) {
+    page_id_t page_id;
+    auto *page = index.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    index_pages.push_back(page_id);
+  }
+  EXPECT_EQ(4, bpm->GetGroupSize(index_group));
+
+  // Scenario: the oldest pages of the pool survive a flood of newer pages as long as their group reserves them.
+  bpm->SetGroupReservation(index_group, 4);
+  EXPECT_EQ(4, bpm->GetGroupReservation(index_group));
+  flood();
+  EXPECT_EQ(4, bpm->GetGroupSize(index_group));
+  EXPECT_EQ(6, bpm->GetGroupSize(0));
+  for (auto page_id : index_pages) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(fmt::format("page {}", page_id), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a group above its reservation gives up the frames beyond it.
+  bpm->SetGroupReservation(index_group, 2);
+  flood();
+  EXPECT_EQ(2, bpm->GetGroupSize(index_group));
+
+  // Scenario: moving the segment back to the default group moves its resident pages too.
+  index.SetGroup(0);
+  EXPECT_EQ(0, bpm->GetGroupSize(index_group));
+  flood();
+  EXPECT_EQ(10, bpm->GetGroupSize(0));
+
+  // Scenario: the number of groups is bounded.
+  for (size_t i = 2; i < BUFFER_POOL_MAX_GROUPS; ++i) {
+    EXPECT_EQ(i, bpm->GetGroup(fmt::format("group{}", i)));
+  }
+  EXPECT_THROW(bpm->GetGroup("one too many"), Exception);
+  EXPECT_THROW(bpm->SetGroupReservation(index_group, buffer_pool_size + 1), std::logic_error);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: pages 0-3 are written back and evicted, then pages 10-13 are deleted to leave 4 free frames.
+  page_id_t page_id;
+  for (size_t i = 0; i < 14; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t i = 10; i < 14; ++i) {
+    EXPECT_EQ(true, bpm->DeletePage(i));
+  }
+
+  // Scenario: prefetching a resident page does nothing.
+  bpm->PrefetchPage(9);
+  EXPECT_EQ(0, bpm->GetPrefetchCount());
+
+  // Scenario: prefetched pages are loaded unpinned, and the first fetch of each is a prefetch hit.
+  for (page_id_t i = 0; i < 4; ++i) {
+    bpm->PrefetchPage(i);
+  }
+  EXPECT_EQ(4, bpm->GetPrefetchCount());
+  for (page_id_t i = 0; i < 4; ++i) {
+    auto *page = bpm->FetchPage(i, AccessType::Scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(fmt::format("page {}", i), page->GetData());
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(4, bpm->GetPrefetchHitCount());
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(4, bpm->GetPrefetchHitCount());
+
+  // Scenario: prefetching backs off once half of the pool is pinned.
+  for (page_id_t i = 4; i < 9; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  bpm->PrefetchPage(10);
+  EXPECT_EQ(4, bpm->GetPrefetchCount());
+  for (page_id_t i = 4; i < 9; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: a dirty victim written back by a prefetch is not counted as a foreground flush.
+  for (page_id_t i = 0; i < 10; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  auto foreground_flushes = bpm->GetForegroundFlushCount();
+  bpm->PrefetchPage(10);
+  EXPECT_EQ(5, bpm->GetPrefetchCount());
+  ASSERT_NE(nullptr, bpm->FetchPage(10));
+  EXPECT_EQ(true, bpm->UnpinPage(10, false));
+  EXPECT_EQ(1, bpm->GetPrefetchFlushCount());
+  EXPECT_EQ(foreground_flushes, bpm->GetForegroundFlushCount());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  remove("test.db");
+  remove("test.fsm");
+  remove("test.warm");
+  enable_warm_restart = true;
+
+  auto read_dump = [] {
+    std::vector<page_id_t> page_ids(20);
+    std::ifstream warm_io("test.warm", std::ios::binary);
+    warm_io.read(reinterpret_cast<char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+    page_ids.resize(warm_io.gcount() / sizeof(page_id_t));
+    return page_ids;
+  };
+
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(0, bpm->GetWarmUpCount());
+  page_id_t page_id;
+  for (int i = 0; i < 20; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  // Pages 15-19 are used again and again, while page 12 is held by someone.
+  for (int round = 0; round < 2; ++round) {
+    for (page_id_t id = 15; id < 20; ++id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(id));
+      EXPECT_EQ(true, bpm->UnpinPage(id, false));
+    }
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(12));
+
+  // Scenario: the dump lists the pages in use first, then the evictable pages from the hottest to the coldest.
+  EXPECT_EQ(buffer_pool_size, bpm->DumpResidentPages());
+  auto page_ids = read_dump();
+  ASSERT_EQ(buffer_pool_size, page_ids.size());
+  EXPECT_EQ(12, page_ids[0]);
+  std::sort(page_ids.begin() + 1, page_ids.begin() + 6);
+  std::sort(page_ids.begin() + 6, page_ids.end());
+  EXPECT_EQ((std::vector<page_id_t>{12, 15, 16, 17, 18, 19, 10, 11, 13, 14}), page_ids);
+
+  // Scenario: a pool that goes away leaves its final hot set behind.
+  EXPECT_EQ(true, bpm->UnpinPage(12, false));
+  bpm->FlushAllPages();
+  bpm.reset();
+  page_ids = read_dump();
+  ASSERT_EQ(buffer_pool_size, page_ids.size());
+  page_ids.resize(5);
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ((std::vector<page_id_t>{15, 16, 17, 18, 19}), page_ids);
+  disk_manager->ShutDown();
+
+  // Scenario: after a restart, a smaller pool loads the hottest pages that fit into it.
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(5, disk_manager.get(), k);
+  EXPECT_EQ(5, bpm->GetWarmUpCount());
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetWarmUpLoadedCount() < 5 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(5, bpm->GetWarmUpLoadedCount());
+  for (page_id_t id = 15; id < 20; ++id) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(fmt::format("page {}", id), page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(id, false));
+  }
+  // The pool is full, so warming up again does nothing.
+  EXPECT_EQ(0, bpm->WarmUp());
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  // Scenario: with warm restart disabled, nothing is loaded.
+  enable_warm_restart = false;
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(0, bpm->GetWarmUpCount());
+  EXPECT_EQ(0, bpm->WarmUp());
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  remove("test.db");
+  remove("test.fsm");
+  remove("test.warm");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, SwizzleTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 5;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  // Scenario: a swizzled page keeps a pin of its own, and its swip leads to it without a fetch.
+  Swip swip{0};
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "swizzled");
+  EXPECT_TRUE(bpm->TryFetchSwizzledRead(&swip, page_id).IsEmpty());
+  bpm->SwizzlePage(&swip, page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(1, bpm->GetSwizzledCount());
+  {
+    ReadPageGuard guard = bpm->TryFetchSwizzledRead(&swip, page_id);
+    ASSERT_FALSE(guard.IsEmpty());
+    EXPECT_EQ(0, strcmp(guard.GetData(), "swizzled"));
+    // a writer cannot get in while it is latched, and a swip is only followed for the page it points at
+    EXPECT_FALSE(page->TryWLatch());
+    EXPECT_TRUE(bpm->TryFetchSwizzledRead(&swip, page_id + 1).IsEmpty());
+  }
+  EXPECT_EQ(1, page->GetPinCount());
+
+  // Scenario: a quarter of the frames can be swizzled.
+  Swip other_swip{0};
+  page_id_t other_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&other_page_id));
+  bpm->SwizzlePage(&other_swip, other_page_id);
+  page_id_t over_budget_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&over_budget_page_id));
+  bpm->SwizzlePage(&other_swip, over_budget_page_id);
+  EXPECT_EQ(2, bpm->GetSwizzledCount());
+  EXPECT_FALSE(bpm->TryFetchSwizzledRead(&other_swip, other_page_id).IsEmpty());
+  EXPECT_EQ(true, bpm->UnpinPage(other_page_id, false));
+  EXPECT_EQ(true, bpm->UnpinPage(over_budget_page_id, false));
+
+  // Scenario: once every other frame is pinned, a new page unswizzles a swizzled frame, and its swip no longer leads
+  // anywhere.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size - 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&pinned.emplace_back()));
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(&pinned.emplace_back()));
+  EXPECT_EQ(1, bpm->GetUnswizzleCount());
+  EXPECT_EQ(1, bpm->GetSwizzledCount());
+  ASSERT_NE(nullptr, bpm->NewPage(&pinned.emplace_back()));
+  EXPECT_EQ(0, bpm->GetSwizzledCount());
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->TryFetchSwizzledRead(&swip, 0).IsEmpty());
+  for (auto id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(id, false));
+  }
+
+  // Scenario: a swizzled page comes back from disk, and can be deleted once nobody else has it pinned.
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "swizzled"));
+  bpm->SwizzlePage(&swip, 0);
+  EXPECT_EQ(false, bpm->DeletePage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  EXPECT_EQ(0, bpm->GetSwizzledCount());
+  EXPECT_TRUE(bpm->TryFetchSwizzledRead(&swip, 0).IsEmpty());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  // Scenario: a pool much larger than the test ever touches is created without touching its memory.
+  const size_t buffer_pool_size = 1 << 18;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: every frame is page-aligned, so it can be handed to O_DIRECT as it is, and starts out zeroed.
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 10; ++i) {
+    auto *page = bpm->NewPage(&page_ids.emplace_back());
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % BUSTUB_PAGE_SIZE);
+    EXPECT_EQ(0, page->GetData()[BUSTUB_PAGE_SIZE - 1]);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", i);
+  }
+  auto *last = &bpm->GetPages()[buffer_pool_size - 1];
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(last->GetData()) % BUSTUB_PAGE_SIZE);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(fmt::format("page {}", i), guard.GetData());
+  }
+
+  // Scenario: arenas of at least a huge page start on a huge page boundary.
+  FrameArena small(3);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(small.GetFrame(2)) % BUSTUB_PAGE_SIZE);
+  memset(small.GetFrame(2), 1, BUSTUB_PAGE_SIZE);
+  FrameArena large(HUGE_PAGE_SIZE / BUSTUB_PAGE_SIZE);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large.GetFrame(0)) % HUGE_PAGE_SIZE);
+}
+
 }  // namespace bustub
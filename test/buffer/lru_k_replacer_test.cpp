@@ -96,6 +96,92 @@ TEST(LRUKReplacerTest, SampleTest) {
   ASSERT_EQ(0, lru_replacer.Size());
 }
 
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(6, 2);
+
+  // Scenario: frames 0 and 1 are used by point lookups, then a scan brings in frames 2, 3, 4 and touches frame 1.
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  lru_replacer.RecordAccess(0, AccessType::Get);
+  lru_replacer.RecordAccess(2, AccessType::Scan);
+  lru_replacer.RecordAccess(3, AccessType::Scan);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  for (int i = 0; i < 5; ++i) {
+    lru_replacer.SetEvictable(i, true);
+  }
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // Scenario: frames only touched by the scan are evicted first, in LRU order, even though they are more recent.
+  int value;
+  for (int expected : {2, 3, 4}) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+
+  // Scenario: the scan did not refresh frame 1, which still has a single access and goes before frame 0.
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // Scenario: a frame loaded by a scan and later used by a lookup starts a fresh history at that lookup.
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  lru_replacer.RecordAccess(2, AccessType::Get);
+  lru_replacer.RecordAccess(5, AccessType::Get);
+  lru_replacer.SetEvictable(5, true);
+  lru_replacer.SetEvictable(2, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+}
+
+TEST(LRUKReplacerTest, GroupReservationTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Frames 0 and 1 hold index pages of group 1, which reserves 2 frames. They are older than the other frames.
+  lru_replacer.SetReservation(1, 2);
+  for (int i = 0; i < 5; ++i) {
+    lru_replacer.RecordAccess(i);
+    lru_replacer.SetEvictable(i, true);
+  }
+  lru_replacer.SetGroup(0, 1);
+  lru_replacer.SetGroup(1, 1);
+  ASSERT_EQ(2, lru_replacer.GetGroupSize(1));
+  ASSERT_EQ(3, lru_replacer.GetGroupSize(0));
+
+  // Scenario: the frames of the default group go first, then the reserved ones, each in LRU-K order.
+  ASSERT_EQ((std::vector<frame_id_t>{2, 3, 4, 0, 1}), lru_replacer.PeekVictims(5));
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(2, lru_replacer.GetGroupSize(0));
+
+  // Scenario: a group holding more frames than it reserved competes with the other groups for all of them.
+  lru_replacer.RecordAccess(5);
+  lru_replacer.SetGroup(5, 1);
+  lru_replacer.SetEvictable(5, true);
+  ASSERT_EQ(3, lru_replacer.GetGroupSize(1));
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(2, lru_replacer.GetGroupSize(1));
+
+  // Scenario: without a reservation the group is ordered like any other frames.
+  lru_replacer.SetReservation(1, 0);
+  ASSERT_EQ((std::vector<frame_id_t>{1, 3, 4, 5}), lru_replacer.PeekVictims(4));
+
+  // Scenario: a frame moved back to the default group keeps its history, and an evicted frame leaves its group.
+  lru_replacer.SetReservation(1, 2);
+  lru_replacer.SetGroup(1, 0);
+  ASSERT_EQ((std::vector<frame_id_t>{1, 3, 4, 5}), lru_replacer.PeekVictims(4));
+  lru_replacer.Remove(5);
+  ASSERT_EQ(0, lru_replacer.GetGroupSize(1));
+  ASSERT_EQ(3, lru_replacer.Size());
+}
+
 TEST(LRUKReplacerTest, ConcurrencyTest) {
   const size_t frame_num = 100;
   LRUKReplacer lru_replacer(frame_num, 2);
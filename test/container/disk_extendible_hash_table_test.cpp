@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_extendible_hash_table_test.cpp
+//
+// Identification: test/container/disk_extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "container/disk/hash/disk_extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+using HashTable = DiskExtendibleHashTable<int, int, IntComparator>;
+
+// NOLINTNEXTLINE
+TEST(DiskExtendibleHashTableTest, SplitMergeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // a key has any number of values, but each pair is there once
+  const int n = 20000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ASSERT_FALSE(ht.Insert(nullptr, 7, 7));
+  ASSERT_TRUE(ht.Insert(nullptr, 7, 8));
+  ht.VerifyIntegrity();
+  ASSERT_GT(ht.GetGlobalDepth(), 4);
+
+  for (int i = 0; i < n; i++) {
+    std::vector<int> result;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &result));
+    ASSERT_EQ(result.size(), i == 7 ? 2 : 1);
+    ASSERT_EQ(result[0], i);
+  }
+  std::vector<int> result;
+  ASSERT_FALSE(ht.GetValue(nullptr, n, &result));
+
+  // emptied buckets merge back until the directory is a single bucket again
+  ASSERT_TRUE(ht.Remove(nullptr, 7, 8));
+  ASSERT_FALSE(ht.Remove(nullptr, 7, 8));
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  ASSERT_EQ(ht.GetGlobalDepth(), 0);
+  ASSERT_FALSE(ht.GetValue(nullptr, 0, &result));
+
+  // and grow again
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, -i));
+  }
+  ht.VerifyIntegrity();
+  ASSERT_TRUE(ht.GetValue(nullptr, 999, &result));
+  ASSERT_EQ(result, std::vector<int>{-999});
+}
+
+// NOLINTNEXTLINE
+TEST(DiskExtendibleHashTableTest, OverflowTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // the values of a key that fill several buckets go to overflow pages instead of splitting the directory to its end
+  const int n = 3000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, 7, i));
+  }
+  ASSERT_FALSE(ht.Insert(nullptr, 7, 0));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, 1000 + i, i));
+  }
+  ht.VerifyIntegrity();
+  ASSERT_LT(ht.GetGlobalDepth(), 9);
+
+  std::vector<int> result;
+  ASSERT_TRUE(ht.GetValue(nullptr, 7, &result));
+  ASSERT_EQ(result.size(), n);
+  result.clear();
+  ASSERT_TRUE(ht.GetValue(nullptr, 1042, &result));
+  ASSERT_EQ(result, std::vector<int>{42});
+
+  // overflow pages that run empty are dropped, and the emptied buckets merge back
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, 7, i));
+  }
+  ASSERT_FALSE(ht.Remove(nullptr, 7, 0));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, 1000 + i, i));
+  }
+  ht.VerifyIntegrity();
+  ASSERT_EQ(ht.GetGlobalDepth(), 0);
+  result.clear();
+  ASSERT_FALSE(ht.GetValue(nullptr, 7, &result));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskExtendibleHashTableTest, UniqueTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), HashFunction<int>(), true);
+
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    ASSERT_FALSE(ht.Insert(nullptr, i, i + 1));
+  }
+  ASSERT_TRUE(ht.Remove(nullptr, 5, 5));
+  ASSERT_TRUE(ht.Insert(nullptr, 5, 6));
+  std::vector<int> result;
+  ASSERT_TRUE(ht.GetValue(nullptr, 5, &result));
+  ASSERT_EQ(result, std::vector<int>{6});
+}
+
+// NOLINTNEXTLINE
+TEST(DiskExtendibleHashTableTest, ConcurrentTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // every thread inserts its own keys, reads them back and removes every other one while the others split and merge
+  const int num_threads = 8;
+  const int per_thread = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_threads * per_thread; i += num_threads) {
+        ASSERT_TRUE(ht.Insert(nullptr, i, i));
+      }
+      for (int i = t; i < num_threads * per_thread; i += num_threads) {
+        std::vector<int> result;
+        ASSERT_TRUE(ht.GetValue(nullptr, i, &result));
+        ASSERT_EQ(result, std::vector<int>{i});
+        if (i % 2 == 0) {
+          ASSERT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_threads * per_thread; i++) {
+    std::vector<int> result;
+    ASSERT_EQ(ht.GetValue(nullptr, i, &result), i % 2 == 1);
+  }
+}
+
+}  // namespace bustub
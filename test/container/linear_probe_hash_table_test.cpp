@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+using HashTable = LinearProbeHashTable<int, int, IntComparator>;
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, IncrementalResizeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), 10000, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+  ASSERT_GE(initial_size, 10000);
+
+  // fill the table up to the point where it grows
+  int n = 0;
+  while (!ht.IsMigrating()) {
+    ASSERT_TRUE(ht.Insert(nullptr, n, n));
+    n++;
+  }
+  ASSERT_EQ(ht.GetSize(), 2 * initial_size);
+
+  // while the entries move over, lookups and removes see both tables and duplicates are still caught
+  for (int i = 0; i < n; i++) {
+    std::vector<int> result;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &result));
+    ASSERT_EQ(result, std::vector<int>{i});
+  }
+  ASSERT_FALSE(ht.Insert(nullptr, 0, 0));
+  ASSERT_TRUE(ht.Remove(nullptr, 1, 1));
+  ASSERT_FALSE(ht.Remove(nullptr, 1, 1));
+
+  // every insert moves a block, so the migration ends long before the new table fills up
+  int inserts = 0;
+  while (ht.IsMigrating()) {
+    ASSERT_TRUE(ht.Insert(nullptr, n, n));
+    n++;
+    inserts++;
+  }
+  using KeyType = int;
+  using ValueType = int;
+  ASSERT_LE(inserts, initial_size / BLOCK_ARRAY_SIZE);
+  ASSERT_EQ(ht.GetSize(), 2 * initial_size);
+
+  ASSERT_TRUE(ht.Insert(nullptr, 0, 1));
+  for (int i = 0; i < n; i++) {
+    std::vector<int> result;
+    ASSERT_EQ(ht.GetValue(nullptr, i, &result), i != 1);
+    if (i == 0) {
+      ASSERT_EQ(result.size(), 2);
+    } else if (i != 1) {
+      ASSERT_EQ(result, std::vector<int>{i});
+    }
+  }
+
+  // an explicit resize finishes a migration in progress before it starts another one
+  ht.Resize(ht.GetSize());
+  ASSERT_EQ(ht.GetSize(), 4 * initial_size);
+  ASSERT_TRUE(ht.IsMigrating());
+  ht.Resize(ht.GetSize());
+  ASSERT_EQ(ht.GetSize(), 8 * initial_size);
+  for (int i = 2; i < n; i++) {
+    std::vector<int> result;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &result));
+    ASSERT_EQ(result, std::vector<int>{i});
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ChurnTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), 1000, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // removes leave tombstones behind, a table that fills up with them is rebuilt at its size instead of doubling
+  const int window = 300;
+  const int n = 100000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    if (i >= window) {
+      ASSERT_TRUE(ht.Remove(nullptr, i - window, i - window));
+    }
+    ASSERT_EQ(ht.GetSize(), initial_size);
+  }
+  for (int i = n - 2 * window; i < n; i++) {
+    std::vector<int> result;
+    ASSERT_EQ(ht.GetValue(nullptr, i, &result), i >= n - window);
+  }
+
+  // entries that take more than half of the table still make it double
+  for (int i = n; ht.GetSize() == initial_size; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ASSERT_EQ(ht.GetSize(), 2 * initial_size);
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentInsertTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashTable ht("foo", bpm.get(), IntComparator(), 1000, HashFunction<int>());
+
+  // the threads insert the same keys, so each pair goes in once, across several resizes
+  const int num_threads = 8;
+  const int num_keys = 20000;
+  std::vector<std::thread> threads;
+  std::atomic<int> inserted{0};
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, &inserted, t]() {
+      for (int i = 0; i < num_keys; i++) {
+        int key = (i + t * num_keys / num_threads) % num_keys;
+        if (ht.Insert(nullptr, key, key)) {
+          inserted++;
+        }
+        std::vector<int> result;
+        ASSERT_TRUE(ht.GetValue(nullptr, key, &result));
+        ASSERT_EQ(result, std::vector<int>{key});
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(inserted, num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> result;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &result));
+    ASSERT_EQ(result, std::vector<int>{i});
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static auto MakeEntries(const std::vector<int64_t> &keys) -> std::vector<std::pair<GenericKey<8>, RID>> {
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (auto key : keys) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF));
+  }
+  return entries;
+}
+
+static void CheckKeys(Tree *tree, int64_t first, int64_t last) {
+  int64_t expected = first;
+  for (auto iter = tree->Begin(); iter != tree->End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), expected);
+    ASSERT_EQ((*iter).second.GetSlotNum(), expected);
+    expected++;
+  }
+  ASSERT_EQ(expected, last + 1);
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree with small nodes, so that the load builds several internal levels
+  Tree tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 5);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+  // duplicates keep the first entry, like Insert
+  keys.push_back(7);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(445));
+  auto entries = MakeEntries(keys);
+  tree.BulkLoad(&entries, 0.75);
+  CheckKeys(&tree, 1, 1000);
+
+  std::vector<RID> result;
+  for (int64_t key = 1; key <= 1000; key++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    result.clear();
+    ASSERT_TRUE(tree.GetValue(index_key, &result));
+    ASSERT_EQ(result.size(), 1);
+    ASSERT_EQ(result[0].GetSlotNum(), key);
+  }
+
+  // The loaded tree takes inserts and removes like any other tree.
+  auto *transaction = new Transaction(0);
+  for (int64_t key = 1001; key <= 1200; key++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  CheckKeys(&tree, 1, 1200);
+  for (int64_t key = 1; key <= 1100; key++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  CheckKeys(&tree, 1101, 1200);
+
+  // Loading into a tree that is not empty inserts the entries.
+  auto more_entries = MakeEntries({1, 2, 3});
+  tree.BulkLoad(&more_entries);
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(2);
+  result.clear();
+  ASSERT_TRUE(tree.GetValue(index_key, &result));
+
+  delete transaction;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, BulkLoadParallelSortTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  Tree tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+
+  // enough keys to be sorted in several runs
+  const int64_t num_keys = 4 * BULK_LOAD_SORT_RUN + 123;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  auto entries = MakeEntries(keys);
+  tree.BulkLoad(&entries);
+  CheckKeys(&tree, 1, num_keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+}  // namespace bustub
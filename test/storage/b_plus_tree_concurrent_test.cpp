@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -128,12 +129,12 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator);
   // keys to Insert
   std::vector<int64_t> keys;
   int64_t scale_factor = 100;
@@ -167,7 +168,6 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete bpm;
 }
 
 TEST(BPlusTreeConcurrentTest, InsertTest2) {
@@ -175,12 +175,12 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator);
   // keys to Insert
   std::vector<int64_t> keys;
   int64_t scale_factor = 100;
@@ -214,7 +214,6 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete bpm;
 }
 
 TEST(BPlusTreeConcurrentTest, DeleteTest1) {
@@ -223,14 +222,14 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
 
   GenericKey<8> index_key;
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator);
   // sequential insert
   std::vector<int64_t> keys = {1, 2, 3, 4, 5};
   InsertHelper(&tree, keys);
@@ -253,7 +252,6 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   EXPECT_EQ(size, 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete bpm;
 }
 
 TEST(BPlusTreeConcurrentTest, DeleteTest2) {
@@ -262,13 +260,13 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
   GenericKey<8> index_key;
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator);
 
   // sequential insert
   std::vector<int64_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
@@ -292,7 +290,6 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   EXPECT_EQ(size, 4);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete bpm;
 }
 
 TEST(BPlusTreeConcurrentTest, MixTest1) {
@@ -301,13 +298,13 @@ TEST(BPlusTreeConcurrentTest, MixTest1) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
 
   // create and fetch header_page
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator);
   GenericKey<8> index_key;
   // first, populate index
   std::vector<int64_t> keys = {1, 2, 3, 4, 5};
@@ -333,7 +330,6 @@ TEST(BPlusTreeConcurrentTest, MixTest1) {
   EXPECT_EQ(size, 5);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete bpm;
 }
 
 TEST(BPlusTreeConcurrentTest, MixTest2) {
@@ -342,7 +338,7 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   GenericComparator<8> comparator(key_schema.get());
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
 
   // create and fetch header_page
   page_id_t page_id;
@@ -350,7 +346,7 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   (void)header_page;
 
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator);
 
   // Add perserved_keys
   std::vector<int64_t> perserved_keys;
@@ -399,7 +395,238 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   ASSERT_EQ(size, perserved_keys.size());
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, ScanTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree, with small nodes so that writers keep splitting and merging leaves under the scans
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator, 4, 5);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t total_keys = 1000;
+  int64_t sieve = 5;
+  for (int64_t i = 1; i <= total_keys; i++) {
+    if (i % sieve == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  auto insert_task = [&](int tid) { InsertHelper(&tree, dynamic_keys, tid); };
+  auto delete_task = [&](int tid) { DeleteHelper(&tree, dynamic_keys, tid); };
+  auto scan_task = [&](int tid) {
+    for (int round = 0; round < 20; round++) {
+      // every scan sees the keys in order, and all the keys no writer touches
+      std::vector<std::pair<GenericKey<8>, RID>> batch;
+      int64_t last_key = 0;
+      size_t perserved = 0;
+      auto iter = tree.Begin();
+      while (iter.NextBatch(&batch, 7) > 0) {
+        ASSERT_LE(batch.size(), 7);
+        for (const auto &pair : batch) {
+          ASSERT_LT(last_key, pair.first.ToString());
+          last_key = pair.first.ToString();
+          perserved += last_key % sieve == 0 ? 1 : 0;
+        }
+      }
+      ASSERT_EQ(perserved, perserved_keys.size());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  std::vector<std::function<void(int)>> tasks;
+  tasks.emplace_back(insert_task);
+  tasks.emplace_back(delete_task);
+  tasks.emplace_back(scan_task);
+
+  size_t num_threads = 6;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    threads[i].join();
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeConcurrentTest, LookupTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree, with small nodes so that lookups keep racing splits that have not reached the parent yet
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator, 3, 4);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t sieve = 3;
+  for (int64_t i = 1; i <= 3000; i++) {
+    if (i % sieve == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  auto write_task = [&](int tid) {
+    for (int round = 0; round < 3; round++) {
+      InsertHelperSplit(&tree, dynamic_keys, 4, tid);
+      DeleteHelperSplit(&tree, dynamic_keys, 4, tid);
+    }
+  };
+  auto lookup_task = [&]([[maybe_unused]] int tid) {
+    // every lookup of a key no writer touches finds it, wherever the writers are
+    for (int round = 0; round < 5; round++) {
+      for (auto key : perserved_keys) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        std::vector<RID> rids;
+        ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        ASSERT_EQ(rids.size(), 1);
+        ASSERT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back(write_task, i);
+  }
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back(lookup_task, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // the writers removed all they inserted
+  size_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString() % sieve, 0);
+    size++;
+  }
+  ASSERT_EQ(size, perserved_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeConcurrentTest, ReclaimUnderLookupsTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator, 3, 4);
+
+  std::vector<int64_t> keys;
+  for (int64_t i = 1; i <= 1000; i++) {
+    keys.push_back(i);
+  }
+  InsertHelper(&tree, keys, 1);
+  size_t num_pages = tree.GetNumPages();
+
+  // there is always a lookup running while the keys are removed
+  std::atomic<bool> done{false};
+  auto lookup_task = [&]([[maybe_unused]] int tid) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(1);
+    while (!done) {
+      std::vector<RID> rids;
+      tree.GetValue(index_key, &rids);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back(lookup_task, i);
+  }
+
+  std::vector<int64_t> remove_keys(keys.begin() + 1, keys.end());
+  DeleteHelper(&tree, remove_keys, 1);
+  // later operations still free the pages the removes retired
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(0);
+  for (int i = 0; i < 1000 && tree.GetNumPages() > num_pages / 10; i++) {
+    tree.Remove(index_key, nullptr);
+  }
+  size_t num_pages_left = tree.GetNumPages();
+
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_LE(num_pages_left, num_pages / 10);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeConcurrentTest, SwizzleTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small internal pages, so that there are many of them, a few more than can be swizzled
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm.get(), comparator, 20, 4);
+  std::vector<int64_t> keys;
+  for (int64_t i = 1; i <= 2000; i++) {
+    keys.push_back(i);
+  }
+  // searches swizzle the header and the internal pages they descend through, and then follow their swips
+  InsertHelper(&tree, keys);
+  ASSERT_EQ(bpm->GetSwizzledCount(), 50 / SWIZZLE_BUDGET_DIVISOR);
+  LaunchParallelTest(4, LookupHelper, &tree, keys, 0);
+
+  // merges take swizzled internal pages out of the tree while lookups follow swips to them
+  std::vector<int64_t> remove_keys(keys.begin() + 100, keys.end());
+  std::vector<int64_t> kept_keys(keys.begin(), keys.begin() + 100);
+  std::thread lookups([&] {
+    for (int round = 0; round < 20; round++) {
+      LookupHelper(&tree, kept_keys, 1);
+    }
+  });
+  LaunchParallelTest(2, DeleteHelperSplit, &tree, remove_keys, 2);
+  lookups.join();
+
+  size_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_LE((*iter).first.ToString(), 100);
+    size++;
+  }
+  ASSERT_EQ(size, kept_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 }  // namespace bustub
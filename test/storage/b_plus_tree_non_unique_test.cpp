@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_non_unique_test.cpp
+//
+// Identification: test/storage/b_plus_tree_non_unique_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static auto MakeKey(int64_t value) -> GenericKey<8> {
+  GenericKey<8> key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+static auto Less(const RID &lhs, const RID &rhs) -> bool { return lhs.Get() < rhs.Get(); }
+
+// GetValue, the iterator, batches of the iterator and the reverse iterator all see the expected key & RID pairs, in
+// order
+static void CheckTree(Tree *tree, std::map<int64_t, std::vector<RID>> expected) {
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (auto &[key, rids] : expected) {
+    std::sort(rids.begin(), rids.end(), Less);
+    std::vector<RID> result;
+    ASSERT_EQ(tree->GetValue(MakeKey(key), &result), !rids.empty());
+    ASSERT_EQ(result, rids);
+    for (const auto &rid : rids) {
+      pairs.emplace_back(key, rid);
+    }
+  }
+
+  auto iter = tree->Begin();
+  for (const auto &[key, rid] : pairs) {
+    ASSERT_FALSE(iter.IsEnd());
+    ASSERT_EQ((*iter).first.ToString(), key);
+    ASSERT_EQ((*iter).second, rid);
+    ++iter;
+  }
+  ASSERT_TRUE(iter.IsEnd());
+
+  size_t i = 0;
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  for (auto batch_iter = tree->Begin(); batch_iter.NextBatch(&batch, 100) > 0;) {
+    for (const auto &[key, rid] : batch) {
+      ASSERT_LT(i, pairs.size());
+      ASSERT_EQ(key.ToString(), pairs[i].first);
+      ASSERT_EQ(rid, pairs[i].second);
+      i++;
+    }
+  }
+  ASSERT_EQ(i, pairs.size());
+
+  auto reverse_iter = tree->RBegin();
+  for (auto it = pairs.rbegin(); it != pairs.rend(); ++it) {
+    ASSERT_FALSE(reverse_iter.IsEnd());
+    ASSERT_EQ((*reverse_iter).first.ToString(), it->first);
+    ASSERT_EQ((*reverse_iter).second, it->second);
+    ++reverse_iter;
+  }
+  ASSERT_TRUE(reverse_iter.IsEnd());
+
+  // a reverse scan from a bound starts at the last entry of the greatest key not above it
+  for (const auto &[bound, rids] : expected) {
+    auto last = std::find_if(pairs.rbegin(), pairs.rend(), [&](const auto &pair) { return pair.first <= bound; });
+    auto iter = tree->RBegin([&](const GenericKey<8> &key) { return key.ToString() <= bound; });
+    if (last == pairs.rend()) {
+      ASSERT_TRUE(iter.IsEnd());
+    } else {
+      ASSERT_FALSE(iter.IsEnd());
+      ASSERT_EQ((*iter).first.ToString(), last->first);
+      ASSERT_EQ((*iter).second, last->second);
+    }
+  }
+}
+
+static void CheckInsertRemove(int leaf_max_size, int internal_max_size) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm.get(), comparator, leaf_max_size, internal_max_size, false);
+
+  // A few keys with thousands of RIDs each, enough to spill over several posting pages, among many keys with one.
+  std::mt19937 gen(15445);
+  std::map<int64_t, std::vector<RID>> expected;
+  for (int i = 0; i < 20000; i++) {
+    int64_t key = i % 2 == 0 ? gen() % 3 : 100 + gen() % 5000;
+    RID rid(static_cast<page_id_t>(gen() % 1000), static_cast<uint32_t>(gen() % 50));
+    auto &rids = expected[key];
+    bool present = std::find(rids.begin(), rids.end(), rid) != rids.end();
+    ASSERT_EQ(tree.Insert(MakeKey(key), rid), !present);
+    if (!present) {
+      rids.push_back(rid);
+    }
+  }
+  CheckTree(&tree, expected);
+
+  // Remove most RIDs one by one, leaving keys with a single RID or none.
+  for (auto &[key, rids] : expected) {
+    std::shuffle(rids.begin(), rids.end(), gen);
+    while (rids.size() > static_cast<size_t>(key % 2)) {
+      tree.Remove(MakeKey(key), rids.back(), nullptr);
+      rids.pop_back();
+    }
+    // removing a RID that is not there leaves the key alone
+    tree.Remove(MakeKey(key), RID(5000, 0), nullptr);
+  }
+  CheckTree(&tree, expected);
+
+  // Removing a key drops all its RIDs.
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(tree.Insert(MakeKey(1), RID(2000 + i, 0)));
+  }
+  tree.Remove(MakeKey(1), nullptr);
+  expected[1].clear();
+  CheckTree(&tree, expected);
+  bpm->UnpinPage(page_id, true);
+}
+
+TEST(BPlusTreeTests, NonUniqueInsertRemoveTest) { CheckInsertRemove(200, 200); }
+
+TEST(BPlusTreeTests, NonUniqueSmallPagesTest) { CheckInsertRemove(3, 4); }
+
+TEST(BPlusTreeTests, NonUniqueBulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm.get(), comparator, 200, 200, false);
+
+  // a low-cardinality column, such as a status
+  std::map<int64_t, std::vector<RID>> expected;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (int i = 0; i < 30000; i++) {
+    RID rid(i / 100, i % 100);
+    entries.emplace_back(MakeKey(i % 7), rid);
+    expected[i % 7].push_back(rid);
+  }
+  entries.emplace_back(MakeKey(100), RID(0, 0));
+  expected[100].emplace_back(0, 0);
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(445));
+  tree.BulkLoad(&entries);
+  CheckTree(&tree, expected);
+
+  ASSERT_FALSE(tree.Insert(MakeKey(3), RID(0, 3)));
+  ASSERT_TRUE(tree.Insert(MakeKey(3), RID(1000, 3)));
+  expected[3].emplace_back(1000, 3);
+  tree.Remove(MakeKey(3), RID(0, 10), nullptr);
+  expected[3].erase(std::find(expected[3].begin(), expected[3].end(), RID(0, 10)));
+  CheckTree(&tree, expected);
+  bpm->UnpinPage(page_id, true);
+}
+
+TEST(BPlusTreeTests, UniqueRejectsDuplicatesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", page_id, bpm.get(), comparator);
+
+  ASSERT_TRUE(tree.Insert(MakeKey(1), RID(1, 1)));
+  ASSERT_FALSE(tree.Insert(MakeKey(1), RID(1, 2)));
+  // a unique tree only removes the key with the RID it has
+  tree.Remove(MakeKey(1), RID(1, 2), nullptr);
+  CheckTree(&tree, {{1, {RID(1, 1)}}});
+  tree.Remove(MakeKey(1), RID(1, 1), nullptr);
+  CheckTree(&tree, {{1, {}}});
+  bpm->UnpinPage(page_id, true);
+}
+
+}  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_prefix_compression_test.cpp
+//
+// Identification: test/storage/b_plus_tree_prefix_compression_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+
+template <size_t KeySize>
+static auto MakeKey(const std::string &str) -> NormalizedKey<KeySize> {
+  NormalizedKey<KeySize> key;
+  memset(key.data_, 0, KeySize);
+  memcpy(key.data_, str.data(), std::min(str.size(), KeySize));
+  return key;
+}
+
+// keys with a long common prefix, like the values of a string column with a fixed format
+static auto UserName(int id) -> std::string {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "user_%08d", id);
+  return buf;
+}
+
+template <size_t KeySize>
+static void CheckTree(BPlusTree<NormalizedKey<KeySize>, RID, NormalizedComparator<KeySize>> *tree,
+                      const std::vector<int> &expected) {
+  auto iter = tree->Begin();
+  for (int id : expected) {
+    ASSERT_FALSE(iter.IsEnd());
+    ASSERT_EQ(memcmp((*iter).first.data_, MakeKey<KeySize>(UserName(id)).data_, KeySize), 0);
+    ASSERT_EQ((*iter).second.GetSlotNum(), id);
+    ++iter;
+  }
+  ASSERT_TRUE(iter.IsEnd());
+}
+
+template <size_t KeySize>
+static void CheckInsertRemove() {
+  NormalizedComparator<KeySize> comparator(nullptr);
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(100, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<NormalizedKey<KeySize>, RID, NormalizedComparator<KeySize>> tree("foo_pk", page_id, bpm.get(), comparator);
+
+  // Enough keys for a few levels, with ids from several ranges so that nodes get different prefixes.
+  std::mt19937 gen(15445);
+  std::vector<int> expected;
+  for (int round = 0; round < 30000; round++) {
+    int id = static_cast<int>(gen() % 4000) + 1000000 * static_cast<int>(gen() % 3);
+    auto it = std::lower_bound(expected.begin(), expected.end(), id);
+    bool present = it != expected.end() && *it == id;
+    if (round % 3 == 2) {
+      tree.Remove(MakeKey<KeySize>(UserName(id)), nullptr);
+      if (present) {
+        expected.erase(it);
+      }
+    } else {
+      ASSERT_EQ(tree.Insert(MakeKey<KeySize>(UserName(id)), RID(0, id)), !present);
+      if (!present) {
+        expected.insert(it, id);
+      }
+    }
+  }
+  CheckTree(&tree, expected);
+  for (int id : expected) {
+    std::vector<RID> result;
+    ASSERT_TRUE(tree.GetValue(MakeKey<KeySize>(UserName(id)), &result));
+    ASSERT_EQ(result[0].GetSlotNum(), id);
+  }
+  std::vector<RID> result;
+  ASSERT_FALSE(tree.GetValue(MakeKey<KeySize>("user_"), &result));
+  ASSERT_FALSE(tree.GetValue(MakeKey<KeySize>(UserName(5000)), &result));
+
+  // Removing everything merges the nodes back into an empty tree.
+  for (int id : expected) {
+    tree.Remove(MakeKey<KeySize>(UserName(id)), nullptr);
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  bpm->UnpinPage(page_id, true);
+}
+
+TEST(BPlusTreeTests, PrefixCompressionInsertRemoveTest) {
+  CheckInsertRemove<32>();
+  CheckInsertRemove<64>();
+}
+
+TEST(BPlusTreeTests, PrefixCompressionBulkLoadTest) {
+  const int num_keys = 50000;
+  // pages are allocated one after the other, so the next page id tells how many pages a tree takes
+  NormalizedComparator<32> comparator(nullptr);
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>> tree("foo_pk", page_id, bpm.get(), comparator);
+  std::vector<std::pair<NormalizedKey<32>, RID>> entries;
+  std::vector<int> expected;
+  for (int id = 0; id < num_keys; id++) {
+    entries.emplace_back(MakeKey<32>(UserName(id)), RID(0, id));
+    expected.push_back(id);
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(445));
+  tree.BulkLoad(&entries);
+  CheckTree(&tree, expected);
+  for (int id = 0; id < num_keys; id += 7) {
+    std::vector<RID> result;
+    ASSERT_TRUE(tree.GetValue(MakeKey<32>(UserName(id)), &result));
+  }
+  size_t compressed_pages = tree.GetNumPages();
+  bpm->UnpinPage(page_id, true);
+
+  // The same number of fixed-size keys of the same width.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<32> generic_comparator(key_schema.get());
+  auto generic_disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto generic_bpm = std::make_unique<BufferPoolManager>(50, generic_disk_manager.get());
+  generic_bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<32>, RID, GenericComparator<32>> generic_tree("foo_pk", page_id, generic_bpm.get(),
+                                                                     generic_comparator);
+  std::vector<std::pair<GenericKey<32>, RID>> generic_entries;
+  for (int id = 0; id < num_keys; id++) {
+    GenericKey<32> key;
+    key.SetFromInteger(id);
+    generic_entries.emplace_back(key, RID(0, id));
+  }
+  generic_tree.BulkLoad(&generic_entries);
+  size_t generic_pages = generic_tree.GetNumPages();
+  generic_bpm->UnpinPage(page_id, true);
+
+  // The compressed keys take a few bytes each instead of 32, which at least doubles the fanout.
+  ASSERT_LE(compressed_pages * 2, generic_pages);
+
+  // The loaded tree takes inserts and removes like any other tree.
+  for (int id = num_keys; id < num_keys + 2000; id++) {
+    ASSERT_TRUE(tree.Insert(MakeKey<32>(UserName(id)), RID(0, id)));
+    expected.push_back(id);
+  }
+  for (int id = 0; id < num_keys; id += 2) {
+    tree.Remove(MakeKey<32>(UserName(id)), nullptr);
+  }
+  expected.erase(std::remove_if(expected.begin(), expected.end(), [&](int id) { return id < num_keys && id % 2 == 0; }),
+                 expected.end());
+  CheckTree(&tree, expected);
+}
+
+}  // namespace bustub
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
 #include <cstring>
+#include <memory>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +26,19 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+  }
+
+  static auto GetFileSize(const std::string &file_name) -> int64_t {
+    struct stat stat_buf;
+    return stat(file_name.c_str(), &stat_buf) == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -55,6 +64,102 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[3][BUSTUB_PAGE_SIZE] = {{0}};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data[0], "page 2", sizeof(data[0]));
+  std::strncpy(data[1], "page 3", sizeof(data[1]));
+  std::strncpy(data[2], "page 4", sizeof(data[2]));
+
+  dm.WritePages(2, {data[0], data[1], data[2]});
+  EXPECT_EQ(1, dm.GetNumWrites());
+  for (int i = 0; i < 3; i++) {
+    dm.ReadPage(2 + i, buf);
+    EXPECT_EQ(std::memcmp(buf, data[i], sizeof(buf)), 0);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = std::make_unique<DiskManager>(db_file);
+
+  // Scenario: page ids are handed out densely, and freed ids are reused lowest first.
+  for (page_id_t i = 0; i < 8; i++) {
+    EXPECT_EQ(i, dm->AllocatePage());
+    dm->WritePage(i, data);
+  }
+  dm->DeallocatePage(5);
+  dm->DeallocatePage(2);
+  EXPECT_FALSE(dm->IsAllocated(2));
+  EXPECT_EQ(2, dm->AllocatePage());
+  EXPECT_EQ(5, dm->AllocatePage());
+  EXPECT_EQ(8, dm->AllocatePage());
+
+  // Scenario: a caller owning every third page id only gets ids of its own.
+  dm->DeallocatePage(4);
+  dm->DeallocatePage(3);
+  EXPECT_EQ(4, dm->AllocatePage(3, 1));
+  EXPECT_EQ(10, dm->AllocatePage(3, 1));
+  EXPECT_EQ(3, dm->AllocatePage(3, 0));
+
+  // Scenario: the map survives a restart.
+  dm->DeallocatePage(10);
+  dm->DeallocatePage(8);
+  dm->DeallocatePage(6);
+  dm->ShutDown();
+  dm = std::make_unique<DiskManager>(db_file);
+  EXPECT_EQ(8, dm->GetNumPages());
+  EXPECT_TRUE(dm->IsAllocated(7));
+  EXPECT_FALSE(dm->IsAllocated(6));
+
+  // Scenario: shrinking cuts the free pages off the end of the file.
+  dm->DeallocatePage(7);
+  EXPECT_EQ(2, dm->Shrink());
+  EXPECT_EQ(6 * BUSTUB_PAGE_SIZE, GetFileSize(db_file));
+  EXPECT_EQ(0, dm->Shrink());
+  EXPECT_EQ(6, dm->AllocatePage());
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapCrashTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = std::make_unique<DiskManager>(db_file);
+  for (page_id_t i = 0; i < 8; i++) {
+    EXPECT_EQ(i, dm->AllocatePage());
+    dm->WritePage(i, data);
+  }
+  dm->DeallocatePage(5);
+  dm->SyncFreeSpaceMap();
+  EXPECT_EQ(1 * sizeof(uint64_t), GetFileSize("test.fsm"));
+
+  // Scenario: a page freed in the synced map is allocated again, then the process dies without syncing the map.
+  EXPECT_EQ(5, dm->AllocatePage());
+  dm->WritePage(5, data);
+  EXPECT_EQ(-1, GetFileSize("test.fsm"));
+  dm.reset();
+
+  // Scenario: on reopen the page is not handed out a second time.
+  dm = std::make_unique<DiskManager>(db_file);
+  EXPECT_TRUE(dm->IsAllocated(5));
+  EXPECT_EQ(8, dm->AllocatePage());
+
+  // Scenario: a page freed after the last sync merely stays allocated.
+  dm->DeallocatePage(3);
+  dm.reset();
+  dm = std::make_unique<DiskManager>(db_file);
+  EXPECT_TRUE(dm->IsAllocated(3));
+  dm->ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::TestWithParam<DiskSchedulerBackend> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override { remove("test.db"); }
+
+  // This function is called after every test.
+  void TearDown() override { remove("test.db"); };
+};
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto disk_scheduler = std::make_unique<DiskScheduler>("test.db", GetParam());
+
+  DiskRequest write{true, 0, {data}, {}};
+  auto write_done = write.callback_.get_future();
+  disk_scheduler->Schedule(std::move(write));
+  ASSERT_TRUE(write_done.get());
+
+  DiskRequest read{false, 0, {buf}, {}};
+  auto read_done = read.callback_.get_future();
+  disk_scheduler->Schedule(std::move(read));
+  ASSERT_TRUE(read_done.get());
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // A page past the end of the file reads as zeros.
+  ASSERT_TRUE(disk_scheduler->ReadPage(5, buf).get());
+  EXPECT_EQ(buf[0], 0);
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, DeepQueueTest) {
+  const int num_pages = 512;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  auto disk_scheduler = std::make_unique<DiskScheduler>("test.db", GetParam());
+
+  // Scenario: more requests than the backend can run at once are outstanding, in no particular page order.
+  std::vector<std::future<bool>> writes;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id = (i * 7) % num_pages;
+    snprintf(pages[page_id].data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    writes.push_back(disk_scheduler->WritePage(page_id, pages[page_id].data()));
+  }
+  for (auto &write : writes) {
+    ASSERT_TRUE(write.get());
+  }
+
+  std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> reads;
+  for (int i = 0; i < num_pages; i++) {
+    reads.push_back(disk_scheduler->ReadPage(i, bufs[i].data()));
+  }
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_TRUE(reads[i].get());
+    EXPECT_EQ(std::memcmp(bufs[i].data(), pages[i].data(), BUSTUB_PAGE_SIZE), 0);
+  }
+
+  // Scenario: a run of adjacent pages is written at once.
+  std::vector<const char *> run;
+  for (int i = 0; i < 3; i++) {
+    std::strncpy(pages[i].data(), "rewritten", BUSTUB_PAGE_SIZE);
+    run.push_back(pages[i].data());
+  }
+  ASSERT_TRUE(disk_scheduler->WritePages(0, run).get());
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(disk_scheduler->ReadPage(i, bufs[i].data()).get());
+    EXPECT_STREQ("rewritten", bufs[i].data());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, DirectIOTest) {
+  // Buffers that are not page aligned go through a bounce buffer with O_DIRECT.
+  std::vector<char> data(BUSTUB_PAGE_SIZE + 1);
+  std::vector<char> buf(BUSTUB_PAGE_SIZE + 1);
+  std::strncpy(data.data() + 1, "A test string.", BUSTUB_PAGE_SIZE);
+
+  auto disk_scheduler = std::make_unique<DiskScheduler>("test.db", GetParam(), true);
+  ASSERT_TRUE(disk_scheduler->WritePage(3, data.data() + 1).get());
+  ASSERT_TRUE(disk_scheduler->ReadPage(3, buf.data() + 1).get());
+  EXPECT_EQ(std::memcmp(buf.data() + 1, data.data() + 1, BUSTUB_PAGE_SIZE), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(DiskSchedulerBackends, DiskSchedulerTest,
+                         ::testing::Values(DiskSchedulerBackend::ThreadPool, DiskSchedulerBackend::IoUring));
+
+}  // namespace bustub
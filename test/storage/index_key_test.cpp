@@ -0,0 +1,325 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_key_test.cpp
+//
+// Identification: test/storage/index_key_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/normalized_key.h"
+#include "storage/index/packed_integer_key.h"
+#include "storage/index/packed_key_search.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto Sign(int cmp) -> int { return (cmp > 0) - (cmp < 0); }
+
+// NOLINTNEXTLINE
+TEST(IndexKeyTest, PackedIntegerKeyTest) {
+  auto key_schema = ParseCreateStatement("a smallint,b int,c tinyint");
+  ASSERT_TRUE(PackedIntegerKey::CanPack(*key_schema));
+  ASSERT_FALSE(PackedIntegerKey::CanPack(*ParseCreateStatement("a bigint,b int")));
+  ASSERT_FALSE(PackedIntegerKey::CanPack(*ParseCreateStatement("a int,b varchar(8)")));
+
+  GenericComparator<8> generic_comparator(key_schema.get());
+  PackedIntegerComparator packed_comparator(key_schema.get());
+
+  std::mt19937 gen(445);
+  std::uniform_int_distribution<int> small(-3, 3);
+  std::uniform_int_distribution<int> wide(-1000000, 1000000);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetSmallIntValue(small(gen)),
+                                           ValueFactory::GetIntegerValue(i % 2 == 0 ? small(gen) : wide(gen)),
+                                           ValueFactory::GetTinyIntValue(small(gen))},
+                        key_schema.get());
+  }
+
+  // The packed keys sort like the columns they are built from.
+  for (const auto &lhs : tuples) {
+    for (const auto &rhs : tuples) {
+      GenericKey<8> generic_lhs;
+      GenericKey<8> generic_rhs;
+      generic_lhs.SetFromKey(lhs);
+      generic_rhs.SetFromKey(rhs);
+      PackedIntegerKey packed_lhs;
+      PackedIntegerKey packed_rhs;
+      packed_lhs.SetFromKey(lhs, *key_schema);
+      packed_rhs.SetFromKey(rhs, *key_schema);
+      ASSERT_EQ(Sign(generic_comparator(generic_lhs, generic_rhs)), packed_comparator(packed_lhs, packed_rhs));
+    }
+  }
+
+  // The columns can be read back from the packed key.
+  for (const auto &tuple : tuples) {
+    PackedIntegerKey key;
+    key.SetFromKey(tuple, *key_schema);
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      Value value = key.ToValue(key_schema.get(), i);
+      ASSERT_EQ(value.CompareEquals(tuple.GetValue(key_schema.get(), i)), CmpBool::CmpTrue);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(IndexKeyTest, NormalizedKeyTest) {
+  auto key_schema = ParseCreateStatement("a int,b varchar(8),c bigint");
+  ASSERT_EQ(NormalizedKeySize(*key_schema), 4 + 11 + 8);
+
+  GenericComparator<64> generic_comparator(key_schema.get());
+  NormalizedComparator<32> normalized_comparator(key_schema.get());
+
+  std::mt19937 gen(445);
+  std::uniform_int_distribution<int> small(-2, 2);
+  std::uniform_int_distribution<int64_t> wide(-(int64_t{1} << 40), int64_t{1} << 40);
+  const std::vector<std::string> strings = {"", "a", "ab", "abc", "b", "ba", "z", "zzzzzzzz"};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(small(gen)),
+                                           ValueFactory::GetVarcharValue(strings[gen() % strings.size()]),
+                                           ValueFactory::GetBigIntValue(i % 2 == 0 ? small(gen) : wide(gen))},
+                        key_schema.get());
+  }
+
+  // Normalized keys compare with memcmp in the order of the columns they are built from, including strings that are
+  // prefixes of each other.
+  for (const auto &lhs : tuples) {
+    for (const auto &rhs : tuples) {
+      GenericKey<64> generic_lhs;
+      GenericKey<64> generic_rhs;
+      generic_lhs.SetFromKey(lhs);
+      generic_rhs.SetFromKey(rhs);
+      NormalizedKey<32> normalized_lhs;
+      NormalizedKey<32> normalized_rhs;
+      normalized_lhs.SetFromKey(lhs, *key_schema);
+      normalized_rhs.SetFromKey(rhs, *key_schema);
+      ASSERT_EQ(Sign(generic_comparator(generic_lhs, generic_rhs)),
+                Sign(normalized_comparator(normalized_lhs, normalized_rhs)));
+    }
+  }
+
+  // The columns can be read back from the normalized key, NULL strings and escaped 0 bytes included.
+  tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(-7),
+                                         ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+                                         ValueFactory::GetBigIntValue(7)},
+                      key_schema.get());
+  tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(7),
+                                         ValueFactory::GetVarcharValue(std::string("a\0b", 3)),
+                                         ValueFactory::GetBigIntValue(-7)},
+                      key_schema.get());
+  for (const auto &tuple : tuples) {
+    NormalizedKey<32> key;
+    key.SetFromKey(tuple, *key_schema);
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      Value expected = tuple.GetValue(key_schema.get(), i);
+      Value value = key.ToValue(key_schema.get(), i);
+      ASSERT_EQ(value.IsNull(), expected.IsNull());
+      ASSERT_TRUE(expected.IsNull() || value.CompareEquals(expected) == CmpBool::CmpTrue);
+    }
+  }
+
+  // A key that does not fit is rejected rather than truncated.
+  NormalizedKey<8> small_key;
+  Tuple long_key({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("long string"),
+                  ValueFactory::GetBigIntValue(1)},
+                 key_schema.get());
+  EXPECT_THROW(small_key.SetFromKey(long_key, *key_schema), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST(IndexKeyTest, PackedKeySearchTest) {
+  std::mt19937_64 gen(445);
+  for (size_t n = 0; n <= 300; n++) {
+    // small values make runs of equal keys, and both ends of the unsigned range are covered
+    std::vector<uint64_t> keys(n);
+    for (auto &key : keys) {
+      key = gen() % 4 == 0 ? gen() : gen() % 64;
+    }
+    keys.push_back(0);
+    keys.push_back(UINT64_MAX);
+    std::sort(keys.begin(), keys.end());
+    for (int i = 0; i < 50; i++) {
+      uint64_t key = i % 2 == 0 ? keys[gen() % keys.size()] : gen() % 70;
+      ASSERT_EQ(CountKeysLess(keys.data(), keys.size(), key), CountKeysLessScalar(keys.data(), keys.size(), key));
+      ASSERT_EQ(CountKeysLessEqual(keys.data(), keys.size(), key),
+                std::upper_bound(keys.begin(), keys.end(), key) - keys.begin());
+    }
+    ASSERT_EQ(CountKeysLess(keys.data(), keys.size(), 0), 0);
+    ASSERT_EQ(CountKeysLessEqual(keys.data(), keys.size(), UINT64_MAX), keys.size());
+  }
+}
+
+/** Inserts and removes random keys in a tree with small pages, checking the tree against a sorted vector. */
+template <typename KeyType, typename KeyComparator>
+void CheckTreeWithSmallPages() {
+  auto key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<KeyType, RID, KeyComparator> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator, 4, 5);
+
+  std::mt19937 gen(15445);
+  std::vector<int64_t> expected;
+  auto make_key = [](int64_t value) {
+    KeyType key;
+    key.SetFromInteger(value);
+    return key;
+  };
+  for (int round = 0; round < 4000; round++) {
+    int64_t value = static_cast<int64_t>(gen() % 600) - 300;
+    auto it = std::lower_bound(expected.begin(), expected.end(), value);
+    bool present = it != expected.end() && *it == value;
+    if (round % 3 == 2) {
+      tree.Remove(make_key(value), nullptr);
+      if (present) {
+        expected.erase(it);
+      }
+    } else {
+      ASSERT_EQ(tree.Insert(make_key(value), RID(0, static_cast<uint32_t>(value + 300))), !present);
+      if (!present) {
+        expected.insert(it, value);
+      }
+    }
+  }
+
+  auto iter = tree.Begin();
+  for (auto value : expected) {
+    ASSERT_FALSE(iter.IsEnd());
+    ASSERT_EQ((*iter).first.ToString(), value);
+    ASSERT_EQ((*iter).second.GetSlotNum(), value + 300);
+    ++iter;
+  }
+  ASSERT_TRUE(iter.IsEnd());
+  for (int64_t value = -300; value < 300; value++) {
+    std::vector<RID> result;
+    ASSERT_EQ(tree.GetValue(make_key(value), &result), std::binary_search(expected.begin(), expected.end(), value));
+  }
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+// NOLINTNEXTLINE
+TEST(IndexKeyTest, SeparateKeysPageTest) {
+  // packed keys are stored apart from their values, normalized keys prefix-compressed, generic keys next to them
+  static_assert(SeparateKeys<PackedIntegerKey>::value);
+  static_assert(!SeparateKeys<NormalizedKey<8>>::value && CompressKeys<NormalizedKey<8>>::value);
+  static_assert(!SeparateKeys<GenericKey<8>>::value && !CompressKeys<GenericKey<8>>::value);
+  CheckTreeWithSmallPages<PackedIntegerKey, PackedIntegerComparator>();
+  CheckTreeWithSmallPages<NormalizedKey<8>, NormalizedComparator<8>>();
+  CheckTreeWithSmallPages<GenericKey<8>, GenericComparator<8>>();
+}
+
+// NOLINTNEXTLINE
+TEST(IndexKeyTest, CatalogChoosesKeyTypeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Catalog catalog(bpm.get(), nullptr, nullptr);
+
+  auto schema = ParseCreateStatement("a int,b varchar(16),c bigint,d boolean");
+  ASSERT_NE(catalog.CreateTable(nullptr, "t", *schema), nullptr);
+
+  auto create_index = [&](const std::string &name, const std::vector<uint32_t> &key_attrs) {
+    auto key_schema = Schema::CopySchema(schema.get(), key_attrs);
+    return catalog.CreateIndex(nullptr, name, "t", *schema, key_schema, key_attrs);
+  };
+  auto *int_index = create_index("t_a", {0});
+  auto *composite_index = create_index("t_ab", {0, 1});
+  auto *bool_index = create_index("t_d", {3});
+  ASSERT_NE(int_index, nullptr);
+  ASSERT_NE(composite_index, nullptr);
+  ASSERT_NE(bool_index, nullptr);
+  using PackedIndex = BPlusTreeIndex<PackedIntegerKey, RID, PackedIntegerComparator>;
+  using NormalizedIndex = BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+  using GenericIndex = BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+  EXPECT_NE(dynamic_cast<PackedIndex *>(int_index->index_.get()), nullptr);
+  EXPECT_NE(dynamic_cast<NormalizedIndex *>(composite_index->index_.get()), nullptr);
+  EXPECT_NE(dynamic_cast<GenericIndex *>(bool_index->index_.get()), nullptr);
+
+  // Whatever the key type, the index can be scanned in key order.
+  for (int i = 0; i < 100; i++) {
+    int a = (i * 37) % 100 - 50;
+    Tuple key({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::to_string(i))},
+              &composite_index->key_schema_);
+    ASSERT_TRUE(composite_index->index_->InsertEntry(key, RID(a + 50, 0), nullptr));
+  }
+  auto cursor = dynamic_cast<BPlusTreeIndexBase *>(composite_index->index_.get())->Scan();
+  for (int i = 0; i < 100; i++, cursor->Next()) {
+    ASSERT_FALSE(cursor->IsEnd());
+    EXPECT_EQ(cursor->GetRID().GetPageId(), i);
+  }
+  EXPECT_TRUE(cursor->IsEnd());
+}
+
+// NOLINTNEXTLINE
+TEST(IndexKeyTest, CoveringIndexTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Catalog catalog(bpm.get(), nullptr, nullptr);
+
+  auto schema = ParseCreateStatement("a int,b varchar(8),c bigint");
+  ASSERT_NE(catalog.CreateTable(nullptr, "t", *schema), nullptr);
+  auto key_schema = Schema::CopySchema(schema.get(), {0});
+  auto *unique_index = catalog.CreateIndex(nullptr, "t_a", "t", *schema, key_schema, {0}, true, {1, 2});
+  auto *index = catalog.CreateIndex(nullptr, "t_a_dup", "t", *schema, key_schema, {0}, false, {1});
+  ASSERT_NE(unique_index, nullptr);
+  ASSERT_NE(index, nullptr);
+  EXPECT_EQ(unique_index->index_->GetEntryAttrs(), (std::vector<uint32_t>{0, 1, 2}));
+
+  auto entry = [&](IndexInfo *info, int a, const std::string &b, int64_t c) {
+    Tuple tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b), ValueFactory::GetBigIntValue(c)},
+                schema.get());
+    return tuple.KeyFromTuple(*schema, *info->index_->GetEntrySchema(), info->index_->GetEntryAttrs());
+  };
+  auto scan_key = [&](IndexInfo *info, int a) {
+    std::vector<RID> rids;
+    info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(a)}, &info->key_schema_), &rids, nullptr);
+    return rids;
+  };
+
+  // A unique covering index compares the key columns alone.
+  ASSERT_TRUE(unique_index->index_->InsertEntry(entry(unique_index, 1, "x", 10), RID(1, 0), nullptr));
+  ASSERT_FALSE(unique_index->index_->InsertEntry(entry(unique_index, 1, "y", 20), RID(2, 0), nullptr));
+  ASSERT_TRUE(unique_index->index_->InsertEntry(entry(unique_index, 2, "y", 20), RID(2, 0), nullptr));
+  EXPECT_EQ(scan_key(unique_index, 1), std::vector<RID>{RID(1, 0)});
+  auto cursor = dynamic_cast<BPlusTreeIndexBase *>(unique_index->index_.get())->Scan();
+  std::vector<Value> values;
+  cursor->GetEntry(&values);
+  ASSERT_EQ(values.size(), 3);
+  EXPECT_EQ(values[0].GetAs<int32_t>(), 1);
+  EXPECT_EQ(values[1].ToString(), "x");
+  EXPECT_EQ(values[2].GetAs<int64_t>(), 10);
+
+  // A non-unique one finds every entry of a key, whatever the included columns hold.
+  for (int i = 0; i < 300; i++) {
+    ASSERT_TRUE(index->index_->InsertEntry(entry(index, i % 3, std::to_string(i % 7), 0), RID(i, 0), nullptr));
+  }
+  index->index_->DeleteEntry(entry(index, 1, "1", 0), RID(1, 0), nullptr);
+  auto rids = scan_key(index, 1);
+  EXPECT_EQ(rids.size(), 99);
+  for (const auto &rid : rids) {
+    EXPECT_EQ(rid.GetPageId() % 3, 1);
+    EXPECT_NE(rid.GetPageId(), 1);
+  }
+  EXPECT_EQ(scan_key(index, 3).size(), 0);
+}
+
+}  // namespace bustub
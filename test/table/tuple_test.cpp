@@ -13,14 +13,17 @@
 #include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -61,4 +64,77 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapReadAheadTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+  auto table = std::make_unique<TableHeap>(bpm.get());
+
+  // Scenario: the table spans many more pages than the buffer pool holds.
+  const int num_tuples = 10000;
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'x'))}, &schema};
+    ASSERT_NE(std::nullopt, table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+
+  // Scenario: without read-ahead, a scan never prefetches.
+  table->SetReadAheadDepth(0);
+  int count = 0;
+  for (auto itr = table->MakeIterator(); !itr.IsEnd(); ++itr) {
+    EXPECT_EQ(count++, itr.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_EQ(0, bpm->GetPrefetchCount());
+
+  // Scenario: with read-ahead, the pages of the scan are prefetched ahead of the iterator and then hit.
+  table->SetReadAheadDepth(8);
+  count = 0;
+  for (auto itr = table->MakeIterator(); !itr.IsEnd(); ++itr) {
+    EXPECT_EQ(count++, itr.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_GT(bpm->GetPrefetchCount(), 0);
+  EXPECT_GT(bpm->GetPrefetchHitCount(), 0);
+  EXPECT_LE(bpm->GetPrefetchHitCount(), bpm->GetPrefetchCount());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapReusedPageIdsTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+
+  // Scenario: the first extent of the table comes after the pages of another object, which are freed afterwards.
+  std::vector<page_id_t> page_ids(SEGMENT_EXTENT_SIZE);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  auto table = std::make_unique<TableHeap>(bpm.get());
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->DeletePage(page_id));
+  }
+
+  // Scenario: the next extent of the table reuses the freed ids, so its page chain goes back to lower page ids.
+  const int num_tuples = 3000;
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'x'))}, &schema};
+    ASSERT_NE(std::nullopt, table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+  auto extents = table->GetSegment()->GetExtents();
+  ASSERT_EQ(2, extents.size());
+  EXPECT_LT(extents[1], extents[0]);
+
+  // Scenario: a scan still visits every tuple once, in insertion order, and stops where the table ended.
+  int count = 0;
+  auto itr = table->MakeIterator();
+  Tuple tuple{{ValueFactory::GetIntegerValue(num_tuples), ValueFactory::GetVarcharValue("late")}, &schema};
+  ASSERT_NE(std::nullopt, table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  for (; !itr.IsEnd(); ++itr) {
+    EXPECT_EQ(count++, itr.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, count);
+}
+
 }  // namespace bustub
@@ -34,6 +34,7 @@ static const size_t BUSTUB_GET_THREAD = 8;
 static const size_t LRU_K_SIZE = 16;
 static const size_t BUSTUB_PAGE_CNT = 6400;
 static const size_t BUSTUB_BPM_SIZE = 64;
+static const size_t REPLACER_FRAME_CNTS[] = {4096, 16384, 65536, 262144, 1048576};
 
 struct BpmTotalMetrics {
   uint64_t scan_cnt_{0};
@@ -100,6 +101,91 @@ struct BpmMetrics {
   }
 };
 
+/**
+ * Drive an LRUKReplacer directly with the same scan/get thread mix as the buffer pool benchmark. Scan threads evict
+ * a frame and re-admit it as a scan page, get threads touch frames under a zipfian distribution. Reports the average
+ * latency of Evict for each frame count.
+ */
+void RunReplacerBench(uint64_t duration_ms) {
+  using bustub::AccessType;
+  using bustub::frame_id_t;
+  using bustub::LRUKReplacer;
+
+  for (size_t frame_cnt : REPLACER_FRAME_CNTS) {
+    LRUKReplacer replacer(frame_cnt, LRU_K_SIZE);
+    for (size_t i = 0; i < frame_cnt; i++) {
+      replacer.RecordAccess(static_cast<frame_id_t>(i), AccessType::Get);
+      replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+    }
+
+    fmt::print(stderr, "[info] replacer benchmark start, frames={}\n", frame_cnt);
+
+    std::mutex mutex;
+    uint64_t evict_cnt = 0;
+    uint64_t evict_ns = 0;
+    uint64_t get_cnt = 0;
+    std::vector<std::thread> threads;
+
+    for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
+      threads.emplace_back([&, duration_ms] {
+        BpmMetrics metrics("evict", duration_ms);
+        metrics.Begin();
+        uint64_t ns = 0;
+
+        while (!metrics.ShouldFinish()) {
+          frame_id_t frame_id;
+          auto start = std::chrono::steady_clock::now();
+          bool evicted = replacer.Evict(&frame_id);
+          ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+          metrics.Tick();
+          if (!evicted) {
+            continue;
+          }
+          replacer.RecordAccess(frame_id, AccessType::Scan);
+          replacer.SetEvictable(frame_id, true);
+        }
+
+        std::scoped_lock l(mutex);
+        evict_cnt += metrics.cnt_;
+        evict_ns += ns;
+      });
+    }
+
+    for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
+      threads.emplace_back([&, duration_ms] {
+        std::random_device r;
+        std::default_random_engine gen(r());
+        zipfian_int_distribution<size_t> dist(0, frame_cnt - 1, 0.8);
+
+        BpmMetrics metrics("get", duration_ms);
+        metrics.Begin();
+
+        while (!metrics.ShouldFinish()) {
+          auto frame_id = static_cast<frame_id_t>(dist(gen));
+          replacer.SetEvictable(frame_id, false);
+          replacer.RecordAccess(frame_id, AccessType::Get);
+          replacer.SetEvictable(frame_id, true);
+          metrics.Tick();
+        }
+
+        std::scoped_lock l(mutex);
+        get_cnt += metrics.cnt_;
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    fmt::print("<<< BEGIN\n");
+    fmt::print("frames: {}\n", frame_cnt);
+    fmt::print("evict: {}\n", evict_cnt / static_cast<double>(duration_ms) * 1000);
+    fmt::print("evict_avg_ns: {}\n", evict_cnt == 0 ? 0 : evict_ns / static_cast<double>(evict_cnt));
+    fmt::print("get: {}\n", get_cnt / static_cast<double>(duration_ms) * 1000);
+    fmt::print(">>> END\n");
+  }
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
@@ -110,6 +196,12 @@ auto main(int argc, char **argv) -> int {
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--shards").help("partition the buffer pool into n independent shards");
+  program.add_argument("--flush-watermark").help("keep n clean frames with a background flusher, 0 = disabled");
+  program.add_argument("--replacer")
+      .help("benchmark LRU-K eviction latency at 4K-1M frames instead of the buffer pool")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -129,12 +221,30 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
+  size_t num_shards = 1;
+  if (program.present("--shards")) {
+    num_shards = std::stoi(program.get("--shards"));
+  }
+
+  size_t flush_watermark = 0;
+  if (program.present("--flush-watermark")) {
+    flush_watermark = std::stoi(program.get("--flush-watermark"));
+  }
+
+  if (program.get<bool>("--replacer")) {
+    RunReplacerBench(duration_ms);
+    return 0;
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr, num_shards,
+                                                 flush_watermark);
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, shards={}, "
+             "flush_watermark={}\n",
+             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, num_shards, flush_watermark);
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -227,6 +337,8 @@ auto main(int argc, char **argv) -> int {
   }
 
   total_metrics.Report();
+  fmt::print(stderr, "[info] foreground_flushes={}, background_flushes={}, prefetch_flushes={}\n",
+             bpm->GetForegroundFlushCount(), bpm->GetBackgroundFlushCount(), bpm->GetPrefetchFlushCount());
 
   return 0;
 }
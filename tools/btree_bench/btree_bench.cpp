@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -43,10 +44,25 @@ struct BTreeTotalMetrics {
   uint64_t write_cnt_{0};
   uint64_t read_cnt_{0};
   uint64_t start_time_{0};
+  std::vector<uint64_t> read_latency_ns_;
   std::mutex mutex_;
 
   void Begin() { start_time_ = ClockMs(); }
 
+  void ReportReadLatency(const std::vector<uint64_t> &latency_ns) {
+    std::unique_lock<std::mutex> l(mutex_);
+    read_latency_ns_.insert(read_latency_ns_.end(), latency_ns.begin(), latency_ns.end());
+  }
+
+  auto ReadLatencyPercentile(double p) -> uint64_t {
+    if (read_latency_ns_.empty()) {
+      return 0;
+    }
+    auto nth = read_latency_ns_.begin() + static_cast<size_t>(p * (read_latency_ns_.size() - 1));
+    std::nth_element(read_latency_ns_.begin(), nth, read_latency_ns_.end());
+    return *nth;
+  }
+
   void ReportWrite(uint64_t scan_cnt) {
     std::unique_lock<std::mutex> l(mutex_);
     write_cnt_ += scan_cnt;
@@ -66,6 +82,10 @@ struct BTreeTotalMetrics {
     fmt::print("<<< BEGIN\n");
     fmt::print("write: {}\n", write_per_sec);
     fmt::print("read: {}\n", read_per_sec);
+    fmt::print("mixed: {}\n", write_per_sec + read_per_sec);
+    fmt::print("read_p50_ns: {}\n", ReadLatencyPercentile(0.5));
+    fmt::print("read_p99_ns: {}\n", ReadLatencyPercentile(0.99));
+    fmt::print("read_p999_ns: {}\n", ReadLatencyPercentile(0.999));
     fmt::print(">>> END\n");
   }
 };
@@ -110,6 +130,11 @@ auto KeyWillVanish(size_t key) -> bool { return key % 7 == 0; }
 // These keys will be overwritten to a new value
 auto KeyWillChange(size_t key) -> bool { return key % 5 == 0; }
 
+auto ClockNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
@@ -119,6 +144,10 @@ auto main(int argc, char **argv) -> int {
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--mixed")
+      .help("every thread does half reads and half writes, instead of separate read and write threads")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -132,12 +161,13 @@ auto main(int argc, char **argv) -> int {
   if (program.present("--duration")) {
     duration_ms = std::stoi(program.get("--duration"));
   }
+  bool mixed = program.get<bool>("--mixed");
 
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}, mixed={}\n", TOTAL_KEYS,
+             duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, mixed);
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -164,7 +194,12 @@ auto main(int argc, char **argv) -> int {
 
   std::vector<std::thread> threads;
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_READ_THREAD; thread_id++) {
+  // In the mixed workload, all threads are mixed threads instead.
+  size_t read_threads = mixed ? 0 : BUSTUB_READ_THREAD;
+  size_t write_threads = mixed ? 0 : BUSTUB_WRITE_THREAD;
+  size_t mixed_threads = mixed ? BUSTUB_READ_THREAD + BUSTUB_WRITE_THREAD : 0;
+
+  for (size_t thread_id = 0; thread_id < read_threads; thread_id++) {
     threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
       BTreeMetrics metrics(fmt::format("read  {:>2}", thread_id), duration_ms);
       metrics.Begin();
@@ -177,6 +212,7 @@ auto main(int argc, char **argv) -> int {
 
       bustub::GenericKey<8> index_key;
       std::vector<bustub::RID> rids;
+      std::vector<uint64_t> latency_ns;
 
       while (!metrics.ShouldFinish()) {
         auto base_key = dis(gen);
@@ -184,7 +220,9 @@ auto main(int argc, char **argv) -> int {
         for (auto key = base_key; key < key_end && cnt < KEY_MODIFY_RANGE; key++, cnt++) {
           rids.clear();
           index_key.SetFromInteger(key);
+          auto start_ns = ClockNs();
           index.GetValue(index_key, &rids);
+          latency_ns.push_back(ClockNs() - start_ns);
 
           if (!KeyWillVanish(key) && rids.empty()) {
             std::string msg = fmt::format("key not found: {}", key);
@@ -207,10 +245,11 @@ auto main(int argc, char **argv) -> int {
       }
 
       total_metrics.ReportRead(metrics.cnt_);
+      total_metrics.ReportReadLatency(latency_ns);
     }));
   }
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_WRITE_THREAD; thread_id++) {
+  for (size_t thread_id = 0; thread_id < write_threads; thread_id++) {
     threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
       BTreeMetrics metrics(fmt::format("write {:>2}", thread_id), duration_ms);
       metrics.Begin();
@@ -257,6 +296,60 @@ auto main(int argc, char **argv) -> int {
     }));
   }
 
+  // Half of the operations read a random key, the other half insert or remove a random key that will vanish, so
+  // readers keep running into pages that writers split and merge.
+  for (size_t thread_id = 0; thread_id < mixed_threads; thread_id++) {
+    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
+      BTreeMetrics read_metrics(fmt::format("read  {:>2}", thread_id), duration_ms);
+      BTreeMetrics write_metrics(fmt::format("write {:>2}", thread_id), duration_ms);
+      read_metrics.Begin();
+      write_metrics.Begin();
+
+      std::random_device r;
+      std::default_random_engine gen(r());
+      std::uniform_int_distribution<size_t> dis(0, TOTAL_KEYS - 1);
+      std::bernoulli_distribution coin(0.5);
+
+      bustub::GenericKey<8> index_key;
+      bustub::RID rid;
+      std::vector<bustub::RID> rids;
+      std::vector<uint64_t> latency_ns;
+
+      while (!read_metrics.ShouldFinish()) {
+        auto key = dis(gen);
+        if (coin(gen)) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          auto start_ns = ClockNs();
+          index.GetValue(index_key, &rids);
+          latency_ns.push_back(ClockNs() - start_ns);
+          if (!KeyWillVanish(key) && rids.empty()) {
+            std::string msg = fmt::format("key not found: {}", key);
+            throw std::runtime_error(msg);
+          }
+          read_metrics.Tick();
+          read_metrics.Report();
+        } else {
+          key -= key % 7;
+          uint32_t value = key;
+          rid.Set(value, value);
+          index_key.SetFromInteger(key);
+          if (coin(gen)) {
+            index.Insert(index_key, rid, nullptr);
+          } else {
+            index.Remove(index_key, nullptr);
+          }
+          write_metrics.Tick();
+          write_metrics.Report();
+        }
+      }
+
+      total_metrics.ReportRead(read_metrics.cnt_);
+      total_metrics.ReportWrite(write_metrics.cnt_);
+      total_metrics.ReportReadLatency(latency_ns);
+    }));
+  }
+
   for (auto &thread : threads) {
     thread.join();
   }
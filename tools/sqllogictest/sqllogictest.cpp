@@ -71,10 +71,17 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
       instance.ExecuteSql("explain " + sql, writer);
 
       if (opt == "ensure:index_scan") {
-        if (!bustub::StringUtil::Contains(result.str(), "IndexScan")) {
+        // an index-only scan is an index scan that does not fetch the tuples
+        if (!bustub::StringUtil::Contains(result.str(), "IndexScan") &&
+            !bustub::StringUtil::Contains(result.str(), "IndexOnlyScan")) {
           fmt::print("IndexScan not found\n");
           return false;
         }
+      } else if (opt == "ensure:index_only_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "IndexOnlyScan")) {
+          fmt::print("IndexOnlyScan not found\n");
+          return false;
+        }
       } else if (opt == "ensure:hash_join") {
         if (bustub::StringUtil::Split(result.str(), "HashJoin").size() != 2 &&
             !bustub::StringUtil::Contains(result.str(), "Filter")) {